@@ -0,0 +1,267 @@
+#ifndef ROS2_BEHAVIORTREE_ASYNC_LOG_HPP
+#define ROS2_BEHAVIORTREE_ASYNC_LOG_HPP
+
+// STL
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace rclcpp
+{
+  class Logger;
+} // rclcpp
+
+namespace bt_ros
+{
+  enum class LogLevel
+  {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR
+  };
+
+  /**
+   * Logging for code running on the tick thread, never blocking it.
+   *
+   * Each thread writes into its own single-producer single-consumer ring of
+   * fixed-size records. A record holds the raw arguments (numbers copied as
+   * they are, strings copied up to the record size) and a pointer to the
+   * function formatting them: writing a record is a few memcpy and one
+   * release store, no lock, no allocation, no syscall. A background thread
+   * formats the records, one line each as `std::cout << args...` would, and
+   * hands them to the sink (stdout by default, or a ROS logger).
+   *
+   * When a ring is full, because the sink is blocked on a terminal or a slow
+   * pipe, records are dropped and counted instead; the drop count is logged
+   * once the sink keeps up again. Lines of one thread keep their order, lines
+   * of different threads are only ordered by when they are drained.
+   */
+  class AsyncLog
+  {
+  public:
+    using Sink = std::function<void(LogLevel level, std::string_view line)>;
+
+    // Started on first use, drained and stopped at exit
+    static AsyncLog& instance();
+
+    ~AsyncLog();
+
+    AsyncLog(const AsyncLog&) = delete;
+    AsyncLog& operator=(const AsyncLog&) = delete;
+
+    // Strings, characters, booleans, numbers and enums (printed as numbers)
+    template <typename... Args>
+    void write(LogLevel level, const Args&... args) noexcept;
+
+    // The sink is only called by the background thread, an empty one restores stdout
+    void setSink(Sink sink);
+
+    // Wait until every record written so far went to the sink
+    void flush();
+
+    // Records lost on full rings since start
+    std::uint64_t dropped() const;
+
+  private:
+    static constexpr std::size_t RECORD_SIZE = 256;
+    static constexpr std::size_t RING_CAPACITY = 1024;
+
+    using Formatter = void (*)(const std::byte* payload, std::string& line);
+
+    struct Record
+    {
+      Formatter format;
+      LogLevel level;
+      alignas(8) std::byte payload[RECORD_SIZE - 16];
+    };
+    static_assert(RECORD_SIZE == sizeof(Record));
+    static constexpr std::size_t PAYLOAD_SIZE = sizeof(Record::payload);
+
+    // Written by one thread, drained by the background thread
+    class Ring
+    {
+    public:
+      Record* claim() noexcept;
+      void publish() noexcept;
+      const Record* front() const noexcept;
+      void pop() noexcept;
+
+      std::uint64_t written() const noexcept { return head_.load(std::memory_order_acquire); }
+      std::uint64_t drained() const noexcept { return tail_.load(std::memory_order_acquire); }
+
+      // The thread exited, the ring goes away once drained
+      std::atomic<bool> closed {false};
+
+    private:
+      alignas(64) std::atomic<std::uint64_t> head_ {0};
+      std::uint64_t cached_tail_ {0};
+      alignas(64) std::atomic<std::uint64_t> tail_ {0};
+      alignas(64) std::array<Record, RING_CAPACITY> records_;
+    };
+
+    // How one argument type is stored in a payload and printed
+    template <typename T>
+    struct Argument;
+
+    template <typename... Args>
+    static void format(const std::byte* payload, std::string& line);
+
+    AsyncLog();
+
+    // Ring of the calling thread, created and registered on first use
+    Ring* threadRing() noexcept;
+    void drain();
+    void run(std::stop_token stop);
+
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+    std::mutex sink_mutex_;
+    Sink sink_;
+    std::atomic<std::uint64_t> dropped_;
+    std::uint64_t reported_dropped_;
+    std::string line_;
+    std::jthread worker_;
+  };
+
+  // Sink writing to a ROS logger at the record level
+  AsyncLog::Sink rosLogSink(const rclcpp::Logger& logger);
+
+  // Numbers, booleans, characters and enums: copied as they are
+  template <typename T>
+  struct AsyncLog::Argument
+  {
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>,
+        "AsyncLog: format this argument into a std::string first");
+
+    static constexpr std::size_t RESERVED = sizeof(T);
+
+    static std::size_t encode(std::byte* out, std::size_t&, const T& value) noexcept
+    {
+      std::memcpy(out, &value, sizeof(T));
+      return sizeof(T);
+    }
+
+    static std::size_t decode(const std::byte* in, std::string& line)
+    {
+      T value;
+      std::memcpy(&value, in, sizeof(T));
+      if constexpr (std::is_same_v<T, bool>)
+      {
+        line += value ? '1' : '0';
+      }
+      else if constexpr (std::is_same_v<T, char>)
+      {
+        line += value;
+      }
+      else if constexpr (std::is_enum_v<T>)
+      {
+        line += std::to_string(static_cast<std::underlying_type_t<T>>(value));
+      }
+      else if constexpr (std::is_floating_point_v<T>)
+      {
+        // Same as the default precision of std::ostream
+        char buffer[32];
+        const auto length = std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(value));
+        line.append(buffer, static_cast<std::size_t>(std::max(length, 0)));
+      }
+      else
+      {
+        line += std::to_string(value);
+      }
+      return sizeof(T);
+    }
+  };
+
+  // Strings: 16-bit length then the characters, cut to the string space left in the record
+  template <>
+  struct AsyncLog::Argument<std::string_view>
+  {
+    static constexpr std::size_t RESERVED = sizeof(std::uint16_t);
+
+    static std::size_t encode(std::byte* out, std::size_t& string_space, std::string_view value) noexcept
+    {
+      const auto length = static_cast<std::uint16_t>(std::min(value.size(), string_space));
+      string_space -= length;
+      std::memcpy(out, &length, sizeof(length));
+      std::memcpy(out + sizeof(length), value.data(), length);
+      return sizeof(length) + length;
+    }
+
+    static std::size_t decode(const std::byte* in, std::string& line)
+    {
+      std::uint16_t length;
+      std::memcpy(&length, in, sizeof(length));
+      line.append(reinterpret_cast<const char*>(in + sizeof(length)), length);
+      return sizeof(length) + length;
+    }
+  };
+
+  template <typename T>
+  using AsyncLogArgument = std::conditional_t<std::is_convertible_v<const T&, std::string_view>, std::string_view, T>;
+
+  template <typename... Args>
+  void AsyncLog::format(const std::byte* payload, std::string& line)
+  {
+    ((payload += Argument<Args>::decode(payload, line)), ...);
+  }
+
+  template <typename... Args>
+  void AsyncLog::write(LogLevel level, const Args&... args) noexcept
+  {
+    // Every argument always fits, strings share what is left
+    constexpr std::size_t reserved = (Argument<AsyncLogArgument<Args>>::RESERVED + ... + 0);
+    static_assert(reserved <= PAYLOAD_SIZE, "AsyncLog: too many arguments for one record");
+
+    auto ring = threadRing();
+    auto record = ring ? ring->claim() : nullptr;
+    if (!record)
+    {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    record->format = &format<AsyncLogArgument<Args>...>;
+    record->level = level;
+    auto out = record->payload;
+    std::size_t string_space = PAYLOAD_SIZE - reserved;
+    ((out += Argument<AsyncLogArgument<Args>>::encode(out, string_space, args)), ...);
+    ring->publish();
+  }
+
+  template <typename... Args>
+  void logDebug(const Args&... args) noexcept
+  {
+    AsyncLog::instance().write(LogLevel::DEBUG, args...);
+  }
+
+  template <typename... Args>
+  void logInfo(const Args&... args) noexcept
+  {
+    AsyncLog::instance().write(LogLevel::INFO, args...);
+  }
+
+  template <typename... Args>
+  void logWarn(const Args&... args) noexcept
+  {
+    AsyncLog::instance().write(LogLevel::WARN, args...);
+  }
+
+  template <typename... Args>
+  void logError(const Args&... args) noexcept
+  {
+    AsyncLog::instance().write(LogLevel::ERROR, args...);
+  }
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_ASYNC_LOG_HPP */
@@ -0,0 +1,153 @@
+#ifndef ROS2_BEHAVIORTREE_BATCHED_TREE_HPP
+#define ROS2_BEHAVIORTREE_BATCHED_TREE_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bt_ros
+{
+  /**
+   * Leaf of a BatchedTree, one object serves every instance of the tree.
+   *
+   * Each call gets the instances the leaf is ticked for and writes the
+   * status of instances[j] to statuses[j]. State kept per instance belongs
+   * in arrays indexed by instance, sized once by resize().
+   */
+  class BatchedLeaf
+  {
+  public:
+    virtual ~BatchedLeaf() = default;
+
+    virtual void resize(std::size_t instances) { static_cast<void>(instances); }
+
+    // Instances that were not RUNNING, like StatefulActionNode::onStart()
+    virtual void start(std::span<const std::uint32_t> instances, BT::NodeStatus* statuses) = 0;
+    // Instances still RUNNING from a previous tick, like onRunning()
+    virtual void running(std::span<const std::uint32_t> instances, BT::NodeStatus* statuses) = 0;
+    // A RUNNING instance was halted, like onHalted()
+    virtual void halted(std::uint32_t instance) { static_cast<void>(instance); }
+  };
+
+  // Leaf evaluated the same way on every tick, it never returns RUNNING
+  class BatchedCondition : public BatchedLeaf
+  {
+  public:
+    virtual void evaluate(std::span<const std::uint32_t> instances, BT::NodeStatus* statuses) = 0;
+
+    void start(std::span<const std::uint32_t> instances, BT::NodeStatus* statuses) final
+    {
+      evaluate(instances, statuses);
+    }
+
+    void running(std::span<const std::uint32_t> instances, BT::NodeStatus* statuses) final
+    {
+      evaluate(instances, statuses);
+    }
+  };
+
+  // Builders of the batched leaves by registration ID, one leaf per node of the tree
+  using BatchedLeaves = std::unordered_map<std::string, std::function<std::unique_ptr<BatchedLeaf>()>>;
+
+  /**
+   * Many instances of one tree ticked together, structure of arrays style.
+   *
+   * The structure is taken once from a prototype tree built by the factory
+   * and shared by every instance. The status of each node and the child
+   * index of each control node are stored per instance in contiguous
+   * arrays, one row per node, and each node is ticked once per tickAll()
+   * for all the instances that reach it: instead of walking a pointer graph
+   * per instance, a tick walks the rows, and leaves handle their instances
+   * in one call.
+   *
+   * Supported nodes: Sequence, Fallback, Inverter, SubTree and the leaves
+   * given a BatchedLeaf builder. They behave like their BT.CPP counterpart
+   * for each instance; ports, blackboards, pre/post conditions and tick
+   * callbacks of the prototype are not used. Not thread-safe.
+   */
+  class BatchedTree
+  {
+  public:
+    BatchedTree(const BT::Tree& prototype, const BatchedLeaves& leaves, std::size_t instances);
+
+    std::size_t instances() const { return instances_; }
+    std::size_t nodeCount() const { return nodes_.size(); }
+
+    // Tick every instance once, a completed instance starts over. Returns how many are RUNNING.
+    std::size_t tickAll();
+
+    // What the last tick of an instance returned, IDLE before the first one
+    BT::NodeStatus status(std::size_t instance) const { return results_[instance]; }
+
+    // Halt a RUNNING instance
+    void halt(std::size_t instance);
+    void haltAll();
+
+  private:
+    enum class Kind : std::uint8_t
+    {
+      SEQUENCE,
+      FALLBACK,
+      INVERTER,
+      // SubTree, returns what its child returns
+      FORWARD,
+      LEAF
+    };
+
+    struct Node
+    {
+      Kind kind;
+      // Range of children_
+      std::uint32_t first_child;
+      std::uint32_t child_count;
+      // Row of child_index_ and buffers_ of a control node, index in leaves_ of a leaf
+      std::uint32_t slot;
+    };
+
+    std::uint32_t add(const BT::TreeNode& node, const BatchedLeaves& leaves);
+
+    void tick(std::uint32_t node, std::span<const std::uint32_t> active);
+    void tickControl(std::uint32_t node, std::span<const std::uint32_t> active);
+    void tickLeaf(std::uint32_t node, std::span<const std::uint32_t> active);
+    void resetChildren(std::uint32_t node, std::uint32_t instance);
+    void halt(std::uint32_t node, std::uint32_t instance);
+
+    BT::NodeStatus& statusOf(std::uint32_t node, std::uint32_t instance)
+    {
+      return statuses_[static_cast<std::size_t>(node) * instances_ + instance];
+    }
+
+    std::uint32_t& childIndexOf(const Node& node, std::uint32_t instance)
+    {
+      return child_index_[static_cast<std::size_t>(node.slot) * instances_ + instance];
+    }
+
+    std::size_t instances_;
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> children_;
+    std::vector<std::unique_ptr<BatchedLeaf>> leaves_;
+    std::size_t controls_;
+
+    // One row per node
+    std::vector<BT::NodeStatus> statuses_;
+    // One row per control node
+    std::vector<std::uint32_t> child_index_;
+    // Three rows of instance lists per control node, and the lists of the leaf being ticked
+    std::vector<std::uint32_t> buffers_;
+    std::vector<std::uint32_t> starting_;
+    std::vector<std::uint32_t> running_;
+    std::vector<BT::NodeStatus> leaf_statuses_;
+    std::vector<std::uint32_t> all_;
+    std::vector<BT::NodeStatus> results_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_BATCHED_TREE_HPP */
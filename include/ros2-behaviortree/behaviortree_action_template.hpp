@@ -1,5 +1,274 @@
+#ifndef ROS2_BEHAVIORTREE_BEHAVIORTREE_ACTION_TEMPLATE_HPP
+#define ROS2_BEHAVIORTREE_BEHAVIORTREE_ACTION_TEMPLATE_HPP
+
 // ROS2
 #include <rclcpp/rclcpp.hpp>
+#include <rclcpp_action/rclcpp_action.hpp>
 
 // BT
 #include <behaviortree_cpp/action_node.h>
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace bt_ros
+{
+  enum class ActionNodeError
+  {
+    SERVER_UNAVAILABLE,
+    INVALID_GOAL,
+    GOAL_REJECTED
+  };
+
+  /**
+   * Asynchronous client of a ROS action server as a StatefulActionNode.
+   *
+   * onStart() sends the goal, onRunning() only checks whether the goal
+   * response is ready and reads the feedback and result stored by the
+   * client callbacks (never blocks), and onHalted() requests the
+   * cancellation without waiting for the answer. Responses emit the tree
+   * wake up signal, so a tree sleeping in Tree::sleep() is ticked as soon
+   * as something happened.
+   *
+   * The callbacks of a goal only own its GoalState, never the node: the
+   * tree can be destroyed while the executor keeps spinning.
+   *
+   * The rclcpp node must be spun by an executor on another thread.
+   */
+  template <typename ActionT>
+  class RosActionClientNode : public BT::StatefulActionNode
+  {
+  public:
+    using Client = rclcpp_action::Client<ActionT>;
+    using GoalHandle = rclcpp_action::ClientGoalHandle<ActionT>;
+    using WrappedResult = typename GoalHandle::WrappedResult;
+    using Goal = typename ActionT::Goal;
+    using Feedback = typename ActionT::Feedback;
+
+    RosActionClientNode(const std::string& name,
+        const BT::NodeConfig& config,
+        rclcpp::Node::SharedPtr node,
+        const std::string& action_name)
+      : BT::StatefulActionNode(name, config)
+      , node_{std::move(node)}
+      , client_{rclcpp_action::create_client<ActionT>(node_, action_name)}
+    {}
+
+    ~RosActionClientNode() override
+    {
+      detach();
+    }
+
+    // Fill the goal from the ports, return false if it cannot be built
+    virtual bool setGoal(Goal& goal) = 0;
+
+    // Status of the node once the action is done (succeeded, aborted or canceled)
+    virtual BT::NodeStatus onResult(const WrappedResult& result) = 0;
+
+    // Called for every new feedback, anything but RUNNING ends the node
+    virtual BT::NodeStatus onFeedback(const Feedback& /*feedback*/)
+    {
+      return BT::NodeStatus::RUNNING;
+    }
+
+    virtual BT::NodeStatus onFailure(ActionNodeError /*error*/)
+    {
+      return BT::NodeStatus::FAILURE;
+    }
+
+    BT::NodeStatus onStart() override
+    {
+      if (!client_->action_server_is_ready())
+      {
+        return onFailure(ActionNodeError::SERVER_UNAVAILABLE);
+      }
+
+      Goal goal;
+      if (!setGoal(goal))
+      {
+        return onFailure(ActionNodeError::INVALID_GOAL);
+      }
+
+      detach();
+      goal_handle_.reset();
+      state_ = std::make_shared<GoalState>(this, client_);
+
+      typename Client::SendGoalOptions options;
+      options.goal_response_callback = [state = state_](typename GoalHandle::SharedPtr handle)
+      {
+        // Halted before the server answered, cancel as soon as we can
+        if (handle && state->cancel_requested)
+        {
+          if (auto client = state->client.lock())
+          {
+            cancel(*client, handle);
+          }
+        }
+        state->wakeUp();
+      };
+      options.feedback_callback = [state = state_](typename GoalHandle::SharedPtr, const std::shared_ptr<const Feedback> feedback)
+      {
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          state->feedback = feedback;
+        }
+        state->wakeUp();
+      };
+      // The client forgets the goal handle once this ran, its result is only here
+      options.result_callback = [state = state_](const WrappedResult& result)
+      {
+        state->result = result;
+        state->has_result.store(true, std::memory_order_release);
+        state->wakeUp();
+      };
+      goal_handle_future_ = client_->async_send_goal(goal, options);
+
+      return BT::NodeStatus::RUNNING;
+    }
+
+    BT::NodeStatus onRunning() override
+    {
+      if (!goal_handle_)
+      {
+        if (!isReady(goal_handle_future_))
+        {
+          return BT::NodeStatus::RUNNING;
+        }
+        goal_handle_ = goal_handle_future_.get();
+        if (!goal_handle_)
+        {
+          detach();
+          return onFailure(ActionNodeError::GOAL_REJECTED);
+        }
+      }
+
+      std::shared_ptr<const Feedback> feedback;
+      {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        feedback.swap(state_->feedback);
+      }
+      if (feedback)
+      {
+        const auto status = onFeedback(*feedback);
+        if (BT::NodeStatus::RUNNING != status)
+        {
+          cancelGoal();
+          return status;
+        }
+      }
+
+      if (state_->has_result.load(std::memory_order_acquire))
+      {
+        const auto result = std::move(state_->result);
+        goal_handle_.reset();
+        detach();
+        return onResult(result);
+      }
+      return BT::NodeStatus::RUNNING;
+    }
+
+    void onHalted() override
+    {
+      if (!state_)
+      {
+        return;
+      }
+      // Seen by the goal response callback if the goal handle is not there yet
+      state_->cancel_requested = true;
+      if (!goal_handle_ && isReady(goal_handle_future_))
+      {
+        goal_handle_ = goal_handle_future_.get();
+      }
+      cancelGoal();
+    }
+
+  protected:
+    rclcpp::Node::SharedPtr node_;
+
+  private:
+    // What the client callbacks of one goal share with the node
+    struct GoalState
+    {
+      GoalState(BT::TreeNode* tree_node, const typename Client::SharedPtr& goal_client)
+        : node{tree_node}
+        , client{goal_client}
+        , cancel_requested{false}
+        , has_result{false}
+      {}
+
+      void wakeUp()
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (node)
+        {
+          node->emitWakeUpSignal();
+        }
+      }
+
+      std::mutex mutex;
+      // Reset under the mutex once the node is done with the goal
+      BT::TreeNode* node;
+      std::weak_ptr<Client> client;
+      std::shared_ptr<const Feedback> feedback;
+      std::atomic<bool> cancel_requested;
+      // Written before has_result is set, read after
+      WrappedResult result;
+      std::atomic<bool> has_result;
+    };
+
+    template <typename FutureT>
+    static bool isReady(const FutureT& future)
+    {
+      return future.valid()
+        && std::future_status::ready == future.wait_for(std::chrono::seconds(0));
+    }
+
+    // The client drops a goal once it is done, a cancellation racing with its result is a no-op
+    static void cancel(Client& client, const typename GoalHandle::SharedPtr& handle)
+    {
+      try
+      {
+        client.async_cancel_goal(handle);
+      }
+      catch (const rclcpp_action::exceptions::UnknownGoalHandleError&)
+      {
+      }
+    }
+
+    // Cancel the current goal unless its result already arrived, and forget it
+    void cancelGoal()
+    {
+      if (goal_handle_ && !state_->has_result.load(std::memory_order_acquire))
+      {
+        cancel(*client_, goal_handle_);
+      }
+      goal_handle_.reset();
+      goal_handle_future_ = {};
+      detach();
+    }
+
+    // The callbacks of the current goal, if still running, stop waking the node up
+    void detach()
+    {
+      if (state_)
+      {
+        {
+          std::lock_guard<std::mutex> lock(state_->mutex);
+          state_->node = nullptr;
+        }
+        state_.reset();
+      }
+    }
+
+    typename Client::SharedPtr client_;
+    std::shared_future<typename GoalHandle::SharedPtr> goal_handle_future_;
+    typename GoalHandle::SharedPtr goal_handle_;
+    std::shared_ptr<GoalState> state_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_BEHAVIORTREE_ACTION_TEMPLATE_HPP */
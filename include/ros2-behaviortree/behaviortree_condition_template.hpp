@@ -0,0 +1,142 @@
+#ifndef ROS2_BEHAVIORTREE_BEHAVIORTREE_CONDITION_TEMPLATE_HPP
+#define ROS2_BEHAVIORTREE_BEHAVIORTREE_CONDITION_TEMPLATE_HPP
+
+// ROS2
+#include <rclcpp/rclcpp.hpp>
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+#include <behaviortree_cpp/condition_node.h>
+
+// STL
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace bt_ros
+{
+  // Default predicate, for messages with a boolean-like data field (std_msgs/Bool)
+  struct DataIsTrue
+  {
+    template <typename MsgT>
+    bool operator()(const MsgT& msg) const
+    {
+      return static_cast<bool>(msg.data);
+    }
+  };
+
+  /**
+   * Condition node driven by the latest message of a topic.
+   *
+   * The subscription keeps the received message as a shared_ptr<const MsgT>,
+   * so nothing is copied (zero copy with intra-process communication), and
+   * tick() only evaluates the predicate on the cached message: SUCCESS if it
+   * holds, FAILURE otherwise. With a positive max_age, a message older than
+   * max_age is stale and the condition returns FAILURE.
+   *
+   * The node does not spin, the rclcpp node must be spun by an executor.
+   * The callback only owns the shared Latest slot, never the node, so the
+   * tree can be destroyed while the executor keeps spinning.
+   */
+  template <typename MsgT, typename Predicate = DataIsTrue>
+  class TopicCondition : public BT::ConditionNode
+  {
+  public:
+    TopicCondition(const std::string& name,
+        const BT::NodeConfig& config,
+        rclcpp::Node::SharedPtr node,
+        const std::string& topic,
+        std::chrono::nanoseconds max_age = std::chrono::nanoseconds::zero(),
+        Predicate predicate = Predicate{},
+        const rclcpp::QoS& qos = rclcpp::QoS(5))
+      : BT::ConditionNode(name, config)
+      , node_{std::move(node)}
+      , max_age_{max_age}
+      , predicate_{std::move(predicate)}
+      , latest_{std::make_shared<Latest>()}
+    {
+      sub_ = node_->create_subscription<MsgT>(
+          topic,
+          qos,
+          [latest = latest_](std::shared_ptr<const MsgT> msg)
+          {
+            const auto stamp = now();
+            {
+              std::lock_guard<std::mutex> lock(latest->mutex);
+              latest->msg.swap(msg);
+              latest->stamp = stamp;
+            }
+            // The previous message, if any, is released out of the lock
+          }
+        );
+    }
+
+    static BT::PortsList providedPorts() { return {}; }
+
+    BT::NodeStatus tick() override
+    {
+      std::shared_ptr<const MsgT> msg;
+      std::int64_t stamp;
+      {
+        std::lock_guard<std::mutex> lock(latest_->mutex);
+        msg = latest_->msg;
+        stamp = latest_->stamp;
+      }
+      if (!msg)
+      {
+        return BT::NodeStatus::FAILURE;
+      }
+      if (max_age_ > std::chrono::nanoseconds::zero() && now() - stamp > max_age_.count())
+      {
+        return BT::NodeStatus::FAILURE;
+      }
+      return predicate_(*msg) ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
+    }
+
+    // Latest message received, nullptr if none yet
+    std::shared_ptr<const MsgT> latest() const
+    {
+      std::lock_guard<std::mutex> lock(latest_->mutex);
+      return latest_->msg;
+    }
+
+  private:
+    // Written by the subscription, shared with its callback so that it
+    // outlives the node. Only a pointer copy is made under the lock.
+    struct Latest
+    {
+      std::mutex mutex;
+      std::shared_ptr<const MsgT> msg;
+      std::int64_t stamp = 0;
+    };
+
+    static std::int64_t now()
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    rclcpp::Node::SharedPtr node_;
+    std::chrono::nanoseconds max_age_;
+    Predicate predicate_;
+    std::shared_ptr<Latest> latest_;
+    typename rclcpp::Subscription<MsgT>::SharedPtr sub_;
+  };
+
+  // Helper to register a TopicCondition, e.g.
+  // registerTopicCondition<std_msgs::msg::Bool>(factory, "BallFound", node, "bt/feedback/ball_found", 500ms);
+  template <typename MsgT, typename Predicate = DataIsTrue>
+  void registerTopicCondition(BT::BehaviorTreeFactory& factory,
+      const std::string& ID,
+      rclcpp::Node::SharedPtr node,
+      const std::string& topic,
+      std::chrono::nanoseconds max_age = std::chrono::nanoseconds::zero(),
+      Predicate predicate = Predicate{})
+  {
+    factory.registerNodeType<TopicCondition<MsgT, Predicate>>(ID, node, topic, max_age, predicate);
+  }
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_BEHAVIORTREE_CONDITION_TEMPLATE_HPP */
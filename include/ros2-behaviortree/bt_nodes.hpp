@@ -0,0 +1,59 @@
+#ifndef ROS2_BEHAVIORTREE_BT_NODES_HPP
+#define ROS2_BEHAVIORTREE_BT_NODES_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "ros2-behaviortree/bt_ros.hpp"
+
+namespace bt_ros
+{
+  // SUCCESS while the latest feedback of a condition is true
+  class FeedbackCondition : public BT::ConditionNode
+  {
+  public:
+    FeedbackCondition(const std::string& name,
+        const BT::NodeConfig& config,
+        std::shared_ptr<NodeHandler> handler,
+        std::size_t index);
+
+    static BT::PortsList providedPorts() { return {}; }
+
+    BT::NodeStatus tick() override;
+
+  private:
+    std::shared_ptr<NodeHandler> handler_;
+    std::size_t index_;
+  };
+
+  // Publishes its state, then RUNNING until its condition reports true
+  class FeedbackAction : public BT::StatefulActionNode
+  {
+  public:
+    FeedbackAction(const std::string& name,
+        const BT::NodeConfig& config,
+        std::shared_ptr<NodeHandler> handler,
+        std::size_t index);
+
+    static BT::PortsList providedPorts() { return {}; }
+
+    BT::NodeStatus onStart() override;
+    BT::NodeStatus onRunning() override;
+    void onHalted() override;
+
+  private:
+    std::shared_ptr<NodeHandler> handler_;
+    std::size_t index_;
+    common::StateId state_;
+    std::uint64_t start_sequence_;
+  };
+
+  // Register every condition and action of common_defs.hpp
+  void registerNodes(BT::BehaviorTreeFactory& factory, const std::shared_ptr<NodeHandler>& handler);
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_BT_NODES_HPP */
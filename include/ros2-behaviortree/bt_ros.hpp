@@ -5,28 +5,70 @@
 #include <rclcpp/rclcpp.hpp>
 #include <std_msgs/msg/bool.hpp>
 #include <std_msgs/msg/string.hpp>
+#include <std_msgs/msg/u_int8.hpp>
 
 // STL
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <optional>
+#include <vector>
 
 #include "ros2-behaviortree/common_defs.hpp"
+#include "ros2-behaviortree/feedback_mailbox.hpp"
 
 namespace bt_ros
 {
   class NodeHandler : public rclcpp::Node
   {
   public:
-    NodeHandler();
+    using Mailbox = FeedbackMailbox<common::CONDITION_COUNT>;
+
+    explicit NodeHandler(const rclcpp::NodeOptions& options = rclcpp::NodeOptions());
     ~NodeHandler();
+
+    // The methods below are meant to be called from the tick thread only,
+    // the mailbox itself may be written concurrently by any executor thread
+
+    // Forget every feedback received so far
     void startCondition();
-    std::optional<bool> getCondition();
+    // Latest value of a condition, if it has been updated since startCondition()
+    std::optional<bool> getCondition(std::size_t index = 0);
+    // Lock-free access to every condition slot
+    const Mailbox& feedback() const { return mailbox_; }
+
+    // Called from the subscription callback when a burst of feedback starts,
+    // typically to emit the tree wake up signal. Set it before spinning.
+    void setWakeUpHandler(std::function<void()> handler);
+    // Arrival time of the first feedback received since the previous call,
+    // the following messages of the same burst are merged into it
+    std::optional<std::chrono::steady_clock::time_point> consumeWakeUp();
+
+    // Free-form state on bt/state, allocates a message on every call
     void publishState(const std::string& state);
+    // Compact state on bt/state_id without heap allocation, decode it with
+    // the table latched on bt/state_table
+    void publishState(common::StateId state);
 
   private:
-    bool update_, condition_;
+    void notifyFeedback();
+
+    Mailbox mailbox_;
+    std::array<std::uint64_t, common::CONDITION_COUNT> consumed_;
+    // steady_clock nanoseconds of the pending burst, 0 when nothing is pending
+    std::atomic<std::int64_t> pending_since_;
+    std::function<void()> wake_up_handler_;
     rclcpp::Publisher<std_msgs::msg::String>::SharedPtr pub_;
+    rclcpp::Publisher<std_msgs::msg::UInt8>::SharedPtr state_id_pub_;
+    rclcpp::Publisher<std_msgs::msg::String>::SharedPtr state_table_pub_;
+    // Reused when the middleware cannot loan messages
+    std_msgs::msg::UInt8 state_id_msg_;
+    // bt/feedback is kept for single condition users and feeds CONDITION_NAME_1
     rclcpp::Subscription<std_msgs::msg::Bool>::SharedPtr sub_;
+    std::vector<rclcpp::Subscription<std_msgs::msg::Bool>::SharedPtr> condition_subs_;
   };
 } // bt_ros
 #endif /* ROS2_BEHAVIORTREE_BT_ROS_HPP */
@@ -0,0 +1,76 @@
+#ifndef ROS2_BEHAVIORTREE_CACHED_INPUT_HPP
+#define ROS2_BEHAVIORTREE_CACHED_INPUT_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace bt_ros
+{
+  /**
+   * Input port of a node whose literal value is converted only once.
+   *
+   * TreeNode::getInput<T>() converts a literal port (goal="1;2;3") from its
+   * string on every call. CachedInput keeps the value converted by the first
+   * successful get() and returns it from then on. Ports remapped to the
+   * blackboard ({goal}) and ports not set in the XML are always read live
+   * through getInput<T>(), so they keep their usual semantics.
+   *
+   * Meant to be a member of the node owning the port, e.g.
+   *   goal_input_{*this, "goal"} in the node constructor.
+   */
+  template <typename T>
+  class CachedInput
+  {
+  public:
+    CachedInput(const BT::TreeNode& node, std::string port)
+      : node_{node}
+      , port_{std::move(port)}
+      , checked_{false}
+    {}
+
+    BT::Expected<T> get()
+    {
+      if (value_)
+      {
+        return *value_;
+      }
+
+      if (!checked_)
+      {
+        // The remapping is only known once the node is fully configured, look at it on first use
+        checked_ = true;
+        const auto& ports = node_.config().input_ports;
+        const auto it = ports.find(port_);
+        if (ports.end() != it && !it->second.empty()
+            && !BT::TreeNode::isBlackboardPointer(it->second))
+        {
+          auto value = node_.getInput<T>(port_);
+          if (value)
+          {
+            value_ = value.value();
+          }
+          return value;
+        }
+      }
+      return node_.getInput<T>(port_);
+    }
+
+    // True once a literal value has been converted and cached
+    bool cached() const
+    {
+      return value_.has_value();
+    }
+
+  private:
+    const BT::TreeNode& node_;
+    std::string port_;
+    bool checked_;
+    std::optional<T> value_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_CACHED_INPUT_HPP */
@@ -0,0 +1,91 @@
+#ifndef ROS2_BEHAVIORTREE_CHROME_TRACER_HPP
+#define ROS2_BEHAVIORTREE_CHROME_TRACER_HPP
+
+// STL
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ros2-behaviortree/tick_hooks.hpp"
+
+namespace bt_ros
+{
+  /**
+   * Records node ticks as Chrome trace events, for chrome://tracing,
+   * ui.perfetto.dev or speedscope.
+   *
+   * Each tick becomes a complete ("X") slice named after the node, on the
+   * track of the thread ticking it: a Sequence contains the slices of its
+   * children, a SubTree the slices of its tree, the same way the tree is
+   * nested. The arguments of a slice hold the node path (the keys of
+   * BT::TreeObserver::pathToUID()), its UID and the returned status.
+   *
+   * A tick costs the clock reads of TickHooks (one per event, a single one
+   * for both with the tick monitor) and one 24-byte store into a ring kept
+   * in memory: only the last `capacity` ticks are kept, nothing is formatted
+   * before write(). write() is called while the tree is not ticking.
+   *
+   * With the tick monitor the start of a slice is its end minus a duration
+   * in whole microseconds, so it may come after the start of its first
+   * child: write() extends every slice back over the slices of its
+   * descendants, and only parent starts are approximate.
+   */
+  class ChromeTracer : public TickListener
+  {
+  public:
+    // capacity is rounded up to a power of two
+    explicit ChromeTracer(TickHooks& hooks, std::size_t capacity = 1 << 18);
+    ~ChromeTracer();
+
+    ChromeTracer(const ChromeTracer&) = delete;
+    ChromeTracer& operator=(const ChromeTracer&) = delete;
+
+    // Trace event JSON, oldest slice first
+    void write(std::ostream& out) const;
+    // Creates the parent directories, throws BT::RuntimeError when the file cannot be written
+    void write(const std::string& path) const;
+
+    // Ticks recorded, overwritten ones included
+    std::uint64_t recorded() const;
+
+    void onTickStart(const BT::TreeNode& node, Clock::time_point time) override;
+    void onTickEnd(const BT::TreeNode& node, BT::NodeStatus status, Clock::time_point time) override;
+
+  private:
+    // True if `ancestor` is the parent of the node `uid`, or one of its ancestors
+    bool isDescendant(std::uint16_t uid, std::uint16_t ancestor) const;
+
+    struct Slice
+    {
+      std::uint64_t start_ns;
+      std::uint64_t duration_ns;
+      std::uint16_t uid;
+      std::uint8_t status;
+      std::uint8_t thread;
+    };
+    static_assert(24 == sizeof(Slice));
+
+    static constexpr std::uint16_t NO_PARENT = 0xffff;
+
+    struct NodeState
+    {
+      const BT::TreeNode* node = nullptr;
+      std::uint16_t parent = NO_PARENT;
+      Clock::time_point tick_start;
+      bool ticking = false;
+    };
+
+    TickHooks& hooks_;
+    Clock::time_point origin_;
+    // Indexed by UID
+    std::vector<NodeState> states_;
+    std::unique_ptr<Slice[]> slices_;
+    std::uint64_t mask_;
+    std::atomic<std::uint64_t> next_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_CHROME_TRACER_HPP */
@@ -1,6 +1,9 @@
 #ifndef ROS2_BEHAVIORTREE_COMMON_DEFS_HPP
 #define ROS2_BEHAVIORTREE_COMMON_DEFS_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string_view>
 
 namespace common
@@ -13,12 +16,64 @@ namespace common
   static std::string_view CONDITION_NAME_4 = "Bin Close";
   static std::string_view CONDITION_NAME_5 = "Ball Placed";
 
+  static constexpr std::size_t CONDITION_COUNT = 5;
+  static std::array<std::string_view, CONDITION_COUNT> CONDITION_NAMES = {
+    CONDITION_NAME_1, CONDITION_NAME_2, CONDITION_NAME_3, CONDITION_NAME_4, CONDITION_NAME_5
+  };
+  // Feedback topic of each condition, in the same order as CONDITION_NAMES
+  static constexpr std::array<std::string_view, CONDITION_COUNT> CONDITION_TOPICS = {
+    "bt/feedback/ball_found",
+    "bt/feedback/ball_close",
+    "bt/feedback/ball_grasped",
+    "bt/feedback/bin_close",
+    "bt/feedback/ball_placed"
+  };
+
   // Action
   static std::string_view ACTION_NAME_1 = "Find Found";
   static std::string_view ACTION_NAME_2 = "Approach Ball";
   static std::string_view ACTION_NAME_3 = "Grasp Ball";
   static std::string_view ACTION_NAME_4 = "Approach Bin";
   static std::string_view ACTION_NAME_5 = "Place Ball";
+
+  static constexpr std::size_t ACTION_COUNT = 5;
+  static std::array<std::string_view, ACTION_COUNT> ACTION_NAMES = {
+    ACTION_NAME_1, ACTION_NAME_2, ACTION_NAME_3, ACTION_NAME_4, ACTION_NAME_5
+  };
+
+  // Tree node IDs, action i completes once condition i becomes true
+  static constexpr std::array<std::string_view, CONDITION_COUNT> CONDITION_IDS = {
+    "BallFound", "BallClose", "BallGrasped", "BinClose", "BallPlaced"
+  };
+  static constexpr std::array<std::string_view, ACTION_COUNT> ACTION_IDS = {
+    "FindBall", "ApproachBall", "GraspBall", "ApproachBin", "PlaceBall"
+  };
+
+  // Compact state published on bt/state_id, action i is state i + 1
+  enum class StateId : std::uint8_t
+  {
+    IDLE = 0,
+    FIND_BALL,
+    APPROACH_BALL,
+    GRASP_BALL,
+    APPROACH_BIN,
+    PLACE_BALL
+  };
+
+  inline StateId actionState(std::size_t action_index)
+  {
+    return static_cast<StateId>(action_index + 1);
+  }
+
+  inline std::string_view stateName(StateId state)
+  {
+    const auto index = static_cast<std::size_t>(state);
+    if (0 == index || index > ACTION_COUNT)
+    {
+      return "Idle";
+    }
+    return ACTION_NAMES[index - 1];
+  }
 } // common
 
 #endif /* ROS2_BEHAVIORTREE_COMMON_DEFS_HPP */
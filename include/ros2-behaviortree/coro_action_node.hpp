@@ -0,0 +1,286 @@
+#ifndef ROS2_BEHAVIORTREE_CORO_ACTION_NODE_HPP
+#define ROS2_BEHAVIORTREE_CORO_ACTION_NODE_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <future>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "ros2-behaviortree/deadline_service.hpp"
+
+namespace bt_ros
+{
+  class CoroAwaiter;
+
+  // Thrown out of the pending co_await of a CoroActionNode when it is halted
+  class ActionCancelled : public std::exception
+  {
+  public:
+    const char* what() const noexcept override { return "action halted"; }
+  };
+
+  // Coroutine returned by CoroActionNode::run(), it co_returns SUCCESS or FAILURE
+  class CoroAction
+  {
+  public:
+    struct promise_type
+    {
+      BT::NodeStatus result = BT::NodeStatus::IDLE;
+      std::exception_ptr error;
+      // Awaiter the body is suspended on, checked on every tick
+      CoroAwaiter* waiting = nullptr;
+      bool cancelled = false;
+
+      CoroAction get_return_object()
+      {
+        return CoroAction{std::coroutine_handle<promise_type>::from_promise(*this)};
+      }
+      // The body starts on the first tick, and stays suspended once done
+      std::suspend_always initial_suspend() noexcept { return {}; }
+      std::suspend_always final_suspend() noexcept { return {}; }
+      void return_value(BT::NodeStatus status) { result = status; }
+      void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    CoroAction() = default;
+    CoroAction(CoroAction&& other) noexcept
+      : handle_{std::exchange(other.handle_, nullptr)}
+    {}
+    CoroAction& operator=(CoroAction&& other) noexcept
+    {
+      if (this != &other)
+      {
+        reset();
+        handle_ = std::exchange(other.handle_, nullptr);
+      }
+      return *this;
+    }
+    ~CoroAction() { reset(); }
+
+    explicit operator bool() const { return static_cast<bool>(handle_); }
+    bool done() const { return handle_.done(); }
+    void resume() { handle_.resume(); }
+    promise_type& promise() { return handle_.promise(); }
+
+    // Destroy the frame, suspended or not: locals and pending awaiters are destroyed
+    void reset()
+    {
+      if (handle_)
+      {
+        std::exchange(handle_, nullptr).destroy();
+      }
+    }
+
+  private:
+    explicit CoroAction(std::coroutine_handle<promise_type> handle)
+      : handle_{handle}
+    {}
+
+    std::coroutine_handle<promise_type> handle_;
+  };
+
+  /**
+   * Base of what the body of a CoroActionNode can co_await.
+   *
+   * The node checks ready() on each tick and resumes the body only once it
+   * returns true. await_resume() of a derived awaiter calls resumed() first,
+   * which throws ActionCancelled when the node was halted.
+   */
+  class CoroAwaiter
+  {
+  public:
+    CoroAwaiter() = default;
+    CoroAwaiter(const CoroAwaiter&) = delete;
+    CoroAwaiter& operator=(const CoroAwaiter&) = delete;
+    virtual ~CoroAwaiter() = default;
+
+    virtual bool ready() = 0;
+
+    bool await_ready() { return ready(); }
+    void await_suspend(std::coroutine_handle<CoroAction::promise_type> handle)
+    {
+      promise_ = &handle.promise();
+      promise_->waiting = this;
+    }
+
+  protected:
+    void resumed() const
+    {
+      if (promise_ && promise_->cancelled)
+      {
+        throw ActionCancelled{};
+      }
+    }
+
+  private:
+    CoroAction::promise_type* promise_ = nullptr;
+  };
+
+  // Ready once the timeout elapsed, the deadline wakes the tree up
+  class SleepAwaiter : public CoroAwaiter
+  {
+  public:
+    SleepAwaiter(BT::TreeNode& node, DeadlineService& deadlines, std::chrono::nanoseconds timeout);
+    ~SleepAwaiter() override;
+
+    bool ready() override { return expired_; }
+    void await_resume() const { resumed(); }
+
+  private:
+    DeadlineService& deadlines_;
+    TimerWheel::Handle handle_;
+    bool expired_;
+  };
+
+  // Ready once the future is, e.g. the std::shared_future of a ROS service client
+  template <typename Future>
+  class FutureAwaiter : public CoroAwaiter
+  {
+  public:
+    explicit FutureAwaiter(Future future)
+      : future_{std::move(future)}
+    {}
+
+    bool ready() override
+    {
+      return std::future_status::ready == future_.wait_for(std::chrono::seconds::zero());
+    }
+
+    auto await_resume()
+    {
+      resumed();
+      using Value = std::decay_t<decltype(future_.get())>;
+      if constexpr (std::is_void_v<Value>)
+      {
+        future_.get();
+      }
+      else
+      {
+        return Value{future_.get()};
+      }
+    }
+
+  private:
+    Future future_;
+  };
+
+  // Ready once the condition holds, e.g. a flag set by a ROS callback
+  class UntilAwaiter : public CoroAwaiter
+  {
+  public:
+    explicit UntilAwaiter(std::function<bool()> condition)
+      : condition_{std::move(condition)}
+    {}
+
+    bool ready() override { return condition_(); }
+    void await_resume() const { resumed(); }
+
+  private:
+    std::function<bool()> condition_;
+  };
+
+  // Ready once an input port reads a value different from the one it had at the co_await
+  template <typename T>
+  class InputChangeAwaiter : public CoroAwaiter
+  {
+  public:
+    InputChangeAwaiter(const BT::TreeNode& node, std::string port)
+      : node_{node}
+      , port_{std::move(port)}
+      , last_{read()}
+    {}
+
+    bool ready() override
+    {
+      current_ = read();
+      return current_ && current_ != last_;
+    }
+
+    T await_resume()
+    {
+      resumed();
+      return std::move(*current_);
+    }
+
+  private:
+    std::optional<T> read() const
+    {
+      auto value = node_.getInput<T>(port_);
+      return value ? std::optional<T>{std::move(value.value())} : std::nullopt;
+    }
+
+    const BT::TreeNode& node_;
+    std::string port_;
+    std::optional<T> last_;
+    std::optional<T> current_;
+  };
+
+  /**
+   * Action node written as a coroutine instead of onStart/onRunning/onHalted.
+   *
+   *   bt_ros::CoroAction run() override
+   *   {
+   *     co_await sleepFor(deadlines_, std::chrono::milliseconds(200));
+   *     auto reply = co_await waitFor(client_->async_send_request(request));
+   *     co_return reply->success ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
+   *   }
+   *
+   * run() starts on the first tick and runs on the tick thread up to its
+   * first co_await. Later ticks only check whether the awaited event
+   * completed and resume the body when it did; the node is RUNNING until
+   * the body co_returns. The timers of sleepFor() wake the tree up when they
+   * expire; futures, conditions and inputs are checked on every tick.
+   *
+   * halt() resumes a suspended body with ActionCancelled thrown from its
+   * pending co_await, so that try/catch or destructors can clean up, then
+   * destroys the coroutine. A body must not co_await after cancellation.
+   */
+  class CoroActionNode : public BT::ActionNodeBase
+  {
+  public:
+    CoroActionNode(const std::string& name, const BT::NodeConfig& config);
+    ~CoroActionNode() override;
+
+    void halt() override;
+
+  protected:
+    virtual CoroAction run() = 0;
+
+    SleepAwaiter sleepFor(DeadlineService& deadlines, std::chrono::nanoseconds timeout)
+    {
+      return SleepAwaiter{*this, deadlines, timeout};
+    }
+
+    template <typename Future>
+    FutureAwaiter<Future> waitFor(Future future)
+    {
+      return FutureAwaiter<Future>{std::move(future)};
+    }
+
+    UntilAwaiter until(std::function<bool()> condition)
+    {
+      return UntilAwaiter{std::move(condition)};
+    }
+
+    template <typename T>
+    InputChangeAwaiter<T> inputChanged(std::string port)
+    {
+      return InputChangeAwaiter<T>{*this, std::move(port)};
+    }
+
+  private:
+    BT::NodeStatus tick() override;
+
+    CoroAction action_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_CORO_ACTION_NODE_HPP */
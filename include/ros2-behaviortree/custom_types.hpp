@@ -0,0 +1,109 @@
+#ifndef ROS2_BEHAVIORTREE_CUSTOM_TYPES_HPP
+#define ROS2_BEHAVIORTREE_CUSTOM_TYPES_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace bt_ros
+{
+  struct Position2D
+  {
+    float x;
+    float y;
+  };
+
+  struct Pose2D
+  {
+    float x, y, theta;
+  };
+
+  /**
+   * Parse exactly N real numbers separated by `delimiter` ("1.5;-2;0.3").
+   *
+   * Spaces around a field are ignored. Every field goes through
+   * std::from_chars straight into `out`, nothing is allocated (unlike
+   * BT::splitString, which builds a vector). Returns false on a wrong number
+   * of fields or on anything that is not a number, `out` is then unspecified.
+   */
+  template <std::size_t N>
+  bool parseFloats(std::string_view str, std::array<float, N>& out, char delimiter = ';') noexcept
+  {
+    const auto is_space = [](char c) { return ' ' == c || '\t' == c; };
+
+    std::size_t field = 0;
+    const char* it = str.data();
+    const char* const end = it + str.size();
+    while (true)
+    {
+      if (N == field)
+      {
+        return false;
+      }
+      while (it != end && is_space(*it))
+      {
+        ++it;
+      }
+      // from_chars does not accept a leading '+', convertFromString<float> did
+      if (it != end && '+' == *it)
+      {
+        ++it;
+      }
+      const auto [ptr, ec] = std::from_chars(it, end, out[field]);
+      if (std::errc{} != ec)
+      {
+        return false;
+      }
+      it = ptr;
+      while (it != end && is_space(*it))
+      {
+        ++it;
+      }
+      ++field;
+      if (it == end)
+      {
+        return N == field;
+      }
+      if (delimiter != *it)
+      {
+        return false;
+      }
+      ++it;
+    }
+  }
+} // bt_ros
+
+// To allow xml loader to instantiate the custom types from a string, we need to provide
+// a template specialization of `BT::convertFromString<T>(StringView)`
+namespace BT
+{
+  template <> inline bt_ros::Position2D convertFromString(StringView str)
+  {
+    // We expect real numbers separeted by semicolons
+    std::array<float, 2> parts;
+    if (!bt_ros::parseFloats(str, parts))
+    {
+      throw RuntimeError("invalid Position2D input: ", str);
+    }
+    return {parts[0], parts[1]};
+  }
+
+  template <> inline bt_ros::Pose2D convertFromString(StringView str)
+  {
+    // We expect real numbers separeted by semicolons
+    std::array<float, 3> parts;
+    if (!bt_ros::parseFloats(str, parts))
+    {
+      throw RuntimeError("invalid Pose2D input: ", str);
+    }
+    return {parts[0], parts[1], parts[2]};
+  }
+} // end namespace BT
+#endif /* ROS2_BEHAVIORTREE_CUSTOM_TYPES_HPP */
@@ -0,0 +1,67 @@
+#ifndef ROS2_BEHAVIORTREE_DEADLINE_SERVICE_HPP
+#define ROS2_BEHAVIORTREE_DEADLINE_SERVICE_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <chrono>
+#include <optional>
+
+#include "ros2-behaviortree/timer_wheel.hpp"
+
+namespace bt_ros
+{
+  /**
+   * Deadlines shared by the asynchronous nodes of one or more trees.
+   *
+   * Nodes arm a DeadlineTimer instead of comparing the clock against a
+   * completion time on every tick. The loop ticking the tree sleeps until the
+   * next deadline (or a wake up signal) and fires the expired ones, which
+   * wakes their nodes up. Like the timer wheel it is driven from the tick thread.
+   */
+  class DeadlineService
+  {
+  public:
+    using Clock = TimerWheel::Clock;
+
+    explicit DeadlineService(std::chrono::nanoseconds resolution = std::chrono::milliseconds(1));
+
+    // Fire every expired deadline, returns how many fired
+    std::size_t poll();
+
+    // Lower bound of the next deadline, nullopt if none is armed
+    std::optional<Clock::time_point> nextExpiry() const { return wheel_.nextExpiry(); }
+
+    // Sleep until a deadline fires, the tree is woken up or max_wait elapsed.
+    // Returns true when the tree should be ticked again before max_wait.
+    bool sleep(BT::Tree& tree, std::chrono::nanoseconds max_wait);
+
+    TimerWheel& wheel() { return wheel_; }
+
+  private:
+    TimerWheel wheel_;
+  };
+
+  // One-shot deadline owned by a node, typically started in onStart()
+  class DeadlineTimer
+  {
+  public:
+    explicit DeadlineTimer(DeadlineService& service);
+    ~DeadlineTimer();
+
+    DeadlineTimer(const DeadlineTimer&) = delete;
+    DeadlineTimer& operator=(const DeadlineTimer&) = delete;
+
+    // (Re)arm the timer, node is woken up once it expires
+    void start(BT::TreeNode& node, std::chrono::nanoseconds timeout);
+    void cancel();
+    bool expired() const { return expired_; }
+
+  private:
+    DeadlineService& service_;
+    TimerWheel::Handle handle_;
+    bool expired_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_DEADLINE_SERVICE_HPP */
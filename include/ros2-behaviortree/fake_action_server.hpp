@@ -0,0 +1,156 @@
+#ifndef ROS2_BEHAVIORTREE_FAKE_ACTION_SERVER_HPP
+#define ROS2_BEHAVIORTREE_FAKE_ACTION_SERVER_HPP
+
+// ROS2
+#include <rclcpp/rclcpp.hpp>
+#include <rclcpp_action/rclcpp_action.hpp>
+
+// STL
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bt_ros
+{
+  /**
+   * Local action server for tests and demos of RosActionClientNode.
+   *
+   * Every goal is accepted (unless rejectGoals() is set) and finishes after a
+   * fixed duration, with the outcome chosen by succeedGoals(). Cancel requests
+   * are always accepted. Goals are completed from a wall timer, the server
+   * never blocks an executor thread.
+   */
+  template <typename ActionT>
+  class FakeActionServer
+  {
+  public:
+    using ServerGoalHandle = rclcpp_action::ServerGoalHandle<ActionT>;
+    using Goal = typename ActionT::Goal;
+    using Result = typename ActionT::Result;
+    // Optional hook to fill the result of a goal before it completes
+    using ResultFiller = std::function<void(const Goal&, Result&)>;
+
+    FakeActionServer(rclcpp::Node::SharedPtr node,
+        const std::string& action_name,
+        std::chrono::milliseconds duration,
+        ResultFiller result_filler = nullptr)
+      : duration_{duration}
+      , result_filler_{std::move(result_filler)}
+      , reject_goals_{false}
+      , succeed_goals_{true}
+      , finished_goals_{0}
+      , canceled_goals_{0}
+    {
+      server_ = rclcpp_action::create_server<ActionT>(
+          node,
+          action_name,
+          [this](const rclcpp_action::GoalUUID&, std::shared_ptr<const Goal>)
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return reject_goals_ ? rclcpp_action::GoalResponse::REJECT
+              : rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+          },
+          [](const std::shared_ptr<ServerGoalHandle>)
+          {
+            return rclcpp_action::CancelResponse::ACCEPT;
+          },
+          [this](const std::shared_ptr<ServerGoalHandle> handle)
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            goals_.push_back({handle, std::chrono::steady_clock::now() + duration_});
+          }
+        );
+      timer_ = node->create_wall_timer(std::chrono::milliseconds(5), [this](){ update(); });
+    }
+
+    void rejectGoals(bool reject)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      reject_goals_ = reject;
+    }
+
+    void succeedGoals(bool succeed)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      succeed_goals_ = succeed;
+    }
+
+    std::size_t activeGoals() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return goals_.size();
+    }
+
+    // Goals completed so far, whatever their outcome
+    std::size_t finishedGoals() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return finished_goals_;
+    }
+
+    // Goals completed as canceled so far
+    std::size_t canceledGoals() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return canceled_goals_;
+    }
+
+  private:
+    struct PendingGoal
+    {
+      std::shared_ptr<ServerGoalHandle> handle;
+      std::chrono::steady_clock::time_point deadline;
+    };
+
+    void update()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const auto now = std::chrono::steady_clock::now();
+      for (auto it = goals_.begin(); it != goals_.end();)
+      {
+        auto& handle = it->handle;
+        if (!handle->is_canceling() && now < it->deadline)
+        {
+          ++it;
+          continue;
+        }
+
+        auto result = std::make_shared<Result>();
+        if (result_filler_)
+        {
+          result_filler_(*handle->get_goal(), *result);
+        }
+        if (handle->is_canceling())
+        {
+          handle->canceled(result);
+          ++canceled_goals_;
+        }
+        else if (succeed_goals_)
+        {
+          handle->succeed(result);
+        }
+        else
+        {
+          handle->abort(result);
+        }
+        ++finished_goals_;
+        it = goals_.erase(it);
+      }
+    }
+
+    std::chrono::milliseconds duration_;
+    ResultFiller result_filler_;
+    mutable std::mutex mutex_;
+    bool reject_goals_;
+    bool succeed_goals_;
+    std::size_t finished_goals_;
+    std::size_t canceled_goals_;
+    std::vector<PendingGoal> goals_;
+    typename rclcpp_action::Server<ActionT>::SharedPtr server_;
+    rclcpp::TimerBase::SharedPtr timer_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_FAKE_ACTION_SERVER_HPP */
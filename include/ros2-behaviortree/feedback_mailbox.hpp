@@ -0,0 +1,77 @@
+#ifndef ROS2_BEHAVIORTREE_FEEDBACK_MAILBOX_HPP
+#define ROS2_BEHAVIORTREE_FEEDBACK_MAILBOX_HPP
+
+// STL
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace bt_ros
+{
+  /**
+   * Latest-value mailbox with one slot per condition.
+   *
+   * Every slot is a single 64 bit atomic word holding a sequence number in the
+   * upper 63 bits and the condition value in the lowest bit, so a reader always
+   * observes a value together with the sequence that produced it (no tearing,
+   * no mutex). Writers may run concurrently on any executor thread, readers on
+   * the tick thread. Sequence 0 means the slot has never been written.
+   */
+  template <std::size_t N>
+  class FeedbackMailbox
+  {
+  public:
+    struct Sample
+    {
+      std::uint64_t sequence;
+      bool value;
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+        "FeedbackMailbox requires lock-free 64 bit atomics");
+
+    static constexpr std::size_t size() noexcept { return N; }
+
+    // Publish a new value, bumping the slot sequence
+    void write(std::size_t slot, bool value) noexcept
+    {
+      auto& word = slots_[slot].word;
+      auto current = word.load(std::memory_order_relaxed);
+      std::uint64_t next;
+      do
+      {
+        next = (((current >> 1) + 1) << 1) | static_cast<std::uint64_t>(value);
+      } while (!word.compare_exchange_weak(current, next,
+            std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Read the latest value of a slot, O(1) and wait-free
+    Sample read(std::size_t slot) const noexcept
+    {
+      const auto word = slots_[slot].word.load(std::memory_order_acquire);
+      return {word >> 1, (word & 1u) != 0};
+    }
+
+    // Snapshot every slot, each one individually consistent
+    std::array<Sample, N> readAll() const noexcept
+    {
+      std::array<Sample, N> samples;
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        samples[i] = read(i);
+      }
+      return samples;
+    }
+
+  private:
+    // One cache line per slot so writers on different cores do not false share
+    struct alignas(64) Slot
+    {
+      std::atomic<std::uint64_t> word{0};
+    };
+
+    std::array<Slot, N> slots_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_FEEDBACK_MAILBOX_HPP */
@@ -0,0 +1,102 @@
+#ifndef ROS2_BEHAVIORTREE_HOT_RELOADER_HPP
+#define ROS2_BEHAVIORTREE_HOT_RELOADER_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "ros2-behaviortree/tree_cache.hpp"
+#include "ros2-behaviortree/tree_directory_loader.hpp"
+
+namespace bt_ros
+{
+  // Outcome of the last applyPendingChanges() that found changes
+  struct TreeReload
+  {
+    // IDs of the BehaviorTrees defined, before or after, in the files that changed
+    std::vector<std::string> changed_trees;
+    // The running tree used one of them and was replaced
+    bool swapped {false};
+    // SubTree instances whose nodes were kept as they were
+    std::size_t reused_subtrees {0};
+    // Reload of the directory plus rebuild of the tree
+    std::chrono::nanoseconds duration {0};
+    // Empty on success, otherwise the running tree was left untouched
+    std::string error;
+  };
+
+  /**
+   * Keeps a tree in sync with the XML files of a directory, without restarting.
+   *
+   * An inotify watcher thread flags the *.xml files written, moved or deleted
+   * in the directory. The tree is only touched by applyPendingChanges(),
+   * called by the thread ticking the tree between two ticks: once the files
+   * were quiet for settle_time, the directory is reloaded (only the changed
+   * files are parsed) and, if the running tree uses one of the BehaviorTree
+   * IDs they define, it is rebuilt by TreeLibrary::rebuildTree(): the
+   * blackboards are kept and the SubTree instances that did not change keep
+   * their node instances (ROS clients, subscriptions, ...), running actions
+   * included. The nodes of the previous tree that were not reused are halted,
+   * then the tree is replaced in place, so tree() references stay valid.
+   *
+   * A reload that fails (invalid XML, unknown node, ...) leaves the running
+   * tree untouched; its changes are retried with the next ones.
+   */
+  class TreeHotReloader
+  {
+  public:
+    // Loads the directory and creates main_tree_ID, throws BT::RuntimeError on error
+    TreeHotReloader(const BT::BehaviorTreeFactory& factory,
+        std::string directory,
+        std::string cache_directory,
+        std::string main_tree_ID,
+        std::chrono::milliseconds settle_time = std::chrono::milliseconds{100},
+        BT::Blackboard::Ptr blackboard = BT::Blackboard::create());
+    ~TreeHotReloader();
+
+    TreeHotReloader(const TreeHotReloader&) = delete;
+    TreeHotReloader& operator=(const TreeHotReloader&) = delete;
+
+    BT::Tree& tree();
+
+    // Files changed since the last reload
+    bool changesPending() const;
+
+    // Tick boundary: reload if changes are pending and settled, true if it did, see lastReload()
+    bool applyPendingChanges();
+
+    const TreeReload& lastReload() const;
+
+  private:
+    void watch();
+
+    const BT::BehaviorTreeFactory& factory_;
+    std::string directory_;
+    std::string main_tree_ID_;
+    std::chrono::milliseconds settle_time_;
+    TreeDirectoryLoader loader_;
+    std::optional<TreeLibrary> library_;
+    BT::Tree tree_;
+    // Changed IDs of reloads that could not be applied yet
+    std::unordered_set<std::string> unapplied_;
+    TreeReload last_reload_;
+
+    int inotify_fd_;
+    int stop_fd_;
+    std::atomic<bool> pending_;
+    // steady_clock time of the last file event, in nanoseconds
+    std::atomic<std::int64_t> last_event_;
+    std::jthread watcher_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_HOT_RELOADER_HPP */
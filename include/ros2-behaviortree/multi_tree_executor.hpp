@@ -0,0 +1,130 @@
+#ifndef ROS2_BEHAVIORTREE_MULTI_TREE_EXECUTOR_HPP
+#define ROS2_BEHAVIORTREE_MULTI_TREE_EXECUTOR_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ros2-behaviortree/deadline_service.hpp"
+#include "ros2-behaviortree/timer_wheel.hpp"
+
+namespace bt_ros
+{
+  /**
+   * Ticks many independent trees, each at its own rate, on a few worker threads.
+   *
+   * A tree is pinned to one worker for its whole life, so its nodes are only
+   * ever ticked from that thread. Every worker keeps the tick slots of its
+   * trees on a timer wheel, with absolute deadlines like TickEngine: an
+   * overrun drops the missed slots instead of ticking them back to back.
+   * A tree is dropped once it returns SUCCESS or FAILURE.
+   *
+   * A tree still RUNNING after a tick that changed no node status is only
+   * waiting on asynchronous nodes: it is parked, and ticked again when one
+   * of its nodes changes status from another thread, when one of its nodes
+   * emits the wake up signal (a deadline of the worker, an action result,
+   * ...), when wake() is called, or at the latest after idle_period. Set
+   * idle_period to the period to always tick it. The wake up signal is only
+   * seen by the tree: while trees are parked the worker polls theirs every
+   * wake_poll_period.
+   *
+   * Each worker has its own DeadlineService, fired between ticks. Nodes of a
+   * tree pinned to a worker arm their DeadlineTimer on deadlines(worker).
+   */
+  class MultiTreeExecutor
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using TreeId = std::uint64_t;
+    // Called on the worker thread once the tree completed, must not throw
+    using DoneCallback = std::function<void(TreeId, BT::NodeStatus)>;
+
+    struct TreeOptions
+    {
+      std::chrono::nanoseconds period {std::chrono::milliseconds(100)};
+      // Longest wait of a parked tree before it is ticked again anyway
+      std::chrono::nanoseconds idle_period {std::chrono::seconds(1)};
+      // Worker the tree is pinned to, -1 for the one hosting the fewest trees
+      int worker {-1};
+      DoneCallback on_done;
+    };
+
+    struct Stats
+    {
+      std::uint64_t ticks {0};
+      // Ticks that were still running when the next slot of the tree was due
+      std::uint64_t overruns {0};
+      // Slots dropped to get back in phase after an overrun
+      std::uint64_t skipped {0};
+      // Times a tree was parked, and ticks of parked trees woken up early
+      std::uint64_t parked {0};
+      std::uint64_t wake_ups {0};
+      // Trees that returned SUCCESS or FAILURE, or threw
+      std::uint64_t completed {0};
+    };
+
+    explicit MultiTreeExecutor(std::size_t worker_count = std::thread::hardware_concurrency(),
+        std::chrono::nanoseconds wake_poll_period = std::chrono::milliseconds(1));
+    // Halts the trees still running
+    ~MultiTreeExecutor();
+
+    MultiTreeExecutor(const MultiTreeExecutor&) = delete;
+    MultiTreeExecutor& operator=(const MultiTreeExecutor&) = delete;
+
+    std::size_t workerCount() const { return workers_.size(); }
+
+    // Worker hosting the fewest trees, where add() pins a tree by default
+    std::size_t leastLoadedWorker() const;
+
+    // Deadlines of the nodes of the trees pinned to worker, only used from that worker
+    DeadlineService& deadlines(std::size_t worker);
+
+    // Host the tree, first ticked right away. Safe from any thread, the
+    // nodes must not be ticked from anywhere else from now on.
+    TreeId add(BT::Tree tree, TreeOptions options);
+    TreeId add(BT::Tree tree);
+
+    // Tick the tree as soon as possible, e.g. from the ROS callback feeding one
+    // of its nodes. Safe from any thread, ignored once the tree completed.
+    void wake(TreeId id);
+
+    // Trees added and not completed yet
+    std::size_t pending() const;
+
+    // Block until every tree added so far completed
+    void waitAll();
+
+    // Summed over the workers, safe from any thread
+    Stats stats() const;
+
+  private:
+    struct Waker;
+    struct Hosted;
+    struct Worker;
+
+    void run(Worker& worker, std::stop_token stop);
+    void tick(Worker& worker, Hosted& hosted, bool on_schedule);
+    void complete(Worker& worker, Hosted& hosted, BT::NodeStatus status);
+    void wake(Worker& worker, TreeId id);
+
+    std::chrono::nanoseconds wake_poll_period_;
+    std::atomic<TreeId> next_sequence_;
+    mutable std::mutex pending_mutex_;
+    std::condition_variable all_done_;
+    std::size_t pending_;
+    // Last member, the workers stop before the rest goes away
+    std::vector<std::unique_ptr<Worker>> workers_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_MULTI_TREE_EXECUTOR_HPP */
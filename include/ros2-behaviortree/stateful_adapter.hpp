@@ -0,0 +1,87 @@
+#ifndef ROS2_BEHAVIORTREE_STATEFUL_ADAPTER_HPP
+#define ROS2_BEHAVIORTREE_STATEFUL_ADAPTER_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <concepts>
+#include <string>
+#include <utility>
+
+namespace bt_ros
+{
+  /**
+   * A plain class usable as the body of a StatefulActionNode: onStart()
+   * gets the node (for its ports, wake up signal, name...) and both
+   * onStart() and onRunning() return the status of the node.
+   */
+  template <typename Impl>
+  concept StatefulBehavior = requires(Impl& impl, BT::StatefulActionNode& node)
+  {
+    { impl.onStart(node) } -> std::convertible_to<BT::NodeStatus>;
+    { impl.onRunning() } -> std::convertible_to<BT::NodeStatus>;
+    { impl.onHalted() } -> std::same_as<void>;
+  };
+
+  template <typename Impl>
+  concept HasProvidedPorts = requires
+  {
+    { Impl::providedPorts() } -> std::convertible_to<BT::PortsList>;
+  };
+
+  /**
+   * StatefulActionNode forwarding to a StatefulBehavior it owns.
+   *
+   * The calls are plain member calls on Impl, resolved at compile time:
+   * no std::function in between and nothing added to the tick path. Extra
+   * arguments given to registerNodeType() construct Impl, and its static
+   * providedPorts(), if any, are the ports of the node.
+   *
+   *   factory.registerNodeType<bt_ros::StatefulAdapter<MoveBase>>("MoveBase", std::ref(deadlines));
+   */
+  template <StatefulBehavior Impl>
+  class StatefulAdapter : public BT::StatefulActionNode
+  {
+  public:
+    template <typename... Args>
+    StatefulAdapter(const std::string& name, const BT::NodeConfig& config, Args&&... args)
+      : BT::StatefulActionNode(name, config)
+      , impl_(std::forward<Args>(args)...)
+    {}
+
+    static BT::PortsList providedPorts()
+    {
+      if constexpr (HasProvidedPorts<Impl>)
+      {
+        return Impl::providedPorts();
+      }
+      else
+      {
+        return {};
+      }
+    }
+
+    BT::NodeStatus onStart() override
+    {
+      return impl_.onStart(static_cast<BT::StatefulActionNode&>(*this));
+    }
+
+    BT::NodeStatus onRunning() override
+    {
+      return impl_.onRunning();
+    }
+
+    void onHalted() override
+    {
+      impl_.onHalted();
+    }
+
+    Impl& impl() { return impl_; }
+    const Impl& impl() const { return impl_; }
+
+  private:
+    Impl impl_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_STATEFUL_ADAPTER_HPP */
@@ -0,0 +1,60 @@
+#ifndef ROS2_BEHAVIORTREE_THREAD_POOL_PARALLEL_NODE_HPP
+#define ROS2_BEHAVIORTREE_THREAD_POOL_PARALLEL_NODE_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ros2-behaviortree/work_stealing_pool.hpp"
+
+namespace bt_ros
+{
+  /**
+   * Parallel node ticking its synchronous children on a WorkStealingPool.
+   *
+   * Same ports and thresholds as BT::ParallelNode: SUCCESS once
+   * `success_count` children succeeded (-1: all of them), FAILURE once
+   * `failure_count` failed or success is out of reach, RUNNING otherwise;
+   * completed children are not ticked again until the node completes or is
+   * halted, and halt() halts every child.
+   *
+   * Every tick, the other children (asynchronous actions, controls,
+   * subtrees) are ticked first, in order, on the tick thread; then the
+   * pending SyncActionNode children all tick at the same time on the pool,
+   * the tick thread helping, and the node waits for the last one. Those
+   * children must therefore be safe to tick concurrently: ports and the
+   * blackboard are, shared state of the nodes themselves must be too.
+   *
+   *   factory.registerNodeType<bt_ros::ThreadPoolParallelNode>("ThreadPoolParallel");
+   *   factory.registerNodeType<bt_ros::ThreadPoolParallelNode>("ThreadPoolParallel", std::ref(pool));
+   */
+  class ThreadPoolParallelNode : public BT::ControlNode
+  {
+  public:
+    // On WorkStealingPool::shared()
+    ThreadPoolParallelNode(const std::string& name, const BT::NodeConfig& config);
+    ThreadPoolParallelNode(const std::string& name, const BT::NodeConfig& config, WorkStealingPool& pool);
+
+    static BT::PortsList providedPorts();
+
+    void halt() override;
+
+  private:
+    BT::NodeStatus tick() override;
+    void clear();
+
+    WorkStealingPool& pool_;
+    std::vector<bool> completed_;
+    // Indexes of the synchronous children ticked on the pool this tick, and what they returned
+    std::vector<std::size_t> pooled_;
+    std::vector<BT::NodeStatus> pooled_status_;
+    std::size_t success_count_;
+    std::size_t failure_count_;
+    std::size_t skipped_count_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_THREAD_POOL_PARALLEL_NODE_HPP */
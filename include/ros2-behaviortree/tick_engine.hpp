@@ -0,0 +1,103 @@
+#ifndef ROS2_BEHAVIORTREE_TICK_ENGINE_HPP
+#define ROS2_BEHAVIORTREE_TICK_ENGINE_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+#include "ros2-behaviortree/deadline_service.hpp"
+
+namespace bt_ros
+{
+  struct TickStats
+  {
+    std::uint64_t ticks {0};
+    // Ticks that were still running when the next slot was due
+    std::uint64_t overruns {0};
+    // Schedule slots dropped to get back in phase after an overrun
+    std::uint64_t skipped {0};
+    // Delay between the scheduled slot and the actual start of the tick
+    std::chrono::nanoseconds max_jitter {0};
+    std::chrono::nanoseconds total_jitter {0};
+    // Time spent inside tickOnce()
+    std::chrono::nanoseconds max_tick_time {0};
+    std::chrono::nanoseconds total_tick_time {0};
+    // Delay between an event arrival and the start of the tick that handled it
+    std::uint64_t wake_ups {0};
+    std::chrono::nanoseconds max_wake_latency {0};
+    std::chrono::nanoseconds total_wake_latency {0};
+
+    std::chrono::nanoseconds meanJitter() const
+    {
+      return ticks ? total_jitter / static_cast<std::int64_t>(ticks) : std::chrono::nanoseconds{0};
+    }
+
+    std::chrono::nanoseconds meanTickTime() const
+    {
+      return ticks ? total_tick_time / static_cast<std::int64_t>(ticks) : std::chrono::nanoseconds{0};
+    }
+
+    std::chrono::nanoseconds meanWakeLatency() const
+    {
+      return wake_ups ? total_wake_latency / static_cast<std::int64_t>(wake_ups) : std::chrono::nanoseconds{0};
+    }
+  };
+
+  /**
+   * Ticks a tree on a fixed-rate schedule.
+   *
+   * Deadlines are absolute (start + n * period) so the loop does not drift
+   * however long each tick takes. When a tick overruns, the next tick starts
+   * immediately and any further slots that were missed are dropped instead of
+   * being ticked back to back.
+   *
+   * With an event probe set, the tree wake up signal interrupts the sleep and
+   * the tree is ticked right away, outside of the schedule. The probe returns
+   * the arrival time of the event, if any, to measure the reaction delay.
+   * With a deadline service set, expired deadlines are fired between slots
+   * and their nodes are ticked right away as well.
+   */
+  class TickEngine
+  {
+  public:
+    using EventProbe = std::function<std::optional<std::chrono::steady_clock::time_point>()>;
+
+    TickEngine(BT::Tree& tree, std::chrono::nanoseconds period);
+
+    // Tick on wake up signals too, probe is called right before every tick
+    void setEventProbe(EventProbe probe) { probe_ = std::move(probe); }
+
+    // Fire the deadlines of the tree nodes, the service must outlive run()
+    void setDeadlineService(DeadlineService* deadlines) { deadlines_ = deadlines; }
+
+    // Tick until the tree returns SUCCESS/FAILURE, keep_running() returns false
+    // or stop() is called. Returns the last status of the tree.
+    BT::NodeStatus run(const std::function<bool()>& keep_running = nullptr);
+
+    // Ask run() to return after the current tick, safe from any thread
+    void stop() { stop_requested_ = true; }
+
+    const TickStats& stats() const { return stats_; }
+    std::chrono::nanoseconds period() const { return period_; }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    // Returns true when woken up by an event before the deadline
+    bool sleepUntil(Clock::time_point deadline);
+
+    BT::Tree& tree_;
+    std::chrono::nanoseconds period_;
+    EventProbe probe_;
+    DeadlineService* deadlines_;
+    std::atomic<bool> stop_requested_;
+    TickStats stats_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_TICK_ENGINE_HPP */
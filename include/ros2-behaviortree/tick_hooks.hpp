@@ -0,0 +1,80 @@
+#ifndef ROS2_BEHAVIORTREE_TICK_HOOKS_HPP
+#define ROS2_BEHAVIORTREE_TICK_HOOKS_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <chrono>
+#include <vector>
+
+namespace bt_ros
+{
+  // Told when the tick of a node starts and ends, on the thread ticking the node
+  class TickListener
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~TickListener() = default;
+
+    virtual void onTickStart(const BT::TreeNode& node, Clock::time_point time) = 0;
+    virtual void onTickEnd(const BT::TreeNode& node, BT::NodeStatus status, Clock::time_point time) = 0;
+  };
+
+  /**
+   * Shares the tick callbacks of every node of a tree between several
+   * TickListener.
+   *
+   * With BT.CPP versions providing TreeNode::setTickMonitorCallback, the
+   * hooks are built on it and leave the pre/post tick functions alone, those
+   * of Groot2Publisher (breakpoints, interactive hooks) or of the user. The
+   * monitor reports a node once its tick() returned, with a duration
+   * truncated to whole microseconds: both events of a node are delivered
+   * then, the start being the end minus that duration. Durations have a
+   * microsecond resolution, and the start of a node may come after the start
+   * of its first child. The status of a control node or decorator already
+   * changed to RUNNING when its events are delivered. The hooks own the
+   * monitor callback of the nodes until destroyed.
+   *
+   * Older versions fall back on the pre/post tick functions, whose single
+   * slot the hooks then own exclusively: they replace whatever was set,
+   * clear it when destroyed, and must not be combined with a
+   * Groot2Publisher, which installs its own.
+   *
+   * Either way the clock is read once per event, whatever the number of
+   * listeners. The time between the two events of a node is its tick()
+   * alone: onStart() or onRunning() for a stateful action, the tick of the
+   * children included for a control node. With the fallback, a tick
+   * replaced by a precondition only ends.
+   *
+   * Listeners are added and removed while the tree is not ticking. The
+   * hooks must not outlive the tree.
+   */
+  class TickHooks
+  {
+  public:
+    explicit TickHooks(const BT::Tree& tree);
+    ~TickHooks();
+
+    TickHooks(const TickHooks&) = delete;
+    TickHooks& operator=(const TickHooks&) = delete;
+
+    void addListener(TickListener* listener);
+    void removeListener(TickListener* listener);
+
+    // Every node of the tree, in the order of Tree::subtrees
+    const std::vector<BT::TreeNode*>& nodes() const { return nodes_; }
+
+    // True when built on the tick monitor, false when owning the pre/post tick functions
+    static bool usesTickMonitor();
+
+  private:
+    void tickStarted(const BT::TreeNode& node, TickListener::Clock::time_point time);
+    void tickEnded(const BT::TreeNode& node, BT::NodeStatus status, TickListener::Clock::time_point time);
+
+    std::vector<BT::TreeNode*> nodes_;
+    std::vector<TickListener*> listeners_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_TICK_HOOKS_HPP */
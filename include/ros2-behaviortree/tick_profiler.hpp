@@ -0,0 +1,159 @@
+#ifndef ROS2_BEHAVIORTREE_TICK_PROFILER_HPP
+#define ROS2_BEHAVIORTREE_TICK_PROFILER_HPP
+
+// ROS2
+#include <rclcpp/rclcpp.hpp>
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+
+// STL
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ros2-behaviortree/tick_hooks.hpp"
+
+namespace bt_ros
+{
+  /**
+   * HDR-style histogram of durations.
+   *
+   * Buckets are exact below 64 ns, then split each power of two into 32:
+   * any value is known within 1/32 (~3%), up to ~68 s (longer durations
+   * land in the last bucket). Recording is a shift and an increment, with
+   * one writer thread; snapshots may be taken by any thread.
+   */
+  class LatencyHistogram
+  {
+  public:
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr std::uint64_t SUB_BUCKET_COUNT = std::uint64_t{1} << SUB_BUCKET_BITS;
+    static constexpr std::uint64_t MAX_VALUE = (std::uint64_t{1} << 36) - 1;
+    static constexpr std::size_t BUCKET_COUNT = 1024;
+
+    // Counts at one point in time, they wrap around after 2^32 values per bucket
+    struct Snapshot
+    {
+      std::array<std::uint32_t, BUCKET_COUNT> counts {};
+      std::uint64_t count = 0;
+
+      // Upper bound of the bucket holding the q-th quantile, zero when empty
+      std::chrono::nanoseconds percentile(double q) const;
+      std::chrono::nanoseconds max() const;
+      // Values recorded between `earlier` and this snapshot
+      Snapshot since(const Snapshot& earlier) const;
+    };
+
+    static constexpr std::size_t bucketOf(std::uint64_t value) noexcept
+    {
+      value = value < MAX_VALUE ? value : MAX_VALUE;
+      const auto width = static_cast<unsigned>(std::bit_width(value));
+      const auto shift = width > SUB_BUCKET_BITS + 1 ? width - SUB_BUCKET_BITS - 1 : 0;
+      return static_cast<std::size_t>(shift * SUB_BUCKET_COUNT + (value >> shift));
+    }
+
+    static std::uint64_t bucketUpperBound(std::size_t bucket) noexcept;
+
+    void record(std::chrono::nanoseconds value) noexcept
+    {
+      auto& count = counts_[bucketOf(static_cast<std::uint64_t>(value.count() > 0 ? value.count() : 0))];
+      // Single writer: no read-modify-write needed
+      count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const;
+
+  private:
+    std::array<std::atomic<std::uint32_t>, BUCKET_COUNT> counts_ {};
+  };
+  static_assert(LatencyHistogram::BUCKET_COUNT == LatencyHistogram::bucketOf(LatencyHistogram::MAX_VALUE) + 1);
+
+  /**
+   * Tick latency of every node of a tree, as histograms.
+   *
+   * Ticks following a RUNNING result of the node (onRunning() of a stateful
+   * action, a control node resuming its children) are kept apart from the
+   * others (tick() from IDLE or after a result, onStart()). The status each
+   * node returned is tracked, and forgotten when the node is reset to IDLE.
+   * collect() summarizes what was recorded since its previous call and may
+   * run on any thread, one at a time, while the tree ticks.
+   *
+   * Durations are those of TickHooks: with the tick monitor they come in
+   * whole microseconds, a tick shorter than 1 us records 0 and the ~3%
+   * precision of the histogram only holds from ~32 us on.
+   */
+  class TickProfiler : public TickListener
+  {
+  public:
+    struct Latency
+    {
+      std::uint64_t count = 0;
+      std::chrono::nanoseconds p50 {0};
+      std::chrono::nanoseconds p99 {0};
+      std::chrono::nanoseconds max {0};
+    };
+
+    struct NodeLatency
+    {
+      std::uint16_t uid;
+      std::string path;
+      std::string registration_name;
+      Latency start;
+      Latency running;
+    };
+
+    explicit TickProfiler(TickHooks& hooks);
+    ~TickProfiler();
+
+    TickProfiler(const TickProfiler&) = delete;
+    TickProfiler& operator=(const TickProfiler&) = delete;
+
+    // Nodes ticked since the previous call, in UID order
+    std::vector<NodeLatency> collect();
+
+    void onTickStart(const BT::TreeNode& node, Clock::time_point time) override;
+    void onTickEnd(const BT::TreeNode& node, BT::NodeStatus status, Clock::time_point time) override;
+
+  private:
+    struct NodeState
+    {
+      const BT::TreeNode* node = nullptr;
+      Clock::time_point tick_start;
+      bool ticking = false;
+      bool from_running = false;
+      // Returned by the previous tick, IDLE once the node was reset
+      std::atomic<BT::NodeStatus> last_status {BT::NodeStatus::IDLE};
+      BT::TreeNode::StatusChangeSubscriber reset_subscriber;
+      LatencyHistogram start;
+      LatencyHistogram running;
+      LatencyHistogram::Snapshot collected_start;
+      LatencyHistogram::Snapshot collected_running;
+    };
+
+    TickHooks& hooks_;
+    // Indexed by UID
+    std::vector<std::unique_ptr<NodeState>> states_;
+  };
+
+  // Publishes TickProfiler::collect() periodically, one DiagnosticStatus per ticked node
+  class TickProfilePublisher
+  {
+  public:
+    TickProfilePublisher(rclcpp::Node& node, TickProfiler& profiler, std::chrono::nanoseconds period,
+        const std::string& topic = "bt/tick_latency");
+
+  private:
+    void publish();
+
+    TickProfiler& profiler_;
+    rclcpp::Clock::SharedPtr clock_;
+    rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr publisher_;
+    rclcpp::TimerBase::SharedPtr timer_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_TICK_PROFILER_HPP */
@@ -0,0 +1,93 @@
+#ifndef ROS2_BEHAVIORTREE_TIMER_WHEEL_HPP
+#define ROS2_BEHAVIORTREE_TIMER_WHEEL_HPP
+
+// STL
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace bt_ros
+{
+  /**
+   * Hierarchical timing wheel (4 levels of 64 slots).
+   *
+   * Scheduling and cancelling are O(1), advancing costs O(1) per elapsed tick
+   * plus the timers fired or cascaded. Deadlines are rounded up to the wheel
+   * resolution so a timer never fires early. Deadlines further than 64^4 ticks
+   * away are clamped and fire at the end of the wheel horizon.
+   *
+   * Not thread safe: schedule, cancel and advance from the same thread, which
+   * for behavior trees is the tick thread.
+   */
+  class TimerWheel
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+
+    struct Handle
+    {
+      std::uint32_t index {0};
+      // 0 is never a valid generation, a default Handle refers to nothing
+      std::uint32_t generation {0};
+    };
+
+    explicit TimerWheel(std::chrono::nanoseconds resolution = std::chrono::milliseconds(1),
+        Clock::time_point start = Clock::now());
+
+    Handle schedule(Clock::time_point deadline, Callback callback);
+    // Returns false if the timer already fired or was cancelled
+    bool cancel(Handle handle);
+    // Fire every timer due at or before now, returns how many fired
+    std::size_t advance(Clock::time_point now);
+
+    // Lower bound of the next expiry, nullopt when empty. It can be earlier
+    // than the real deadline when timers still have to cascade down.
+    std::optional<Clock::time_point> nextExpiry() const;
+
+    std::size_t size() const { return size_; }
+    std::chrono::nanoseconds resolution() const { return resolution_; }
+
+  private:
+    static constexpr unsigned LEVELS = 4;
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr unsigned SLOTS = 1u << SLOT_BITS;
+    static constexpr std::uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr std::uint32_t NIL = UINT32_MAX;
+    // Extra list past the slots, holding the timers of the tick being fired
+    static constexpr std::uint16_t FIRING = LEVELS * SLOTS;
+
+    struct Entry
+    {
+      Callback callback;
+      std::uint64_t expiry {0};
+      std::uint32_t prev {NIL};
+      std::uint32_t next {NIL};
+      std::uint32_t generation {1};
+      std::uint16_t slot {0};
+      bool active {false};
+    };
+
+    std::uint64_t toTick(Clock::time_point time) const;
+    std::optional<std::uint64_t> nextEventTick() const;
+    void insert(std::uint32_t index, std::uint64_t base);
+    void unlink(std::uint32_t index);
+    void cascade(unsigned level, unsigned slot, std::uint64_t tick);
+    // Returns how many timers fired
+    std::size_t processTick(std::uint64_t tick);
+
+    std::chrono::nanoseconds resolution_;
+    Clock::time_point start_;
+    // Last processed tick
+    std::uint64_t current_;
+    std::size_t size_;
+    std::vector<Entry> entries_;
+    std::vector<std::uint32_t> free_;
+    std::array<std::uint32_t, LEVELS * SLOTS + 1> heads_;
+    std::array<std::uint64_t, LEVELS> occupied_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_TIMER_WHEEL_HPP */
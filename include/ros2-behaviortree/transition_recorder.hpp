@@ -0,0 +1,109 @@
+#ifndef ROS2_BEHAVIORTREE_TRANSITION_RECORDER_HPP
+#define ROS2_BEHAVIORTREE_TRANSITION_RECORDER_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bt_ros
+{
+  // One status change of one node, as stored in a recording
+  struct TransitionRecord
+  {
+    // steady_clock, comparable with TransitionRecording::startSteadyTime()
+    std::uint64_t timestamp_ns;
+    // Low bits of the index of the record, tells a slot not written yet (or torn by a crash) apart
+    std::uint32_t sequence;
+    std::uint16_t uid;
+    std::uint8_t previous_status;
+    std::uint8_t status;
+  };
+  static_assert(16 == sizeof(TransitionRecord));
+
+  /**
+   * Records every status transition of the nodes of a tree into a
+   * memory-mapped ring file, for post-mortem analysis with bt_replay.
+   *
+   * The file starts with a header and the UID, path and registration name of
+   * every node, followed by a ring of fixed-size TransitionRecord. Recording
+   * a transition is one steady_clock read, one atomic increment and one
+   * 16-byte store into a shared mapping: no syscall, no allocation, no lock.
+   * The pages belong to the file, so the kernel writes them back even when
+   * the process crashes. Once the ring is full the oldest records are
+   * overwritten.
+   *
+   * The recorder must not outlive the tree.
+   */
+  class TransitionRecorder
+  {
+  public:
+    // capacity is rounded up to a power of two, throws BT::RuntimeError on I/O error
+    TransitionRecorder(const BT::Tree& tree, const std::string& path, std::size_t capacity = 1 << 20);
+    ~TransitionRecorder();
+
+    TransitionRecorder(const TransitionRecorder&) = delete;
+    TransitionRecorder& operator=(const TransitionRecorder&) = delete;
+
+    // Ask the kernel to write the pages now, they are written back anyway
+    void sync();
+
+    // Transitions recorded so far, overwritten ones included
+    std::uint64_t recorded() const;
+
+  private:
+    void record(const BT::TreeNode& node, BT::NodeStatus previous, BT::NodeStatus status) noexcept;
+
+    void* mapping_;
+    std::size_t mapping_size_;
+    std::uint64_t* next_;
+    TransitionRecord* records_;
+    std::uint64_t mask_;
+    std::vector<BT::TreeNode::StatusChangeSubscriber> subscribers_;
+  };
+
+  // A recording opened for reading, while it is being written or after a crash
+  class TransitionRecording
+  {
+  public:
+    struct Node
+    {
+      std::uint16_t uid;
+      std::string path;
+      std::string registration_name;
+    };
+
+    // Throws BT::RuntimeError on unreadable or invalid files
+    explicit TransitionRecording(const std::string& path);
+
+    const std::vector<Node>& nodes() const;
+    // nullptr for an unknown UID
+    const Node* node(std::uint16_t uid) const;
+
+    // Records still in the ring, oldest first
+    const std::vector<TransitionRecord>& transitions() const;
+
+    // Transitions recorded in total, and the ones no longer in the ring
+    std::uint64_t recorded() const;
+    std::uint64_t overwritten() const;
+
+    // When the recorder was created, on both clocks
+    std::uint64_t startSteadyTime() const;
+    std::chrono::system_clock::time_point startSystemTime() const;
+
+  private:
+    std::vector<Node> nodes_;
+    std::unordered_map<std::uint16_t, std::size_t> node_index_;
+    std::vector<TransitionRecord> transitions_;
+    std::uint64_t recorded_;
+    std::uint64_t start_steady_ns_;
+    std::int64_t start_system_ns_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_TRANSITION_RECORDER_HPP */
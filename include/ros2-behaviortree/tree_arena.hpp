@@ -0,0 +1,93 @@
+#ifndef ROS2_BEHAVIORTREE_TREE_ARENA_HPP
+#define ROS2_BEHAVIORTREE_TREE_ARENA_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace bt_ros
+{
+  /**
+   * Monotonic memory for the nodes of one tree.
+   *
+   * Allocations bump a pointer into blocks obtained from the heap, nothing is
+   * freed before the arena itself: the nodes of a tree built in an arena sit
+   * next to each other in memory, in construction (depth first) order, and
+   * are released in one step. Not thread-safe, an arena is filled by the
+   * thread building its tree.
+   */
+  class TreeArena
+  {
+  public:
+    explicit TreeArena(std::size_t initial_size = 64 * 1024);
+
+    TreeArena(const TreeArena&) = delete;
+    TreeArena& operator=(const TreeArena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment);
+
+    // Bytes handed out so far
+    std::size_t bytesUsed() const { return used_; }
+
+  private:
+    std::pmr::monotonic_buffer_resource resource_;
+    std::size_t used_;
+  };
+
+  // Makes `arena` the one ArenaAllocated objects of this thread are created in, until destroyed
+  class ArenaScope
+  {
+  public:
+    explicit ArenaScope(TreeArena& arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+  private:
+    TreeArena* previous_;
+  };
+
+  /**
+   * Base for node types that may live in a TreeArena.
+   *
+   *   class SaySomething : public BT::SyncActionNode, public bt_ros::ArenaAllocated
+   *
+   * The class-specific operator new takes the memory from the arena of the
+   * current ArenaScope, or from the heap outside of any scope; operator
+   * delete only gives heap memory back. BT.CPP allocates its own objects
+   * (port maps, blackboard entries) with the global allocator, those stay on
+   * the heap.
+   */
+  struct ArenaAllocated
+  {
+    static void* operator new(std::size_t size);
+    static void* operator new(std::size_t size, std::align_val_t alignment);
+    static void operator delete(void* ptr, std::size_t size) noexcept;
+    static void operator delete(void* ptr, std::size_t size, std::align_val_t alignment) noexcept;
+  };
+
+  // A tree and the arena of its nodes, the tree is destroyed first
+  struct ArenaTree
+  {
+    std::unique_ptr<TreeArena> arena;
+    BT::Tree tree;
+  };
+
+  // Run build() (e.g. factory.createTree()) with a new arena active, the tree must not outlive it
+  template <typename BuildFn>
+  ArenaTree buildInArena(BuildFn&& build, std::size_t initial_size = 64 * 1024)
+  {
+    ArenaTree result{std::make_unique<TreeArena>(initial_size), {}};
+    ArenaScope scope{*result.arena};
+    result.tree = std::forward<BuildFn>(build)();
+    return result;
+  }
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_TREE_ARENA_HPP */
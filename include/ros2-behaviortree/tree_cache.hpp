@@ -0,0 +1,144 @@
+#ifndef ROS2_BEHAVIORTREE_TREE_CACHE_HPP
+#define ROS2_BEHAVIORTREE_TREE_CACHE_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace bt_ros
+{
+  /**
+   * Precompiled BehaviorTree definitions, loaded from XML or memory-mapped
+   * from a binary cache file.
+   *
+   * The cache holds the <BehaviorTree> elements of a set of XML files (and of
+   * the files they <include>) flattened into fixed-size records: tree IDs,
+   * node IDs, port remapping attributes, children and SubTree references all
+   * point into one string table. Mapping it costs a few validation passes over
+   * arrays of integers instead of an XML parse. Every source file is recorded
+   * with its modification time, size and a FNV-1a hash of its content: a file
+   * with the same time and size is not read again, otherwise the cache is
+   * stale as soon as its hash differs.
+   *
+   * Libraries compiled separately can be merged, SubTree references are then
+   * resolved across all of them.
+   *
+   * createTree() instantiates a tree through the factory builders the same way
+   * BehaviorTreeFactory::createTree() does from XML (same node types, paths,
+   * UIDs, port remapping and defaults, pre/post conditions and SubTree
+   * blackboards). XML using anything the cache does not model, such as
+   * <TreeNodesModel> or another BTCPP_format, is still recorded but its
+   * trees are built by BT::XMLParser from the source files: needsParser()
+   * tells, and rebuildTree() then reuses nothing.
+   */
+  class TreeLibrary
+  {
+  public:
+    // Parse the XML files and their includes, never touches a cache
+    static TreeLibrary fromXmlFiles(const std::vector<std::string>& xml_files);
+
+    // Map a cache file, nullopt if it is missing, corrupted or stale with respect to xml_files
+    static std::optional<TreeLibrary> mapCache(const std::string& cache_path,
+        const std::vector<std::string>& xml_files);
+
+    // Map the cache when it is up to date, otherwise parse the XML files and rewrite the cache
+    static TreeLibrary load(const std::vector<std::string>& xml_files, const std::string& cache_path);
+    static TreeLibrary load(const std::string& xml_file, const std::string& cache_path);
+
+    // One library with the trees of all the others, throws BT::RuntimeError on duplicated tree IDs
+    static TreeLibrary merge(const std::vector<TreeLibrary>& libraries);
+
+    // Write the library as a cache file (atomically replaced), false on I/O error or for a merged library
+    bool save(const std::string& cache_path) const;
+
+    // True if the library was mapped from cache files instead of parsed
+    bool fromCache() const;
+
+    // True if none of the source files changed since the library was built
+    bool upToDate() const;
+
+    // True if trees are built by BT::XMLParser instead of from the cached records
+    bool needsParser() const;
+
+    // Source files, the given XML files first then the included ones
+    std::vector<std::string> sourceFiles() const;
+
+    std::vector<std::string> treeIDs() const;
+    bool hasTree(std::string_view tree_ID) const;
+
+    // IDs used by <SubTree ID="..."/> nodes, each one once
+    std::vector<std::string> subTreeReferences() const;
+
+    // main_tree_to_execute of the XML, or the only tree of the library, empty otherwise
+    std::string mainTreeID() const;
+
+    // Build a tree, the main tree when tree_ID is empty, throws BT::RuntimeError on error
+    BT::Tree createTree(const BT::BehaviorTreeFactory& factory,
+        const std::string& tree_ID = {},
+        BT::Blackboard::Ptr blackboard = BT::Blackboard::create()) const;
+
+    /**
+     * Build a new version of `previous` after the definitions of changed_tree_IDs changed.
+     *
+     * The root blackboard is kept. A SubTree instance found at the same path,
+     * for the same tree ID and with the same port remapping as in `previous`
+     * keeps its blackboard; if none of the trees below it changed its node
+     * instances are moved into the new tree as they are, with new UIDs. The
+     * blackboard entries of other instances found at the same path are copied.
+     * The reused instances are then detached from `previous`, which keeps
+     * only the nodes that were not reused: halting it stops those without
+     * touching the running reused ones. It must stay alive until the new
+     * tree replaced it, and must not be ticked any more.
+     */
+    BT::Tree rebuildTree(const BT::BehaviorTreeFactory& factory,
+        BT::Tree& previous,
+        const std::unordered_set<std::string>& changed_tree_IDs,
+        const std::string& tree_ID = {},
+        std::size_t* reused_subtrees = nullptr) const;
+
+  private:
+    class Storage;
+
+    struct TreeLocation
+    {
+      std::size_t unit;
+      std::uint32_t index;
+    };
+
+    TreeLibrary() = default;
+    explicit TreeLibrary(std::shared_ptr<const Storage> storage);
+
+    // Index the trees of units_, throws on duplicated IDs
+    void indexTrees();
+
+    // createTree() and rebuildTree(), previous and changed_tree_IDs are null for the former
+    BT::Tree buildTree(const BT::BehaviorTreeFactory& factory,
+        const std::string& tree_ID,
+        BT::Blackboard::Ptr blackboard,
+        BT::Tree* previous,
+        const std::unordered_set<std::string>* changed_tree_IDs,
+        std::size_t* reused_subtrees) const;
+
+    // Fallback of buildTree() for the XML the cache does not model
+    BT::Tree parseTree(const BT::BehaviorTreeFactory& factory,
+        const std::string& tree_ID,
+        BT::Blackboard::Ptr blackboard) const;
+
+    // Point the nodes to the copy of the factory manifests the tree keeps
+    static void adoptManifests(const BT::BehaviorTreeFactory& factory, BT::Tree& tree);
+
+    std::vector<std::shared_ptr<const Storage>> units_;
+    std::unordered_map<std::string_view, TreeLocation> trees_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_TREE_CACHE_HPP */
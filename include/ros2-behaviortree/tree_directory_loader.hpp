@@ -0,0 +1,76 @@
+#ifndef ROS2_BEHAVIORTREE_TREE_DIRECTORY_LOADER_HPP
+#define ROS2_BEHAVIORTREE_TREE_DIRECTORY_LOADER_HPP
+
+// STL
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ros2-behaviortree/tree_cache.hpp"
+
+namespace bt_ros
+{
+  // How one file of a directory was loaded
+  struct TreeFileReport
+  {
+    enum class Origin
+    {
+      UNCHANGED,  // same library as the previous load(), not even mapped again
+      CACHE,      // mapped from its cache file
+      PARSED      // XML parsed, cache rewritten
+    };
+
+    std::string path;
+    Origin origin;
+    std::size_t tree_count;
+    std::chrono::nanoseconds load_time;
+  };
+
+  const char* toStr(TreeFileReport::Origin origin);
+
+  /**
+   * Loads every *.xml file of a directory into one TreeLibrary.
+   *
+   * Files are loaded in parallel by a pool of worker threads, each one with
+   * its own binary cache in cache_directory (no cache when it is empty). A
+   * file whose modification time and size did not change is neither read nor
+   * parsed. If they changed but the content hash did not, the file is still
+   * not parsed. The per-file libraries are then merged, so a <SubTree ID>
+   * may reference a tree of any file of the directory. A reference that no
+   * file defines is an error.
+   *
+   * Keeping the loader alive makes a later load() reuse the libraries of the
+   * unchanged files as they are.
+   */
+  class TreeDirectoryLoader
+  {
+  public:
+    // threads = 0 uses one thread per hardware thread
+    TreeDirectoryLoader(std::string directory, std::string cache_directory, std::size_t threads = 0);
+
+    // Throws BT::RuntimeError on unreadable or invalid files and unresolved SubTree references
+    TreeLibrary load();
+
+    // Files of the last load(), sorted by path
+    const std::vector<TreeFileReport>& report() const;
+
+    // Wall time of the last load()
+    std::chrono::nanoseconds loadTime() const;
+
+    // Library of each file of the last successful load(), by path
+    const std::map<std::string, TreeLibrary>& fileLibraries() const;
+
+  private:
+    std::string cachePath(const std::string& xml_file) const;
+
+    std::string directory_;
+    std::string cache_directory_;
+    std::size_t threads_;
+    std::map<std::string, TreeLibrary> loaded_;
+    std::vector<TreeFileReport> report_;
+    std::chrono::nanoseconds load_time_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_TREE_DIRECTORY_LOADER_HPP */
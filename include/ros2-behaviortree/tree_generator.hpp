@@ -0,0 +1,53 @@
+#ifndef ROS2_BEHAVIORTREE_TREE_GENERATOR_HPP
+#define ROS2_BEHAVIORTREE_TREE_GENERATOR_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <cstddef>
+#include <string>
+
+namespace bt_ros
+{
+  // Shape of a synthetic tree
+  struct TreeShape
+  {
+    // Levels of Sequence nodes, the leaves sit below the last one
+    std::size_t depth = 4;
+    // Children of every Sequence
+    std::size_t fan_out = 4;
+    // Every `subtree_every` levels the Sequence is moved into its own
+    // BehaviorTree, instantiated through <SubTree _autoremap="true">; 0 for none
+    std::size_t subtree_every = 2;
+    // Fraction of the leaves whose ports are remapped to blackboard entries,
+    // the others get literal values
+    double remap_density = 0.5;
+    // Blackboard entries shared by the remapped ports
+    std::size_t blackboard_keys = 16;
+  };
+
+  struct GeneratedTree
+  {
+    // BTCPP_format="4", main tree "MainTree"
+    std::string xml;
+    // Counts in the instantiated tree, each SubTree instance counted
+    std::size_t nodes = 0;
+    std::size_t leaves = 0;
+    std::size_t subtree_instances = 0;
+  };
+
+  /**
+   * XML of a complete tree of the given shape, the same for the same shape.
+   *
+   * Every leaf is a `Work` node (see registerGeneratedNodes()) returning
+   * SUCCESS, so one tick runs every node of the tree. A remapped leaf reads
+   * and writes blackboard entries, `<Work in="{key_3}" out="{key_4}"/>`,
+   * the others convert a literal, `<Work in="1"/>`.
+   */
+  GeneratedTree generateTree(const TreeShape& shape);
+
+  // Register the nodes used by generated trees
+  void registerGeneratedNodes(BT::BehaviorTreeFactory& factory);
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_TREE_GENERATOR_HPP */
@@ -0,0 +1,111 @@
+#ifndef ROS2_BEHAVIORTREE_TREE_POOL_HPP
+#define ROS2_BEHAVIORTREE_TREE_POOL_HPP
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace bt_ros
+{
+  // Nodes with state that halt() does not clear, reset when their tree goes back to a TreePool
+  class ResettableNode
+  {
+  public:
+    virtual ~ResettableNode() = default;
+    virtual void resetState() = 0;
+  };
+
+  class TreePool;
+
+  // A tree borrowed from a TreePool, given back when destroyed
+  class PooledTree
+  {
+  public:
+    PooledTree() = default;
+    PooledTree(PooledTree&& other) noexcept;
+    PooledTree& operator=(PooledTree&& other) noexcept;
+    ~PooledTree();
+
+    BT::Tree& tree();
+    BT::Tree* operator->() { return &tree(); }
+    explicit operator bool() const { return nullptr != instance_; }
+
+    // Give the tree back before the handle is destroyed
+    void release();
+
+  private:
+    friend class TreePool;
+    struct Instance;
+
+    PooledTree(TreePool* pool, std::unique_ptr<Instance> instance);
+
+    TreePool* pool_ = nullptr;
+    std::unique_ptr<Instance> instance_;
+  };
+
+  /**
+   * Prebuilt tree instances, by tree ID, reset instead of rebuilt.
+   *
+   * acquire() hands out an idle instance of a tree, built only when none is
+   * left. When the PooledTree is destroyed the tree is reset and goes back to
+   * the pool: halted (every status IDLE), each blackboard restored to the
+   * entries and values it had right after construction, and the nodes
+   * deriving from ResettableNode reset. The next acquire() is then a pop
+   * from a list. A tree whose reset throws is logged, counted by dropped()
+   * and destroyed instead.
+   *
+   * acquire() and the release of trees may happen on any thread, a tree
+   * is reset by the thread releasing it and the builder is called by one
+   * thread at a time. The pool must outlive its trees.
+   */
+  class TreePool
+  {
+  public:
+    using Builder = std::function<BT::Tree(const std::string& tree_ID)>;
+
+    // Builds with factory.createTree(tree_ID), each instance with its own blackboard
+    explicit TreePool(BT::BehaviorTreeFactory& factory);
+    explicit TreePool(Builder builder);
+    ~TreePool();
+
+    TreePool(const TreePool&) = delete;
+    TreePool& operator=(const TreePool&) = delete;
+
+    // Build instances until `count` are idle
+    void reserve(const std::string& tree_ID, std::size_t count);
+
+    // An idle instance of tree_ID, built if there is none
+    PooledTree acquire(const std::string& tree_ID);
+
+    std::size_t idle(const std::string& tree_ID) const;
+
+    // Instances built since the pool was created
+    std::size_t built() const;
+
+    // Instances dropped because their reset threw, the pool built them again on demand
+    std::size_t dropped() const;
+
+  private:
+    friend class PooledTree;
+
+    std::unique_ptr<PooledTree::Instance> build(const std::string& tree_ID);
+    void giveBack(std::unique_ptr<PooledTree::Instance> instance);
+
+    Builder builder_;
+    std::mutex build_mutex_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::vector<std::unique_ptr<PooledTree::Instance>>> idle_;
+    std::size_t built_ = 0;
+    std::size_t dropped_ = 0;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_TREE_POOL_HPP */
@@ -0,0 +1,75 @@
+#ifndef ROS2_BEHAVIORTREE_WORK_STEALING_POOL_HPP
+#define ROS2_BEHAVIORTREE_WORK_STEALING_POOL_HPP
+
+// STL
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bt_ros
+{
+  /**
+   * Worker threads with one job queue each, for fork-join batches.
+   *
+   * parallelFor() spreads the jobs of a batch over the queues and returns
+   * once all of them ran. A worker runs the jobs of its own queue newest
+   * first and, when it is empty, steals the oldest job of another queue, so
+   * that jobs of uneven cost still keep every thread busy. The calling
+   * thread runs jobs too while it waits, which also makes nested batches
+   * (a job calling parallelFor()) safe.
+   *
+   * Idle workers sleep on an atomic, no thread spins.
+   */
+  class WorkStealingPool
+  {
+  public:
+    // One thread less than the hardware has, the calling thread is the last one
+    static std::size_t defaultThreadCount();
+
+    explicit WorkStealingPool(std::size_t thread_count = defaultThreadCount());
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Created on first use with defaultThreadCount() threads
+    static WorkStealingPool& shared();
+
+    std::size_t threadCount() const { return workers_.size(); }
+
+    // Run job(i) for every i in [0, count) and wait, the first exception thrown is rethrown
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& job);
+
+  private:
+    struct Batch;
+
+    struct Job
+    {
+      Batch* batch;
+      std::size_t index;
+    };
+
+    struct alignas(64) Queue
+    {
+      std::mutex mutex;
+      std::deque<Job> jobs;
+    };
+
+    // Run one queued job, from `home` first then stolen from the others
+    bool runOne(std::size_t home);
+    void run(std::size_t worker, std::stop_token stop);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    // Jobs queued and not taken yet, idle workers wait for it to change
+    std::atomic<std::uint64_t> queued_;
+    std::atomic<std::size_t> next_queue_;
+    std::vector<std::jthread> workers_;
+  };
+} // bt_ros
+#endif /* ROS2_BEHAVIORTREE_WORK_STEALING_POOL_HPP */
@@ -0,0 +1,211 @@
+#include "ros2-behaviortree/async_log.hpp"
+
+// ROS2
+#include <rclcpp/rclcpp.hpp>
+
+// STL
+#include <chrono>
+
+namespace bt_ros
+{
+  namespace
+  {
+    // Keeps the ring of a thread until the thread exits
+    struct ThreadRingHolder
+    {
+      std::shared_ptr<void> ring;
+      std::atomic<bool>* closed = nullptr;
+
+      ~ThreadRingHolder()
+      {
+        if (closed)
+        {
+          closed->store(true, std::memory_order_release);
+        }
+      }
+    };
+
+    thread_local ThreadRingHolder thread_ring;
+
+    void writeToStdout(LogLevel, std::string_view line)
+    {
+      std::fwrite(line.data(), 1, line.size(), stdout);
+      std::fputc('\n', stdout);
+    }
+  } // anonymous namespace
+
+  AsyncLog::Record* AsyncLog::Ring::claim() noexcept
+  {
+    const auto head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ == RING_CAPACITY)
+    {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head - cached_tail_ == RING_CAPACITY)
+      {
+        return nullptr;
+      }
+    }
+    return &records_[head % RING_CAPACITY];
+  }
+
+  void AsyncLog::Ring::publish() noexcept
+  {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  const AsyncLog::Record* AsyncLog::Ring::front() const noexcept
+  {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire))
+    {
+      return nullptr;
+    }
+    return &records_[tail % RING_CAPACITY];
+  }
+
+  void AsyncLog::Ring::pop() noexcept
+  {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  AsyncLog& AsyncLog::instance()
+  {
+    static AsyncLog log;
+    return log;
+  }
+
+  AsyncLog::AsyncLog()
+    : sink_{writeToStdout}
+    , dropped_{0}
+    , reported_dropped_{0}
+  {
+    worker_ = std::jthread([this](std::stop_token stop) { run(stop); });
+  }
+
+  AsyncLog::~AsyncLog()
+  {
+    worker_.request_stop();
+    worker_.join();
+    // Whatever was written after the last pass
+    drain();
+    std::fflush(stdout);
+  }
+
+  void AsyncLog::setSink(Sink sink)
+  {
+    std::scoped_lock lock{sink_mutex_};
+    sink_ = sink ? std::move(sink) : Sink{writeToStdout};
+  }
+
+  void AsyncLog::flush()
+  {
+    std::vector<std::pair<std::shared_ptr<Ring>, std::uint64_t>> targets;
+    {
+      std::scoped_lock lock{rings_mutex_};
+      for (const auto& ring : rings_)
+      {
+        targets.emplace_back(ring, ring->written());
+      }
+    }
+    for (const auto& [ring, written] : targets)
+    {
+      while (ring->drained() < written)
+      {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    }
+    // The record is popped once handed to the sink, wait for the pass to end
+    std::scoped_lock lock{sink_mutex_};
+    std::fflush(stdout);
+  }
+
+  std::uint64_t AsyncLog::dropped() const
+  {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  AsyncLog::Ring* AsyncLog::threadRing() noexcept
+  {
+    if (thread_ring.ring)
+    {
+      return static_cast<Ring*>(thread_ring.ring.get());
+    }
+    try
+    {
+      auto ring = std::make_shared<Ring>();
+      {
+        std::scoped_lock lock{rings_mutex_};
+        rings_.push_back(ring);
+      }
+      thread_ring.closed = &ring->closed;
+      thread_ring.ring = ring;
+      return ring.get();
+    }
+    catch (...)
+    {
+      return nullptr;
+    }
+  }
+
+  void AsyncLog::drain()
+  {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+      std::scoped_lock lock{rings_mutex_};
+      rings = rings_;
+    }
+
+    std::scoped_lock lock{sink_mutex_};
+    for (const auto& ring : rings)
+    {
+      while (const auto record = ring->front())
+      {
+        line_.clear();
+        record->format(record->payload, line_);
+        sink_(record->level, line_);
+        ring->pop();
+      }
+    }
+
+    const auto dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_dropped_)
+    {
+      line_ = "[AsyncLog] " + std::to_string(dropped - reported_dropped_) + " record(s) dropped, the sink is too slow";
+      sink_(LogLevel::WARN, line_);
+      reported_dropped_ = dropped;
+    }
+
+    // Rings of exited threads, once empty
+    std::scoped_lock rings_lock{rings_mutex_};
+    std::erase_if(rings_, [](const auto& ring)
+      {
+        return ring->closed.load(std::memory_order_acquire) && ring->drained() == ring->written();
+      });
+  }
+
+  void AsyncLog::run(std::stop_token stop)
+  {
+    while (!stop.stop_requested())
+    {
+      drain();
+      std::fflush(stdout);
+      // Polling keeps the writers free of any wake up syscall
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  AsyncLog::Sink rosLogSink(const rclcpp::Logger& logger)
+  {
+    return [logger](LogLevel level, std::string_view line)
+      {
+        const auto length = static_cast<int>(line.size());
+        switch (level)
+        {
+          case LogLevel::DEBUG: RCLCPP_DEBUG(logger, "%.*s", length, line.data()); break;
+          case LogLevel::INFO: RCLCPP_INFO(logger, "%.*s", length, line.data()); break;
+          case LogLevel::WARN: RCLCPP_WARN(logger, "%.*s", length, line.data()); break;
+          case LogLevel::ERROR: RCLCPP_ERROR(logger, "%.*s", length, line.data()); break;
+        }
+      };
+  }
+} // bt_ros
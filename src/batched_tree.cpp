@@ -0,0 +1,333 @@
+#include "ros2-behaviortree/batched_tree.hpp"
+
+// STL
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace bt_ros
+{
+  BatchedTree::BatchedTree(const BT::Tree& prototype, const BatchedLeaves& leaves, std::size_t instances)
+    : instances_{instances}
+    , controls_{0}
+  {
+    if (!prototype.rootNode())
+    {
+      throw BT::RuntimeError("BatchedTree: empty prototype tree");
+    }
+    if (instances_ > std::numeric_limits<std::uint32_t>::max())
+    {
+      throw BT::RuntimeError("BatchedTree: too many instances");
+    }
+    add(*prototype.rootNode(), leaves);
+    for (const auto& leaf : leaves_)
+    {
+      leaf->resize(instances_);
+    }
+
+    statuses_.assign(nodes_.size() * instances_, BT::NodeStatus::IDLE);
+    child_index_.assign(controls_ * instances_, 0);
+    buffers_.resize(controls_ * 3 * instances_);
+    starting_.resize(instances_);
+    running_.resize(instances_);
+    leaf_statuses_.resize(instances_);
+    all_.resize(instances_);
+    std::iota(all_.begin(), all_.end(), 0u);
+    results_.assign(instances_, BT::NodeStatus::IDLE);
+  }
+
+  std::uint32_t BatchedTree::add(const BT::TreeNode& node, const BatchedLeaves& leaves)
+  {
+    const auto index = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.push_back(Node{Kind::LEAF, 0, 0, 0});
+
+    std::vector<const BT::TreeNode*> children;
+    auto kind = Kind::LEAF;
+    if (const auto control = dynamic_cast<const BT::ControlNode*>(&node))
+    {
+      // AsyncSequence is a SequenceNode that yields after every child
+      if (dynamic_cast<const BT::SequenceNode*>(control) && "AsyncSequence" != node.registrationName())
+      {
+        kind = Kind::SEQUENCE;
+      }
+      else if (dynamic_cast<const BT::FallbackNode*>(control) && "AsyncFallback" != node.registrationName())
+      {
+        kind = Kind::FALLBACK;
+      }
+      else
+      {
+        throw BT::RuntimeError("BatchedTree: control node [", node.registrationName(), "] is not supported");
+      }
+      children.assign(control->children().begin(), control->children().end());
+    }
+    else if (const auto decorator = dynamic_cast<const BT::DecoratorNode*>(&node))
+    {
+      if (dynamic_cast<const BT::InverterNode*>(decorator))
+      {
+        kind = Kind::INVERTER;
+      }
+      else if (dynamic_cast<const BT::SubTreeNode*>(decorator))
+      {
+        kind = Kind::FORWARD;
+      }
+      else
+      {
+        throw BT::RuntimeError("BatchedTree: decorator [", node.registrationName(), "] is not supported");
+      }
+      children.push_back(decorator->child());
+    }
+    else
+    {
+      const auto builder = leaves.find(node.registrationName());
+      if (leaves.end() == builder)
+      {
+        throw BT::RuntimeError("BatchedTree: no batched leaf for [", node.registrationName(), "]");
+      }
+      nodes_[index].slot = static_cast<std::uint32_t>(leaves_.size());
+      leaves_.push_back(builder->second());
+      return index;
+    }
+
+    std::vector<std::uint32_t> child_indexes;
+    for (const auto child : children)
+    {
+      child_indexes.push_back(add(*child, leaves));
+    }
+    auto& added = nodes_[index];
+    added.kind = kind;
+    added.first_child = static_cast<std::uint32_t>(children_.size());
+    added.child_count = static_cast<std::uint32_t>(child_indexes.size());
+    if (Kind::SEQUENCE == kind || Kind::FALLBACK == kind)
+    {
+      added.slot = static_cast<std::uint32_t>(controls_++);
+    }
+    children_.insert(children_.end(), child_indexes.begin(), child_indexes.end());
+    return index;
+  }
+
+  std::size_t BatchedTree::tickAll()
+  {
+    tick(0, all_);
+    std::size_t running = 0;
+    for (std::uint32_t i = 0; i < instances_; ++i)
+    {
+      auto& status = statusOf(0, i);
+      results_[i] = status;
+      if (BT::NodeStatus::RUNNING == status)
+      {
+        ++running;
+      }
+      else
+      {
+        // Like BT::Tree, a completed root is ticked from scratch next time
+        status = BT::NodeStatus::IDLE;
+      }
+    }
+    return running;
+  }
+
+  void BatchedTree::halt(std::size_t instance)
+  {
+    halt(0, static_cast<std::uint32_t>(instance));
+    results_[instance] = BT::NodeStatus::IDLE;
+  }
+
+  void BatchedTree::haltAll()
+  {
+    for (std::size_t i = 0; i < instances_; ++i)
+    {
+      halt(i);
+    }
+  }
+
+  void BatchedTree::tick(std::uint32_t node, std::span<const std::uint32_t> active)
+  {
+    if (active.empty())
+    {
+      return;
+    }
+    const auto& ticked = nodes_[node];
+    switch (ticked.kind)
+    {
+      case Kind::SEQUENCE:
+      case Kind::FALLBACK:
+        tickControl(node, active);
+        break;
+      case Kind::INVERTER:
+      case Kind::FORWARD:
+      {
+        const auto child = children_[ticked.first_child];
+        tick(child, active);
+        for (const auto i : active)
+        {
+          auto& child_status = statusOf(child, i);
+          auto status = child_status;
+          if (Kind::INVERTER == ticked.kind && BT::isStatusCompleted(status))
+          {
+            status = BT::NodeStatus::SUCCESS == status ? BT::NodeStatus::FAILURE : BT::NodeStatus::SUCCESS;
+          }
+          if (BT::isStatusCompleted(child_status))
+          {
+            child_status = BT::NodeStatus::IDLE;
+          }
+          statusOf(node, i) = status;
+        }
+        break;
+      }
+      case Kind::LEAF:
+        tickLeaf(node, active);
+        break;
+    }
+  }
+
+  void BatchedTree::tickControl(std::uint32_t node, std::span<const std::uint32_t> active)
+  {
+    const auto& control = nodes_[node];
+    // A Sequence moves on to the next child on SUCCESS, a Fallback on FAILURE
+    const auto next_on = Kind::SEQUENCE == control.kind ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
+    const auto stop_on = Kind::SEQUENCE == control.kind ? BT::NodeStatus::FAILURE : BT::NodeStatus::SUCCESS;
+
+    auto* pending = buffers_.data() + static_cast<std::size_t>(control.slot) * 3 * instances_;
+    auto* keep = pending + instances_;
+    auto* ticked = keep + instances_;
+    std::copy(active.begin(), active.end(), pending);
+    auto pending_count = active.size();
+    for (const auto i : active)
+    {
+      statusOf(node, i) = BT::NodeStatus::RUNNING;
+    }
+
+    // Child indexes only grow during a tick: child k gets every instance
+    // pending at it, those moving on are handled by the children after it
+    for (std::uint32_t k = 0; k < control.child_count && pending_count > 0; ++k)
+    {
+      std::size_t ticked_count = 0;
+      std::size_t keep_count = 0;
+      for (std::size_t j = 0; j < pending_count; ++j)
+      {
+        const auto i = pending[j];
+        if (k == childIndexOf(control, i))
+        {
+          ticked[ticked_count++] = i;
+        }
+        else
+        {
+          keep[keep_count++] = i;
+        }
+      }
+
+      const auto child = children_[control.first_child + k];
+      tick(child, {ticked, ticked_count});
+      for (std::size_t j = 0; j < ticked_count; ++j)
+      {
+        const auto i = ticked[j];
+        const auto child_status = statusOf(child, i);
+        if (next_on == child_status)
+        {
+          ++childIndexOf(control, i);
+          keep[keep_count++] = i;
+        }
+        else if (stop_on == child_status)
+        {
+          resetChildren(node, i);
+          childIndexOf(control, i) = 0;
+          statusOf(node, i) = stop_on;
+        }
+        else if (BT::NodeStatus::RUNNING != child_status)
+        {
+          throw BT::LogicError("BatchedTree: a child returned ", BT::toStr(child_status));
+        }
+      }
+      std::swap(pending, keep);
+      pending_count = keep_count;
+    }
+
+    // Went through every child
+    for (std::size_t j = 0; j < pending_count; ++j)
+    {
+      const auto i = pending[j];
+      resetChildren(node, i);
+      childIndexOf(control, i) = 0;
+      statusOf(node, i) = next_on;
+    }
+  }
+
+  void BatchedTree::tickLeaf(std::uint32_t node, std::span<const std::uint32_t> active)
+  {
+    std::size_t starting_count = 0;
+    std::size_t running_count = 0;
+    for (const auto i : active)
+    {
+      if (BT::NodeStatus::RUNNING == statusOf(node, i))
+      {
+        running_[running_count++] = i;
+      }
+      else
+      {
+        starting_[starting_count++] = i;
+      }
+    }
+
+    auto& leaf = *leaves_[nodes_[node].slot];
+    const auto store = [this, node](const std::uint32_t* instances, std::size_t count)
+      {
+        for (std::size_t j = 0; j < count; ++j)
+        {
+          if (BT::NodeStatus::IDLE == leaf_statuses_[j] || BT::NodeStatus::SKIPPED == leaf_statuses_[j])
+          {
+            throw BT::LogicError("BatchedTree: a leaf returned ", BT::toStr(leaf_statuses_[j]));
+          }
+          statusOf(node, instances[j]) = leaf_statuses_[j];
+        }
+      };
+    if (starting_count > 0)
+    {
+      leaf.start({starting_.data(), starting_count}, leaf_statuses_.data());
+      store(starting_.data(), starting_count);
+    }
+    if (running_count > 0)
+    {
+      leaf.running({running_.data(), running_count}, leaf_statuses_.data());
+      store(running_.data(), running_count);
+    }
+  }
+
+  void BatchedTree::resetChildren(std::uint32_t node, std::uint32_t instance)
+  {
+    const auto& parent = nodes_[node];
+    for (std::uint32_t k = 0; k < parent.child_count; ++k)
+    {
+      const auto child = children_[parent.first_child + k];
+      if (BT::NodeStatus::RUNNING == statusOf(child, instance))
+      {
+        halt(child, instance);
+      }
+      statusOf(child, instance) = BT::NodeStatus::IDLE;
+    }
+  }
+
+  void BatchedTree::halt(std::uint32_t node, std::uint32_t instance)
+  {
+    const auto& halted = nodes_[node];
+    switch (halted.kind)
+    {
+      case Kind::SEQUENCE:
+      case Kind::FALLBACK:
+        childIndexOf(halted, instance) = 0;
+        resetChildren(node, instance);
+        break;
+      case Kind::INVERTER:
+      case Kind::FORWARD:
+        resetChildren(node, instance);
+        break;
+      case Kind::LEAF:
+        if (BT::NodeStatus::RUNNING == statusOf(node, instance))
+        {
+          leaves_[halted.slot]->halted(instance);
+        }
+        break;
+    }
+    statusOf(node, instance) = BT::NodeStatus::IDLE;
+  }
+} // bt_ros
@@ -0,0 +1,65 @@
+/**
+ * Replacement of the global allocation functions counting every allocation,
+ * linked only into the benchmark executables.
+ */
+
+// STL
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "benchmark_utils.hpp"
+
+namespace
+{
+  std::atomic<std::uint64_t> allocation_count{0};
+
+  void* countedAlloc(std::size_t size)
+  {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+      return ptr;
+    }
+    throw std::bad_alloc();
+  }
+} // anonymous namespace
+
+namespace bt_ros::bench
+{
+  std::uint64_t allocations() noexcept
+  {
+    return allocation_count.load(std::memory_order_relaxed);
+  }
+} // bt_ros::bench
+
+void* operator new(std::size_t size)
+{
+  return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size)
+{
+  return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
@@ -0,0 +1,309 @@
+/**
+ * Batched tree benchmark
+ * Cost of one tick of every robot running the pick and place mission of
+ * main_tree.xml: one BT::Tree per robot ticked in turn, or all of them as
+ * instances of a BatchedTree. Both run the same simulated nodes and are
+ * checked to take the same steps before being timed.
+ */
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "ros2-behaviortree/batched_tree.hpp"
+#include "ros2-behaviortree/common_defs.hpp"
+#include "benchmark_utils.hpp"
+
+namespace
+{
+  // Steps of the mission each robot completed, step i is action i of common_defs.hpp
+  using Stages = std::vector<std::uint8_t>;
+
+  // Ticks action `step` of `robot` stays RUNNING
+  std::uint8_t duration(std::size_t robot, std::size_t step)
+  {
+    return static_cast<std::uint8_t>(2 + (robot + step) % 3);
+  }
+
+  int robotOf(const BT::NodeConfig& config)
+  {
+    int robot = 0;
+    config.blackboard->get("robot", robot);
+    return robot;
+  }
+} // anonymous namespace
+
+// SUCCESS once the robot completed the step
+class SimCondition : public BT::ConditionNode
+{
+public:
+  SimCondition(const std::string& name, const BT::NodeConfig& config, Stages& stages, std::size_t step)
+    : BT::ConditionNode(name, config)
+    , stages_{stages}
+    , step_{step}
+    , robot_{static_cast<std::size_t>(robotOf(config))}
+  {}
+
+  static BT::PortsList providedPorts() { return {}; }
+
+  BT::NodeStatus tick() override
+  {
+    return stages_[robot_] > step_ ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
+  }
+
+private:
+  Stages& stages_;
+  std::size_t step_;
+  std::size_t robot_;
+};
+
+// Completes the step after a few ticks
+class SimAction : public BT::StatefulActionNode
+{
+public:
+  SimAction(const std::string& name, const BT::NodeConfig& config, Stages& stages, std::size_t step)
+    : BT::StatefulActionNode(name, config)
+    , stages_{stages}
+    , step_{step}
+    , robot_{static_cast<std::size_t>(robotOf(config))}
+    , remaining_{0}
+  {}
+
+  static BT::PortsList providedPorts() { return {}; }
+
+  BT::NodeStatus onStart() override
+  {
+    remaining_ = duration(robot_, step_);
+    return BT::NodeStatus::RUNNING;
+  }
+
+  BT::NodeStatus onRunning() override
+  {
+    if (0 == --remaining_)
+    {
+      stages_[robot_] = static_cast<std::uint8_t>(step_ + 1);
+      return BT::NodeStatus::SUCCESS;
+    }
+    return BT::NodeStatus::RUNNING;
+  }
+
+  void onHalted() override {}
+
+private:
+  Stages& stages_;
+  std::size_t step_;
+  std::size_t robot_;
+  std::uint8_t remaining_;
+};
+
+// Same nodes, for every robot at once
+class BatchedSimCondition : public bt_ros::BatchedCondition
+{
+public:
+  BatchedSimCondition(const Stages& stages, std::size_t step)
+    : stages_{stages}
+    , step_{step}
+  {}
+
+  void evaluate(std::span<const std::uint32_t> instances, BT::NodeStatus* statuses) override
+  {
+    for (std::size_t j = 0; j < instances.size(); ++j)
+    {
+      statuses[j] = stages_[instances[j]] > step_ ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
+    }
+  }
+
+private:
+  const Stages& stages_;
+  std::size_t step_;
+};
+
+class BatchedSimAction : public bt_ros::BatchedLeaf
+{
+public:
+  BatchedSimAction(Stages& stages, std::size_t step)
+    : stages_{stages}
+    , step_{step}
+  {}
+
+  void resize(std::size_t instances) override
+  {
+    remaining_.assign(instances, 0);
+  }
+
+  void start(std::span<const std::uint32_t> instances, BT::NodeStatus* statuses) override
+  {
+    for (std::size_t j = 0; j < instances.size(); ++j)
+    {
+      remaining_[instances[j]] = duration(instances[j], step_);
+      statuses[j] = BT::NodeStatus::RUNNING;
+    }
+  }
+
+  void running(std::span<const std::uint32_t> instances, BT::NodeStatus* statuses) override
+  {
+    for (std::size_t j = 0; j < instances.size(); ++j)
+    {
+      const auto robot = instances[j];
+      if (0 == --remaining_[robot])
+      {
+        stages_[robot] = static_cast<std::uint8_t>(step_ + 1);
+        statuses[j] = BT::NodeStatus::SUCCESS;
+      }
+      else
+      {
+        statuses[j] = BT::NodeStatus::RUNNING;
+      }
+    }
+  }
+
+private:
+  Stages& stages_;
+  std::size_t step_;
+  std::vector<std::uint8_t> remaining_;
+};
+
+// One tree per robot, ticked in turn
+class SeparateTrees
+{
+public:
+  explicit SeparateTrees(std::size_t robots)
+    : stages_(robots, 0)
+  {
+    for (std::size_t i = 0; i < common::CONDITION_COUNT; ++i)
+    {
+      factory_.registerNodeType<SimCondition>(std::string{common::CONDITION_IDS[i]}, std::ref(stages_), i);
+    }
+    for (std::size_t i = 0; i < common::ACTION_COUNT; ++i)
+    {
+      factory_.registerNodeType<SimAction>(std::string{common::ACTION_IDS[i]}, std::ref(stages_), i);
+    }
+    for (std::size_t robot = 0; robot < robots; ++robot)
+    {
+      auto blackboard = BT::Blackboard::create();
+      blackboard->set("robot", static_cast<int>(robot));
+      trees_.push_back(factory_.createTreeFromFile("./config/behaviortree/main_tree.xml", blackboard));
+    }
+    statuses_.assign(robots, BT::NodeStatus::IDLE);
+  }
+
+  void tick()
+  {
+    for (std::size_t robot = 0; robot < trees_.size(); ++robot)
+    {
+      statuses_[robot] = trees_[robot].tickOnce();
+      // Mission completed, start again
+      if (BT::NodeStatus::SUCCESS == statuses_[robot])
+      {
+        stages_[robot] = 0;
+      }
+    }
+  }
+
+  const BT::Tree& prototype() const { return trees_.front(); }
+  const Stages& stages() const { return stages_; }
+  BT::NodeStatus status(std::size_t robot) const { return statuses_[robot]; }
+
+private:
+  Stages stages_;
+  BT::BehaviorTreeFactory factory_;
+  std::vector<BT::Tree> trees_;
+  std::vector<BT::NodeStatus> statuses_;
+};
+
+// Every robot as an instance of one BatchedTree
+class BatchedTrees
+{
+public:
+  BatchedTrees(const BT::Tree& prototype, std::size_t robots)
+    : stages_(robots, 0)
+    , tree_{prototype, leaves(stages_), robots}
+  {}
+
+  void tick()
+  {
+    tree_.tickAll();
+    for (std::size_t robot = 0; robot < stages_.size(); ++robot)
+    {
+      if (BT::NodeStatus::SUCCESS == tree_.status(robot))
+      {
+        stages_[robot] = 0;
+      }
+    }
+  }
+
+  const Stages& stages() const { return stages_; }
+  BT::NodeStatus status(std::size_t robot) const { return tree_.status(robot); }
+
+private:
+  static bt_ros::BatchedLeaves leaves(Stages& stages)
+  {
+    bt_ros::BatchedLeaves leaves;
+    for (std::size_t i = 0; i < common::CONDITION_COUNT; ++i)
+    {
+      leaves[std::string{common::CONDITION_IDS[i]}] = [&stages, i]()
+        {
+          return std::make_unique<BatchedSimCondition>(stages, i);
+        };
+    }
+    for (std::size_t i = 0; i < common::ACTION_COUNT; ++i)
+    {
+      leaves[std::string{common::ACTION_IDS[i]}] = [&stages, i]()
+        {
+          return std::make_unique<BatchedSimAction>(stages, i);
+        };
+    }
+    return leaves;
+  }
+
+  Stages stages_;
+  bt_ros::BatchedTree tree_;
+};
+
+int main()
+{
+  // Both modes must take the same steps, tick after tick
+  {
+    constexpr std::size_t robots = 64;
+    SeparateTrees separate{robots};
+    BatchedTrees batched{separate.prototype(), robots};
+    for (int tick = 0; tick < 100; ++tick)
+    {
+      separate.tick();
+      batched.tick();
+      for (std::size_t robot = 0; robot < robots; ++robot)
+      {
+        if (separate.stages()[robot] != batched.stages()[robot] || separate.status(robot) != batched.status(robot))
+        {
+          std::printf("mismatch at tick %d for robot %zu\n", tick, robot);
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+
+  for (const std::size_t robots : {100, 500, 2000})
+  {
+    const auto iterations = 200'000 / robots;
+    SeparateTrees separate{robots};
+    BatchedTrees batched{separate.prototype(), robots};
+
+    const auto separate_name = "separate trees x" + std::to_string(robots);
+    const auto batched_name = "batched tree x" + std::to_string(robots);
+    const auto separate_cost = bt_ros::bench::measure(separate_name.c_str(), iterations, [&](){ separate.tick(); });
+    const auto batched_cost = bt_ros::bench::measure(batched_name.c_str(), iterations, [&](){ batched.tick(); });
+    std::printf("%-40s %10.2fx\n", "speedup", separate_cost.ns_per_op / batched_cost.ns_per_op);
+  }
+
+  return EXIT_SUCCESS;
+}
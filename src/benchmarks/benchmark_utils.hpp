@@ -0,0 +1,53 @@
+#ifndef ROS2_BEHAVIORTREE_BENCHMARK_UTILS_HPP
+#define ROS2_BEHAVIORTREE_BENCHMARK_UTILS_HPP
+
+// STL
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace bt_ros::bench
+{
+  // Number of calls to the global operator new so far (alloc_counter.cpp)
+  std::uint64_t allocations() noexcept;
+
+  // Keep the optimizer from dropping a computed value
+  template <typename T>
+  inline void doNotOptimize(const T& value)
+  {
+    asm volatile("" : : "g"(&value) : "memory");
+  }
+
+  struct Measurement
+  {
+    double ns_per_op;
+    double allocs_per_op;
+  };
+
+  // Run fn() `iterations` times after a short warm up, print and return the cost per call
+  template <typename Fn>
+  Measurement measure(const char* name, std::size_t iterations, Fn&& fn)
+  {
+    for (std::size_t i = 0; i < iterations / 10 + 1; ++i)
+    {
+      fn();
+    }
+
+    const auto allocs_before = allocations();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+      fn();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const auto allocs = allocations() - allocs_before;
+
+    const Measurement result{
+      static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations,
+      static_cast<double>(allocs) / iterations};
+    std::printf("%-40s %10.1f ns/op %8.2f allocs/op\n", name, result.ns_per_op, result.allocs_per_op);
+    return result;
+  }
+} // bt_ros::bench
+#endif /* ROS2_BEHAVIORTREE_BENCHMARK_UTILS_HPP */
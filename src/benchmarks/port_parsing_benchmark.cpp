@@ -0,0 +1,149 @@
+/**
+ * Port parsing benchmark
+ * Cost of converting a literal port ("1.5;-2.25;0.75") into a Pose2D, with the
+ * splitString + convertFromString<float> conversion the tutorials used to
+ * define and with the from_chars based one of custom_types.hpp. Both are run
+ * standalone and through getInput() of a ticked tree, where a literal port is
+ * converted again on every call, and through a CachedInput that converts it once.
+ */
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#include "ros2-behaviortree/cached_input.hpp"
+#include "ros2-behaviortree/custom_types.hpp"
+#include "benchmark_utils.hpp"
+
+// Same layout as bt_ros::Pose2D, parsed the way the tutorials did
+struct LegacyPose2D
+{
+  float x, y, theta;
+};
+
+namespace BT
+{
+  template <> inline LegacyPose2D convertFromString(StringView str)
+  {
+    auto parts = splitString(str, ';');
+    if (3 != parts.size())
+    {
+      throw RuntimeError("invalid input");
+    }
+    else
+    {
+      return {convertFromString<float>(parts[0]), convertFromString<float>(parts[1]), convertFromString<float>(parts[2])};
+    }
+  }
+} // end namespace BT
+
+template <typename PoseT>
+class ReadGoalNode : public BT::SyncActionNode
+{
+public:
+  ReadGoalNode(const std::string& name, const BT::NodeConfig& config)
+    : BT::SyncActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<PoseT>("goal") };
+  }
+
+  BT::NodeStatus tick() override
+  {
+    PoseT goal;
+    if (!getInput<PoseT>("goal", goal))
+    {
+      return BT::NodeStatus::FAILURE;
+    }
+    bt_ros::bench::doNotOptimize(goal);
+    return BT::NodeStatus::SUCCESS;
+  }
+};
+
+class ReadCachedGoalNode : public BT::SyncActionNode
+{
+public:
+  ReadCachedGoalNode(const std::string& name, const BT::NodeConfig& config)
+    : BT::SyncActionNode(name, config)
+    , goal_input_{*this, "goal"}
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<bt_ros::Pose2D>("goal") };
+  }
+
+  BT::NodeStatus tick() override
+  {
+    const auto goal = goal_input_.get();
+    if (!goal)
+    {
+      return BT::NodeStatus::FAILURE;
+    }
+    bt_ros::bench::doNotOptimize(goal.value());
+    return BT::NodeStatus::SUCCESS;
+  }
+
+private:
+  bt_ros::CachedInput<bt_ros::Pose2D> goal_input_;
+};
+
+static const char* xml_text = R"(
+ <root BTCPP_format="4" >
+     <BehaviorTree ID="LegacyTree">
+        <ReadLegacyGoal goal="1.5;-2.25;0.75"/>
+     </BehaviorTree>
+     <BehaviorTree ID="FromCharsTree">
+        <ReadGoal goal="1.5;-2.25;0.75"/>
+     </BehaviorTree>
+     <BehaviorTree ID="CachedTree">
+        <ReadCachedGoal goal="1.5;-2.25;0.75"/>
+     </BehaviorTree>
+ </root>
+ )";
+
+int main()
+{
+  constexpr std::size_t iterations = 1'000'000;
+  const std::string literal{"1.5;-2.25;0.75"};
+
+  bt_ros::bench::measure("convertFromString (splitString)", iterations, [&]()
+    {
+      bt_ros::bench::doNotOptimize(BT::convertFromString<LegacyPose2D>(literal));
+    });
+  bt_ros::bench::measure("convertFromString (from_chars)", iterations, [&]()
+    {
+      bt_ros::bench::doNotOptimize(BT::convertFromString<bt_ros::Pose2D>(literal));
+    });
+
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<ReadGoalNode<LegacyPose2D>>("ReadLegacyGoal");
+  factory.registerNodeType<ReadGoalNode<bt_ros::Pose2D>>("ReadGoal");
+  factory.registerNodeType<ReadCachedGoalNode>("ReadCachedGoal");
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  auto legacy_tree = factory.createTree("LegacyTree");
+  auto tree = factory.createTree("FromCharsTree");
+  auto cached_tree = factory.createTree("CachedTree");
+
+  bt_ros::bench::measure("tick + getInput (splitString)", iterations, [&]()
+    {
+      legacy_tree.tickOnce();
+    });
+  bt_ros::bench::measure("tick + getInput (from_chars)", iterations, [&]()
+    {
+      tree.tickOnce();
+    });
+  bt_ros::bench::measure("tick + CachedInput", iterations, [&]()
+    {
+      cached_tree.tickOnce();
+    });
+
+  return 0;
+}
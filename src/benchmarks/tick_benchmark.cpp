@@ -0,0 +1,280 @@
+/**
+ * Tick throughput benchmark
+ * Cost of ticking the tutorial trees to completion with side-effect-free
+ * nodes: the CrossDoor tree of tutorial 5 (SubTree, Inverter, Retry), the
+ * nested subtrees of tutorial 10 and the scripts and Precondition of
+ * tutorial 9. Reports ticks per second, ns per node tick and allocations
+ * per tick.
+ *
+ *   tick_benchmark [--baseline FILE] [--update] [--tolerance 0.15]
+ *
+ * With --baseline the results are compared to FILE, recorded there when it
+ * does not exist yet (or with --update): the run fails when a tree got
+ * slower than the tolerance allows or allocates more per tick. Run from the
+ * package directory, the trees are read from ./config/behaviortree.
+ */
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ros2-behaviortree/tick_hooks.hpp"
+#include "benchmark_utils.hpp"
+
+// tutorial 5 without logging, reset before every run so that each one takes the same path
+class CrossDoor
+{
+public:
+  void registerNodes(BT::BehaviorTreeFactory& factory)
+  {
+    factory.registerSimpleCondition("IsDoorClosed", [this](BT::TreeNode&)
+        { return !door_open_ ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE; });
+    factory.registerSimpleAction("PassThroughDoor", [this](BT::TreeNode&)
+        { return door_open_ ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE; });
+    factory.registerSimpleAction("OpenDoor", [this](BT::TreeNode&)
+        {
+          door_open_ = !door_locked_;
+          return door_open_ ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
+        });
+    factory.registerSimpleAction("PickLock", [this](BT::TreeNode&)
+        {
+          if (pick_attempts_++ < 3)
+          {
+            return BT::NodeStatus::FAILURE;
+          }
+          door_locked_ = false;
+          return BT::NodeStatus::SUCCESS;
+        });
+    factory.registerSimpleAction("SmashDoor", [this](BT::TreeNode&)
+        {
+          door_locked_ = false;
+          door_open_ = true;
+          return BT::NodeStatus::SUCCESS;
+        });
+  }
+
+  void reset()
+  {
+    door_open_ = false;
+    door_locked_ = true;
+    pick_attempts_ = 0;
+  }
+
+private:
+  bool door_open_ {false};
+  bool door_locked_ {true};
+  int pick_attempts_ {0};
+};
+
+// tutorial 9 SaySomething, reading its input without printing it
+class ReadMessageNode : public BT::SyncActionNode
+{
+public:
+  ReadMessageNode(const std::string& name, const BT::NodeConfig& config)
+    : BT::SyncActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<std::string>("message") };
+  }
+
+  BT::NodeStatus tick() override
+  {
+    auto msg = getInput<std::string>("message");
+    if (!msg)
+    {
+      throw BT::RuntimeError("missing required input [message]: ", msg.error());
+    }
+    bt_ros::bench::doNotOptimize(msg.value());
+    return BT::NodeStatus::SUCCESS;
+  }
+};
+
+enum Color
+{
+  RED = 1,
+  BLUE = 2,
+  GREEN = 3
+};
+
+// Node ticks of one run, the hooks are only installed for this count
+class TickCounter : public bt_ros::TickListener
+{
+public:
+  void onTickStart(const BT::TreeNode&, Clock::time_point) override { ++ticks; }
+  void onTickEnd(const BT::TreeNode&, BT::NodeStatus, Clock::time_point) override {}
+
+  std::uint64_t ticks = 0;
+};
+
+struct Result
+{
+  double ns_per_tick;
+  double allocs_per_tick;
+};
+
+template <typename ResetFn>
+Result measureTree(const char* name, BT::Tree& tree, ResetFn&& reset, std::size_t iterations)
+{
+  const auto run = [&]()
+    {
+      reset();
+      // No sleep between the ticks of a RUNNING tree, only the ticks are measured
+      bt_ros::bench::doNotOptimize(tree.tickWhileRunning(std::chrono::milliseconds(0)));
+    };
+
+  TickCounter counter;
+  {
+    bt_ros::TickHooks hooks{tree};
+    hooks.addListener(&counter);
+    run();
+  }
+
+  const auto measurement = bt_ros::bench::measure(name, iterations, run);
+  const auto node_ticks = static_cast<double>(counter.ticks ? counter.ticks : 1);
+  std::printf("%-40s %10.0f ticks/s %8.1f ns/node tick (%.0f node ticks)\n", "",
+      1e9 / measurement.ns_per_op, measurement.ns_per_op / node_ticks, node_ticks);
+  return {measurement.ns_per_op, measurement.allocs_per_op};
+}
+
+std::map<std::string, Result> readBaseline(const std::string& path)
+{
+  std::map<std::string, Result> baseline;
+  std::ifstream file(path);
+  std::string name;
+  Result result;
+  while (file >> name >> result.ns_per_tick >> result.allocs_per_tick)
+  {
+    baseline[name] = result;
+  }
+  return baseline;
+}
+
+void writeBaseline(const std::string& path, const std::map<std::string, Result>& results)
+{
+  std::ofstream file(path, std::ios::trunc);
+  for (const auto& [name, result] : results)
+  {
+    file << name << " " << result.ns_per_tick << " " << result.allocs_per_tick << "\n";
+  }
+}
+
+// Every tree of the baseline still measured, none slower than allowed, none allocating more
+bool checkBaseline(const std::map<std::string, Result>& baseline, const std::map<std::string, Result>& results,
+    double tolerance)
+{
+  bool passed = true;
+  for (const auto& [name, expected] : baseline)
+  {
+    const auto it = results.find(name);
+    if (results.end() == it)
+    {
+      std::printf("REGRESSION %s: not measured anymore\n", name.c_str());
+      passed = false;
+      continue;
+    }
+    const auto& actual = it->second;
+    if (actual.ns_per_tick > expected.ns_per_tick * (1.0 + tolerance))
+    {
+      std::printf("REGRESSION %s: %.1f ns/tick, baseline %.1f ns/tick\n", name.c_str(),
+          actual.ns_per_tick, expected.ns_per_tick);
+      passed = false;
+    }
+    // Allocations do not depend on the machine, a small margin absorbs the warm up ones
+    if (actual.allocs_per_tick > expected.allocs_per_tick + 0.01)
+    {
+      std::printf("REGRESSION %s: %.2f allocs/tick, baseline %.2f allocs/tick\n", name.c_str(),
+          actual.allocs_per_tick, expected.allocs_per_tick);
+      passed = false;
+    }
+  }
+  return passed;
+}
+
+int main(int argc, char* argv[])
+{
+  std::string baseline_path;
+  bool update = false;
+  double tolerance = 0.15;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string argument = argv[i];
+    if ("--baseline" == argument && i + 1 < argc)
+    {
+      baseline_path = argv[++i];
+    }
+    else if ("--tolerance" == argument && i + 1 < argc)
+    {
+      tolerance = std::atof(argv[++i]);
+    }
+    else if ("--update" == argument)
+    {
+      update = true;
+    }
+    else
+    {
+      std::fprintf(stderr, "usage: tick_benchmark [--baseline FILE] [--update] [--tolerance 0.15]\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  constexpr std::size_t iterations = 20'000;
+  std::map<std::string, Result> results;
+
+  {
+    BT::BehaviorTreeFactory factory;
+    CrossDoor cross_door;
+    cross_door.registerNodes(factory);
+    factory.registerBehaviorTreeFromFile("./config/behaviortree/tutorial_5.xml");
+    auto tree = factory.createTree("MainTree");
+    results["tutorial_5_cross_door"] = measureTree("tutorial_5 CrossDoor", tree,
+        [&](){ cross_door.reset(); }, iterations);
+  }
+
+  {
+    BT::BehaviorTreeFactory factory;
+    factory.registerBehaviorTreeFromFile("./config/behaviortree/tutorial_10.xml");
+    auto tree = factory.createTree("MainTree");
+    results["tutorial_10_nested_subtrees"] = measureTree("tutorial_10 nested subtrees", tree,
+        [](){}, iterations);
+  }
+
+  {
+    BT::BehaviorTreeFactory factory;
+    factory.registerNodeType<ReadMessageNode>("SaySomething");
+    factory.registerScriptingEnums<Color>();
+    factory.registerScriptingEnum("THE_ANSWER", 42);
+    auto tree = factory.createTreeFromFile("./config/behaviortree/tutorial_9.xml");
+    results["tutorial_9_precondition"] = measureTree("tutorial_9 scripts + Precondition", tree,
+        [](){}, iterations);
+  }
+
+  if (baseline_path.empty())
+  {
+    return EXIT_SUCCESS;
+  }
+  const auto baseline = readBaseline(baseline_path);
+  if (update || baseline.empty())
+  {
+    writeBaseline(baseline_path, results);
+    std::printf("Baseline recorded in %s\n", baseline_path.c_str());
+    return EXIT_SUCCESS;
+  }
+  if (!checkBaseline(baseline, results, tolerance))
+  {
+    return EXIT_FAILURE;
+  }
+  std::printf("No regression against %s (tolerance %.0f%%)\n", baseline_path.c_str(), tolerance * 100.0);
+  return EXIT_SUCCESS;
+}
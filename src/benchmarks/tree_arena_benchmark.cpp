@@ -0,0 +1,106 @@
+/**
+ * Tree arena benchmark
+ * Construction and tick times of the same tree of 256 action nodes, once with
+ * nodes allocated one by one on the heap and once with nodes deriving from
+ * ArenaAllocated, built in a TreeArena.
+ */
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ros2-behaviortree/tree_arena.hpp"
+#include "benchmark_utils.hpp"
+
+class CountNode : public BT::SyncActionNode
+{
+public:
+  CountNode(const std::string& name, const BT::NodeConfig& config)
+    : BT::SyncActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return {};
+  }
+
+  BT::NodeStatus tick() override
+  {
+    ++count_;
+    return BT::NodeStatus::SUCCESS;
+  }
+
+private:
+  std::uint64_t count_ = 0;
+};
+
+class ArenaCountNode : public CountNode, public bt_ros::ArenaAllocated
+{
+public:
+  using CountNode::CountNode;
+};
+
+// 16 sequences of 16 nodes each
+static std::string makeTree(const std::string& tree_ID, const std::string& node_ID)
+{
+  std::string xml = "<BehaviorTree ID=\"" + tree_ID + "\"><Sequence>";
+  for (int i = 0; i < 16; ++i)
+  {
+    xml += "<Sequence>";
+    for (int j = 0; j < 16; ++j)
+    {
+      xml += "<" + node_ID + "/>";
+    }
+    xml += "</Sequence>";
+  }
+  return xml + "</Sequence></BehaviorTree>";
+}
+
+int main()
+{
+  constexpr std::size_t build_iterations = 2'000;
+  constexpr std::size_t tick_iterations = 200'000;
+
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<CountNode>("Count");
+  factory.registerNodeType<ArenaCountNode>("ArenaCount");
+  factory.registerBehaviorTreeFromText("<root BTCPP_format=\"4\">" + makeTree("HeapTree", "Count")
+    + makeTree("ArenaTree", "ArenaCount") + "</root>");
+
+  bt_ros::bench::measure("createTree (heap nodes)", build_iterations, [&]()
+    {
+      auto tree = factory.createTree("HeapTree");
+      bt_ros::bench::doNotOptimize(tree);
+    });
+  bt_ros::bench::measure("createTree (arena nodes)", build_iterations, [&]()
+    {
+      auto arena_tree = bt_ros::buildInArena([&]() { return factory.createTree("ArenaTree"); });
+      bt_ros::bench::doNotOptimize(arena_tree);
+    });
+
+  // Trees built while other trees are built and destroyed, as in a long running process
+  std::vector<BT::Tree> churn;
+  for (int i = 0; i < 8; ++i)
+  {
+    churn.push_back(factory.createTree("HeapTree"));
+  }
+  auto heap_tree = factory.createTree("HeapTree");
+  churn.erase(churn.begin(), churn.begin() + 4);
+  auto arena_tree = bt_ros::buildInArena([&]() { return factory.createTree("ArenaTree"); });
+
+  bt_ros::bench::measure("tickOnce (heap nodes)", tick_iterations, [&]()
+    {
+      heap_tree.tickOnce();
+    });
+  bt_ros::bench::measure("tickOnce (arena nodes)", tick_iterations, [&]()
+    {
+      arena_tree.tree.tickOnce();
+    });
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * Tree pool benchmark
+ * Cost of getting a fresh instance of a tree with a SubTree for a short-lived
+ * job: built with BehaviorTreeFactory::createTree() every time, or acquired
+ * from a TreePool and reset when given back.
+ */
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <cstddef>
+#include <string>
+
+#include "ros2-behaviortree/tree_pool.hpp"
+#include "benchmark_utils.hpp"
+
+class CountNode : public BT::SyncActionNode
+{
+public:
+  CountNode(const std::string& name, const BT::NodeConfig& config)
+    : BT::SyncActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<int>("in"), BT::OutputPort<int>("out") };
+  }
+
+  BT::NodeStatus tick() override
+  {
+    int value = 0;
+    getInput("in", value);
+    setOutput("out", value + 1);
+    return BT::NodeStatus::SUCCESS;
+  }
+};
+
+static const char* xml_text = R"(
+ <root BTCPP_format="4" >
+     <BehaviorTree ID="JobTree">
+        <Sequence>
+            <Count in="0" out="{a}"/>
+            <Count in="{a}" out="{b}"/>
+            <SubTree ID="StepTree" value="{b}" result="{c}"/>
+            <Fallback>
+                <Count in="{c}" out="{d}"/>
+                <Count in="{d}" out="{e}"/>
+            </Fallback>
+        </Sequence>
+     </BehaviorTree>
+     <BehaviorTree ID="StepTree">
+        <Sequence>
+            <Count in="{value}" out="{tmp}"/>
+            <Count in="{tmp}" out="{result}"/>
+        </Sequence>
+     </BehaviorTree>
+ </root>
+ )";
+
+int main()
+{
+  constexpr std::size_t iterations = 20'000;
+
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<CountNode>("Count");
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  bt_ros::bench::measure("createTree + tick", iterations, [&]()
+    {
+      auto tree = factory.createTree("JobTree");
+      tree.tickWhileRunning();
+    });
+
+  bt_ros::TreePool pool{factory};
+  pool.reserve("JobTree", 1);
+  bt_ros::bench::measure("TreePool acquire + tick + release", iterations, [&]()
+    {
+      auto job = pool.acquire("JobTree");
+      job->tickWhileRunning();
+    });
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * Tree scaling benchmark
+ * How the cost of a tree grows with its size, on synthetic trees from
+ * bt_ros::generateTree(): XML parsing (registerBehaviorTreeFromText),
+ * instantiation (createTree), heap footprint of the instantiated tree and
+ * one tick of every node. The per-node columns stay flat as long as the
+ * framework scales linearly.
+ */
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "ros2-behaviortree/tree_generator.hpp"
+#include "benchmark_utils.hpp"
+
+// Bytes allocated on the heap and not freed yet, 0 when unknown
+std::size_t heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
+
+struct Row
+{
+  std::string label;
+  bt_ros::GeneratedTree tree;
+  bt_ros::bench::Measurement parse;
+  bt_ros::bench::Measurement create;
+  std::size_t footprint;
+  bt_ros::bench::Measurement tick;
+};
+
+Row measureShape(const std::string& label, const bt_ros::TreeShape& shape)
+{
+  Row row{label, bt_ros::generateTree(shape), {}, {}, 0, {}};
+  const auto& generated = row.tree;
+  // Roughly the same total time for every size
+  const auto iterations = std::max<std::size_t>(5, 200'000 / generated.nodes);
+
+  BT::BehaviorTreeFactory factory;
+  bt_ros::registerGeneratedNodes(factory);
+
+  row.parse = bt_ros::bench::measure((label + " parse").c_str(), iterations, [&]()
+    {
+      factory.clearRegisteredBehaviorTrees();
+      factory.registerBehaviorTreeFromText(generated.xml);
+    });
+
+  row.create = bt_ros::bench::measure((label + " createTree").c_str(), iterations, [&]()
+    {
+      auto tree = factory.createTree("MainTree");
+      bt_ros::bench::doNotOptimize(tree);
+    });
+
+  const auto heap_before = heapInUse();
+  auto tree = factory.createTree("MainTree");
+  const auto heap_after = heapInUse();
+  row.footprint = heap_after > heap_before ? heap_after - heap_before : 0;
+
+  row.tick = bt_ros::bench::measure((label + " tick").c_str(), iterations, [&]()
+    {
+      bt_ros::bench::doNotOptimize(tree.tickOnce());
+    });
+  return row;
+}
+
+int main()
+{
+  std::vector<Row> rows;
+
+  // Growing depth, fan-out 4: 16 to 16384 leaves
+  for (std::size_t depth = 2; depth <= 7; ++depth)
+  {
+    bt_ros::TreeShape shape;
+    shape.depth = depth;
+    shape.fan_out = 4;
+    rows.push_back(measureShape("depth " + std::to_string(depth), shape));
+  }
+
+  // Same size, without subtrees then every port remapped
+  {
+    bt_ros::TreeShape shape;
+    shape.depth = 6;
+    shape.fan_out = 4;
+    shape.subtree_every = 0;
+    rows.push_back(measureShape("depth 6 no subtree", shape));
+    shape.subtree_every = 1;
+    rows.push_back(measureShape("depth 6 subtree every level", shape));
+    shape.subtree_every = 2;
+    shape.remap_density = 0.0;
+    rows.push_back(measureShape("depth 6 literal ports", shape));
+    shape.remap_density = 1.0;
+    rows.push_back(measureShape("depth 6 remapped ports", shape));
+  }
+
+  std::printf("\n%-28s %7s %8s %11s %11s %11s %9s %10s\n", "tree", "nodes", "subtrees",
+      "parse ns/n", "create ns/n", "allocs/n", "bytes/n", "tick ns/n");
+  for (const auto& row : rows)
+  {
+    const auto nodes = static_cast<double>(row.tree.nodes);
+    std::printf("%-28s %7zu %8zu %11.1f %11.1f %11.2f %9.0f %10.1f\n", row.label.c_str(), row.tree.nodes,
+        row.tree.subtree_instances, row.parse.ns_per_op / nodes, row.create.ns_per_op / nodes,
+        row.create.allocs_per_op / nodes, static_cast<double>(row.footprint) / nodes, row.tick.ns_per_op / nodes);
+  }
+
+  return 0;
+}
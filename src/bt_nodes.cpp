@@ -0,0 +1,67 @@
+#include "ros2-behaviortree/bt_nodes.hpp"
+#include "ros2-behaviortree/common_defs.hpp"
+
+namespace bt_ros
+{
+  FeedbackCondition::FeedbackCondition(const std::string& name,
+      const BT::NodeConfig& config,
+      std::shared_ptr<NodeHandler> handler,
+      std::size_t index)
+    : BT::ConditionNode(name, config)
+    , handler_{std::move(handler)}
+    , index_{index}
+  {
+  }
+
+  BT::NodeStatus FeedbackCondition::tick()
+  {
+    const auto sample = handler_->feedback().read(index_);
+    return (sample.sequence && sample.value) ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
+  }
+
+  FeedbackAction::FeedbackAction(const std::string& name,
+      const BT::NodeConfig& config,
+      std::shared_ptr<NodeHandler> handler,
+      std::size_t index)
+    : BT::StatefulActionNode(name, config)
+    , handler_{std::move(handler)}
+    , index_{index}
+    , state_{common::actionState(index)}
+    , start_sequence_{0}
+  {
+  }
+
+  BT::NodeStatus FeedbackAction::onStart()
+  {
+    start_sequence_ = handler_->feedback().read(index_).sequence;
+    handler_->publishState(state_);
+    return BT::NodeStatus::RUNNING;
+  }
+
+  BT::NodeStatus FeedbackAction::onRunning()
+  {
+    // Only feedback received after the request counts
+    const auto sample = handler_->feedback().read(index_);
+    if (sample.sequence > start_sequence_ && sample.value)
+    {
+      return BT::NodeStatus::SUCCESS;
+    }
+    return BT::NodeStatus::RUNNING;
+  }
+
+  void FeedbackAction::onHalted()
+  {
+  }
+
+  void registerNodes(BT::BehaviorTreeFactory& factory, const std::shared_ptr<NodeHandler>& handler)
+  {
+    for (std::size_t i = 0; i < common::CONDITION_COUNT; ++i)
+    {
+      factory.registerNodeType<FeedbackCondition>(std::string{common::CONDITION_IDS[i]}, handler, i);
+    }
+    for (std::size_t i = 0; i < common::ACTION_COUNT; ++i)
+    {
+      factory.registerNodeType<FeedbackAction>(std::string{common::ACTION_IDS[i]}, handler, i);
+    }
+  }
+} // bt_ros
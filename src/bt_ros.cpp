@@ -3,23 +3,62 @@
 
 namespace bt_ros
 {
-  NodeHandler::NodeHandler()
-    : Node("main_bt_node")
-    , update_{false}
-    , condition_{false}
+  NodeHandler::NodeHandler(const rclcpp::NodeOptions& options)
+    : Node("main_bt_node", options)
+    , consumed_{}
+    , pending_since_{0}
   {
     RCLCPP_INFO_STREAM(get_logger(), "MAIN BT ROS NODE STARTED!");
 
+    declare_parameter<std::string>("tree_file", "./config/behaviortree/main_tree.xml");
+    // Binary cache of tree_file, empty to always parse the XML
+    declare_parameter<std::string>("tree_cache_file", "");
+    declare_parameter<double>("tick_rate", 25.0);
+    declare_parameter<bool>("event_driven", true);
+    declare_parameter<bool>("report_wake_latency", false);
+    // Memory-mapped ring of node transitions for bt_replay, empty to disable
+    declare_parameter<std::string>("transition_record_file", "");
+    // Period [s] of the per-node tick latency report on bt/tick_latency, 0 to disable
+    declare_parameter<double>("tick_profile_period", 0.0);
+    // Chrome trace JSON of the last ticks, written on exit, empty to disable
+    declare_parameter<std::string>("trace_file", "");
+
     pub_ = create_publisher<std_msgs::msg::String>("bt/state", 5);
+    state_id_pub_ = create_publisher<std_msgs::msg::UInt8>("bt/state_id", 5);
+
+    // Human readable decoding of bt/state_id, latched for late joiners
+    state_table_pub_ = create_publisher<std_msgs::msg::String>(
+        "bt/state_table", rclcpp::QoS(1).transient_local());
+    std_msgs::msg::String table;
+    for (std::size_t i = 0; i <= common::ACTION_COUNT; ++i)
+    {
+      const auto state = static_cast<common::StateId>(i);
+      table.data += std::to_string(i) + ": " + std::string{common::stateName(state)} + "\n";
+    }
+    state_table_pub_->publish(table);
     sub_ = create_subscription<std_msgs::msg::Bool>(
         "bt/feedback",
         5,
         [this](const std_msgs::msg::Bool::SharedPtr msg)
         {
-          this->update_ = true;
-          this->condition_ = msg->data;
+          this->mailbox_.write(0, msg->data);
+          this->notifyFeedback();
         }
       );
+
+    condition_subs_.reserve(common::CONDITION_COUNT);
+    for (std::size_t i = 0; i < common::CONDITION_COUNT; ++i)
+    {
+      condition_subs_.push_back(create_subscription<std_msgs::msg::Bool>(
+          std::string{common::CONDITION_TOPICS[i]},
+          5,
+          [this, i](const std_msgs::msg::Bool::SharedPtr msg)
+          {
+            this->mailbox_.write(i, msg->data);
+            this->notifyFeedback();
+          }
+        ));
+    }
   }
 
   NodeHandler::~NodeHandler()
@@ -28,15 +67,36 @@ namespace bt_ros
 
   void NodeHandler::startCondition()
   {
-    update_ = false;
-    condition_ = false;
+    for (std::size_t i = 0; i < common::CONDITION_COUNT; ++i)
+    {
+      consumed_[i] = mailbox_.read(i).sequence;
+    }
+  }
+
+  std::optional<bool> NodeHandler::getCondition(std::size_t index)
+  {
+    const auto sample = mailbox_.read(index);
+    if (sample.sequence > consumed_[index])
+    {
+      return {sample.value};
+    }
+    else
+    {
+      return {};
+    }
+  }
+
+  void NodeHandler::setWakeUpHandler(std::function<void()> handler)
+  {
+    wake_up_handler_ = std::move(handler);
   }
 
-  std::optional<bool> NodeHandler::getCondition()
+  std::optional<std::chrono::steady_clock::time_point> NodeHandler::consumeWakeUp()
   {
-    if (update_)
+    const auto since = pending_since_.exchange(0, std::memory_order_acq_rel);
+    if (since)
     {
-      return {condition_};
+      return {std::chrono::steady_clock::time_point{std::chrono::nanoseconds{since}}};
     }
     else
     {
@@ -44,10 +104,40 @@ namespace bt_ros
     }
   }
 
+  void NodeHandler::notifyFeedback()
+  {
+    const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::int64_t expected = 0;
+    // Only the first message of a burst wakes the tree up
+    if (pending_since_.compare_exchange_strong(expected, now, std::memory_order_acq_rel)
+        && wake_up_handler_)
+    {
+      wake_up_handler_();
+    }
+  }
+
   void NodeHandler::publishState(const std::string& state)
   {
     std_msgs::msg::String msg;
     msg.data = state;
     pub_->publish(msg);
   }
+
+  void NodeHandler::publishState(common::StateId state)
+  {
+    // Loaned messages are written in place by the middleware (zero copy),
+    // otherwise the preallocated message is serialized without allocating
+    if (state_id_pub_->can_loan_messages())
+    {
+      auto loaned = state_id_pub_->borrow_loaned_message();
+      loaned.get().data = static_cast<std::uint8_t>(state);
+      state_id_pub_->publish(std::move(loaned));
+    }
+    else
+    {
+      state_id_msg_.data = static_cast<std::uint8_t>(state);
+      state_id_pub_->publish(state_id_msg_);
+    }
+  }
 } // bt_ros
@@ -0,0 +1,224 @@
+#include "ros2-behaviortree/chrome_tracer.hpp"
+
+// STL
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace bt_ros
+{
+  namespace
+  {
+    // Small, stable number of the calling thread, for the trace tracks
+    std::uint8_t threadNumber()
+    {
+      static std::atomic<unsigned> next_thread{0};
+      thread_local const auto number = static_cast<std::uint8_t>(next_thread.fetch_add(1) & 0xff);
+      return number;
+    }
+
+    void writeString(std::ostream& out, const std::string& text)
+    {
+      out << '"';
+      for (const char c : text)
+      {
+        if ('"' == c || '\\' == c)
+        {
+          out << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+          out << escaped;
+        }
+        else
+        {
+          out << c;
+        }
+      }
+      out << '"';
+    }
+
+    // Microseconds, the unit of trace events, keeping the nanoseconds
+    void writeMicroseconds(std::ostream& out, std::uint64_t nanoseconds)
+    {
+      char text[32];
+      std::snprintf(text, sizeof(text), "%llu.%03llu", static_cast<unsigned long long>(nanoseconds / 1000),
+          static_cast<unsigned long long>(nanoseconds % 1000));
+      out << text;
+    }
+  } // anonymous namespace
+
+  ChromeTracer::ChromeTracer(TickHooks& hooks, std::size_t capacity)
+    : hooks_{hooks}
+    , origin_{Clock::now()}
+    , mask_{std::bit_ceil(std::max<std::size_t>(capacity, 1)) - 1}
+    , next_{0}
+  {
+    for (const auto node : hooks_.nodes())
+    {
+      if (states_.size() <= node->UID())
+      {
+        states_.resize(node->UID() + 1);
+      }
+      states_[node->UID()].node = node;
+    }
+    // Parents through the children of control nodes and decorators, SubTree nodes included
+    for (const auto node : hooks_.nodes())
+    {
+      const auto set_parent = [this, node](const BT::TreeNode* child)
+        {
+          if (child && child->UID() < states_.size())
+          {
+            states_[child->UID()].parent = node->UID();
+          }
+        };
+      if (const auto control = dynamic_cast<const BT::ControlNode*>(node))
+      {
+        for (const auto child : control->children())
+        {
+          set_parent(child);
+        }
+      }
+      else if (const auto decorator = dynamic_cast<const BT::DecoratorNode*>(node))
+      {
+        set_parent(decorator->child());
+      }
+    }
+    slices_ = std::make_unique<Slice[]>(mask_ + 1);
+    hooks_.addListener(this);
+  }
+
+  ChromeTracer::~ChromeTracer()
+  {
+    hooks_.removeListener(this);
+  }
+
+  std::uint64_t ChromeTracer::recorded() const
+  {
+    return next_.load(std::memory_order_relaxed);
+  }
+
+  bool ChromeTracer::isDescendant(std::uint16_t uid, std::uint16_t ancestor) const
+  {
+    while (uid < states_.size() && NO_PARENT != states_[uid].parent)
+    {
+      uid = states_[uid].parent;
+      if (ancestor == uid)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void ChromeTracer::onTickStart(const BT::TreeNode& node, Clock::time_point time)
+  {
+    auto& state = states_[node.UID()];
+    state.tick_start = time;
+    state.ticking = true;
+  }
+
+  void ChromeTracer::onTickEnd(const BT::TreeNode& node, BT::NodeStatus status, Clock::time_point time)
+  {
+    auto& state = states_[node.UID()];
+    if (!state.ticking)
+    {
+      // Replaced by a precondition, tick() did not run
+      return;
+    }
+    state.ticking = false;
+    const auto index = next_.fetch_add(1, std::memory_order_relaxed);
+    slices_[index & mask_] = Slice{
+        static_cast<std::uint64_t>(std::chrono::nanoseconds{state.tick_start - origin_}.count()),
+        static_cast<std::uint64_t>(std::chrono::nanoseconds{time - state.tick_start}.count()),
+        node.UID(), static_cast<std::uint8_t>(status), threadNumber()};
+  }
+
+  void ChromeTracer::write(std::ostream& out) const
+  {
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"behavior tree\"}}";
+
+    // Slices are stored as they end, a parent after its children
+    const auto end = next_.load(std::memory_order_acquire);
+    const auto begin = end - std::min<std::uint64_t>(end, mask_ + 1);
+    std::vector<Slice> slices;
+    slices.reserve(end - begin);
+    for (auto index = begin; index < end; ++index)
+    {
+      slices.push_back(slices_[index & mask_]);
+    }
+
+    // With the tick monitor a start is the end minus a truncated duration, and may come after
+    // the start of a child. Everything a thread ticks during a tick is a descendant, stored
+    // before the slice of that tick: extend each slice back over the pending slices of its
+    // descendants, so that children lie within their parent.
+    std::array<std::vector<const Slice*>, 256> pending;
+    for (auto& slice : slices)
+    {
+      auto& thread = pending[slice.thread];
+      const auto slice_end = slice.start_ns + slice.duration_ns;
+      while (!thread.empty() && isDescendant(thread.back()->uid, slice.uid))
+      {
+        slice.start_ns = std::min(slice.start_ns, thread.back()->start_ns);
+        thread.pop_back();
+      }
+      slice.duration_ns = slice_end - slice.start_ns;
+      thread.push_back(&slice);
+    }
+
+    // Sorted by start, the longest first, the last stored first on ties: parents come before
+    // their children as viewers expect
+    std::reverse(slices.begin(), slices.end());
+    std::stable_sort(slices.begin(), slices.end(), [](const Slice& a, const Slice& b)
+        {
+          return a.start_ns < b.start_ns || (a.start_ns == b.start_ns && a.duration_ns > b.duration_ns);
+        });
+
+    for (const auto& slice : slices)
+    {
+      const auto node = slice.uid < states_.size() ? states_[slice.uid].node : nullptr;
+      if (!node)
+      {
+        continue;
+      }
+      out << ",\n{\"name\":";
+      writeString(out, node->name());
+      out << ",\"cat\":";
+      writeString(out, node->registrationName());
+      out << ",\"ph\":\"X\",\"ts\":";
+      writeMicroseconds(out, slice.start_ns);
+      out << ",\"dur\":";
+      writeMicroseconds(out, slice.duration_ns);
+      out << ",\"pid\":1,\"tid\":" << static_cast<unsigned>(slice.thread) << ",\"args\":{\"path\":";
+      writeString(out, node->fullPath());
+      out << ",\"uid\":" << slice.uid << ",\"status\":\"" << BT::toStr(static_cast<BT::NodeStatus>(slice.status))
+          << "\"}}";
+    }
+    out << "\n]}\n";
+  }
+
+  void ChromeTracer::write(const std::string& path) const
+  {
+    const auto parent = std::filesystem::path{path}.parent_path();
+    std::error_code error;
+    if (!parent.empty())
+    {
+      std::filesystem::create_directories(parent, error);
+    }
+    std::ofstream file(path, std::ios::trunc);
+    if (file)
+    {
+      write(file);
+    }
+    if (!file)
+    {
+      throw BT::RuntimeError("ChromeTracer: cannot write [", path, "]");
+    }
+  }
+} // bt_ros
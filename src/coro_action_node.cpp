@@ -0,0 +1,106 @@
+#include "ros2-behaviortree/coro_action_node.hpp"
+
+#include "ros2-behaviortree/async_log.hpp"
+
+namespace bt_ros
+{
+  SleepAwaiter::SleepAwaiter(BT::TreeNode& node, DeadlineService& deadlines, std::chrono::nanoseconds timeout)
+    : deadlines_{deadlines}
+    , handle_{}
+    , expired_{timeout <= std::chrono::nanoseconds::zero()}
+  {
+    if (!expired_)
+    {
+      handle_ = deadlines_.wheel().schedule(DeadlineService::Clock::now() + timeout,
+          [this, &node]()
+          {
+            expired_ = true;
+            node.emitWakeUpSignal();
+          });
+    }
+  }
+
+  SleepAwaiter::~SleepAwaiter()
+  {
+    deadlines_.wheel().cancel(handle_);
+  }
+
+  CoroActionNode::CoroActionNode(const std::string& name, const BT::NodeConfig& config)
+    : BT::ActionNodeBase(name, config)
+  {
+  }
+
+  CoroActionNode::~CoroActionNode()
+  {
+    // Timers still armed by the body are cancelled with its frame
+    action_.reset();
+  }
+
+  BT::NodeStatus CoroActionNode::tick()
+  {
+    if (!action_)
+    {
+      action_ = run();
+    }
+    auto& promise = action_.promise();
+    if (promise.waiting)
+    {
+      // Nothing happened yet, the body stays suspended
+      if (!promise.waiting->ready())
+      {
+        return BT::NodeStatus::RUNNING;
+      }
+      promise.waiting = nullptr;
+    }
+
+    action_.resume();
+    if (!action_.done())
+    {
+      return BT::NodeStatus::RUNNING;
+    }
+
+    const auto result = promise.result;
+    const auto error = promise.error;
+    action_.reset();
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+    if (BT::NodeStatus::SUCCESS != result && BT::NodeStatus::FAILURE != result)
+    {
+      throw BT::LogicError("[", name(), "]: a coroutine action must co_return SUCCESS or FAILURE");
+    }
+    return result;
+  }
+
+  void CoroActionNode::halt()
+  {
+    if (!action_)
+    {
+      return;
+    }
+    auto& promise = action_.promise();
+    if (!action_.done() && promise.waiting)
+    {
+      // Deliver the cancellation through the pending co_await
+      promise.cancelled = true;
+      promise.waiting = nullptr;
+      action_.resume();
+      if (promise.error)
+      {
+        try
+        {
+          std::rethrow_exception(promise.error);
+        }
+        catch (const ActionCancelled&)
+        {
+        }
+        catch (const std::exception& error)
+        {
+          logError("[", name(), "]: halted coroutine action failed: ", error.what());
+        }
+      }
+    }
+    action_.reset();
+  }
+} // bt_ros
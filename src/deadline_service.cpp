@@ -0,0 +1,84 @@
+#include "ros2-behaviortree/deadline_service.hpp"
+
+// STL
+#include <algorithm>
+
+namespace bt_ros
+{
+  DeadlineService::DeadlineService(std::chrono::nanoseconds resolution)
+    : wheel_{resolution}
+  {
+  }
+
+  std::size_t DeadlineService::poll()
+  {
+    return wheel_.advance(Clock::now());
+  }
+
+  bool DeadlineService::sleep(BT::Tree& tree, std::chrono::nanoseconds max_wait)
+  {
+    // The fired timers emitted the wake up signal of their node, consume it
+    // or the next sleep returns at once and costs a spurious tick
+    const auto fired = [this, &tree]()
+      {
+        if (0 == poll())
+        {
+          return false;
+        }
+        tree.sleep(std::chrono::system_clock::duration::zero());
+        return true;
+      };
+
+    const auto limit = Clock::now() + max_wait;
+    for (auto now = Clock::now(); now < limit; now = Clock::now())
+    {
+      auto until = limit;
+      if (const auto next = wheel_.nextExpiry())
+      {
+        until = std::min(until, *next);
+      }
+
+      bool signaled = false;
+      if (until > now)
+      {
+        signaled = tree.sleep(std::chrono::duration_cast<std::chrono::system_clock::duration>(until - now));
+      }
+      // nextExpiry() is only a lower bound, keep sleeping if nothing fired
+      if (fired() || signaled)
+      {
+        return true;
+      }
+    }
+    return fired();
+  }
+
+  DeadlineTimer::DeadlineTimer(DeadlineService& service)
+    : service_{service}
+    , handle_{}
+    , expired_{false}
+  {
+  }
+
+  DeadlineTimer::~DeadlineTimer()
+  {
+    cancel();
+  }
+
+  void DeadlineTimer::start(BT::TreeNode& node, std::chrono::nanoseconds timeout)
+  {
+    cancel();
+    handle_ = service_.wheel().schedule(DeadlineService::Clock::now() + timeout,
+        [this, &node]()
+        {
+          expired_ = true;
+          node.emitWakeUpSignal();
+        });
+  }
+
+  void DeadlineTimer::cancel()
+  {
+    service_.wheel().cancel(handle_);
+    handle_ = {};
+    expired_ = false;
+  }
+} // bt_ros
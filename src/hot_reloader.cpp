@@ -0,0 +1,215 @@
+#include "ros2-behaviortree/hot_reloader.hpp"
+
+// STL
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <string_view>
+#include <utility>
+
+// POSIX
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace bt_ros
+{
+  namespace
+  {
+    std::int64_t steadyNow()
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+  } // anonymous namespace
+
+  TreeHotReloader::TreeHotReloader(const BT::BehaviorTreeFactory& factory,
+      std::string directory,
+      std::string cache_directory,
+      std::string main_tree_ID,
+      std::chrono::milliseconds settle_time,
+      BT::Blackboard::Ptr blackboard)
+    : factory_{factory}
+    , directory_{std::move(directory)}
+    , main_tree_ID_{std::move(main_tree_ID)}
+    , settle_time_{settle_time}
+    , loader_{directory_, std::move(cache_directory)}
+    , inotify_fd_{-1}
+    , stop_fd_{-1}
+    , pending_{false}
+    , last_event_{0}
+  {
+    library_ = loader_.load();
+    tree_ = library_->createTree(factory_, main_tree_ID_, std::move(blackboard));
+
+    // Editors save in place or write a temporary file renamed over the original
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0)
+    {
+      throw BT::RuntimeError("TreeHotReloader: inotify_init1 failed: ", std::strerror(errno));
+    }
+    if (inotify_add_watch(inotify_fd_, directory_.c_str(),
+          IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0)
+    {
+      const auto error = errno;
+      ::close(inotify_fd_);
+      throw BT::RuntimeError("TreeHotReloader: cannot watch [", directory_, "]: ", std::strerror(error));
+    }
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd_ < 0)
+    {
+      const auto error = errno;
+      ::close(inotify_fd_);
+      throw BT::RuntimeError("TreeHotReloader: eventfd failed: ", std::strerror(error));
+    }
+    watcher_ = std::jthread([this]() { watch(); });
+  }
+
+  TreeHotReloader::~TreeHotReloader()
+  {
+    const std::uint64_t stop = 1;
+    [[maybe_unused]] const auto written = ::write(stop_fd_, &stop, sizeof(stop));
+    watcher_.join();
+    ::close(stop_fd_);
+    ::close(inotify_fd_);
+  }
+
+  BT::Tree& TreeHotReloader::tree()
+  {
+    return tree_;
+  }
+
+  bool TreeHotReloader::changesPending() const
+  {
+    return pending_.load(std::memory_order_acquire);
+  }
+
+  bool TreeHotReloader::applyPendingChanges()
+  {
+    if (!pending_.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+    // A file may be written in several steps, wait until it is quiet
+    const auto start = std::chrono::steady_clock::now();
+    const auto quiet = std::chrono::nanoseconds{steadyNow() - last_event_.load(std::memory_order_acquire)};
+    if (quiet < settle_time_)
+    {
+      return false;
+    }
+    // Events arriving from now on trigger another reload
+    pending_.store(false, std::memory_order_release);
+
+    last_reload_ = {};
+    try
+    {
+      const auto previous_files = loader_.fileLibraries();
+      auto library = loader_.load();
+      const auto& files = loader_.fileLibraries();
+
+      // Trees of the changed files, as they were and as they are now
+      const auto add_trees = [this](const TreeLibrary& file_library)
+      {
+        for (auto& ID : file_library.treeIDs())
+        {
+          unapplied_.insert(std::move(ID));
+        }
+      };
+      for (const auto& file : loader_.report())
+      {
+        if (TreeFileReport::Origin::UNCHANGED == file.origin)
+        {
+          continue;
+        }
+        add_trees(files.at(file.path));
+        if (const auto previous = previous_files.find(file.path); previous_files.end() != previous)
+        {
+          add_trees(previous->second);
+        }
+      }
+      for (const auto& [path, file_library] : previous_files)
+      {
+        if (0 == files.count(path))
+        {
+          add_trees(file_library);
+        }
+      }
+      library_ = std::move(library);
+
+      last_reload_.changed_trees.assign(unapplied_.begin(), unapplied_.end());
+      std::sort(last_reload_.changed_trees.begin(), last_reload_.changed_trees.end());
+
+      const bool used = std::any_of(tree_.subtrees.begin(), tree_.subtrees.end(), [this](const auto& subtree)
+        {
+          return 0 != unapplied_.count(subtree->tree_ID);
+        });
+      if (used)
+      {
+        auto tree = library_->rebuildTree(factory_, tree_, unapplied_, main_tree_ID_,
+            &last_reload_.reused_subtrees);
+        // The reused nodes were detached from the previous tree, only the replaced ones are halted
+        tree_.haltTree();
+        tree_ = std::move(tree);
+        last_reload_.swapped = true;
+      }
+      unapplied_.clear();
+    }
+    catch (const std::exception& error)
+    {
+      last_reload_.error = error.what();
+    }
+    last_reload_.duration = std::chrono::steady_clock::now() - start;
+    return true;
+  }
+
+  const TreeReload& TreeHotReloader::lastReload() const
+  {
+    return last_reload_;
+  }
+
+  void TreeHotReloader::watch()
+  {
+    alignas(inotify_event) char buffer[4096];
+    pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+    while (true)
+    {
+      if (::poll(fds, 2, -1) < 0)
+      {
+        if (EINTR == errno)
+        {
+          continue;
+        }
+        return;
+      }
+      if (fds[1].revents)
+      {
+        return;
+      }
+
+      const auto length = ::read(inotify_fd_, buffer, sizeof(buffer));
+      if (length <= 0)
+      {
+        continue;
+      }
+      bool changed = false;
+      for (ssize_t offset = 0; offset < length;)
+      {
+        const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+        // On overflow events were lost, reload anyway
+        if ((event->mask & IN_Q_OVERFLOW)
+            || (event->len && std::string_view{event->name}.ends_with(".xml")))
+        {
+          changed = true;
+        }
+        offset += sizeof(inotify_event) + event->len;
+      }
+      if (changed)
+      {
+        last_event_.store(steadyNow(), std::memory_order_release);
+        pending_.store(true, std::memory_order_release);
+      }
+    }
+  }
+} // bt_ros
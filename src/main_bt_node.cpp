@@ -1,4 +1,11 @@
 #include "ros2-behaviortree/bt_ros.hpp"
+#include "ros2-behaviortree/bt_nodes.hpp"
+#include "ros2-behaviortree/chrome_tracer.hpp"
+#include "ros2-behaviortree/tick_engine.hpp"
+#include "ros2-behaviortree/tick_profiler.hpp"
+#include "ros2-behaviortree/transition_recorder.hpp"
+#include "ros2-behaviortree/tree_cache.hpp"
+#include <chrono>
 #include <memory>
 #include <thread>
 
@@ -8,14 +15,145 @@ int main (int argc, char *argv[])
 
   // init node
   auto node = std::make_shared<bt_ros::NodeHandler>();
-  // auto t = std::thread([node](){ rclcpp::spin(node); });
-  rclcpp::spin(node);
+  const auto tree_file = node->get_parameter("tree_file").as_string();
+  const auto tree_cache_file = node->get_parameter("tree_cache_file").as_string();
+  const auto tick_rate = node->get_parameter("tick_rate").as_double();
+  const auto event_driven = node->get_parameter("event_driven").as_bool();
+  const auto report_wake_latency = node->get_parameter("report_wake_latency").as_bool();
+  const auto transition_record_file = node->get_parameter("transition_record_file").as_string();
+  const auto tick_profile_period = node->get_parameter("tick_profile_period").as_double();
+  const auto trace_file = node->get_parameter("trace_file").as_string();
 
   // init bt tree
+  BT::BehaviorTreeFactory factory;
+  bt_ros::registerNodes(factory, node);
+
+  BT::Tree tree;
+  std::unique_ptr<bt_ros::TransitionRecorder> recorder;
+  try
+  {
+    if (tick_rate <= 0.0)
+    {
+      throw BT::RuntimeError("parameter [tick_rate] must be positive");
+    }
+    if (tree_cache_file.empty())
+    {
+      tree = factory.createTreeFromFile(tree_file);
+    }
+    else
+    {
+      // Map the precompiled tree, the XML is only parsed when it changed
+      const auto library = bt_ros::TreeLibrary::load(tree_file, tree_cache_file);
+      RCLCPP_INFO_STREAM(node->get_logger(), (library.fromCache() ? "Loaded tree cache " : "Built tree cache ")
+          << tree_cache_file);
+      tree = library.createTree(factory);
+    }
+    if (!transition_record_file.empty())
+    {
+      recorder = std::make_unique<bt_ros::TransitionRecorder>(tree, transition_record_file);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    RCLCPP_ERROR_STREAM(node->get_logger(), "Behavior tree error: " << e.what());
+    rclcpp::shutdown();
+    return EXIT_FAILURE;
+  }
+
+  // Feedback wakes the tree up instead of waiting for the next slot
+  if (event_driven)
+  {
+    node->setWakeUpHandler([&tree](){ tree.rootNode()->emitWakeUpSignal(); });
+  }
+
+  // Per-node tick latency, published from the executor thread, and trace of the last ticks
+  std::unique_ptr<bt_ros::TickHooks> hooks;
+  std::unique_ptr<bt_ros::TickProfiler> profiler;
+  std::unique_ptr<bt_ros::TickProfilePublisher> profile_publisher;
+  std::unique_ptr<bt_ros::ChromeTracer> tracer;
+  if (tick_profile_period > 0.0 || !trace_file.empty())
+  {
+    hooks = std::make_unique<bt_ros::TickHooks>(tree);
+  }
+  if (!trace_file.empty())
+  {
+    tracer = std::make_unique<bt_ros::ChromeTracer>(*hooks);
+  }
+  if (tick_profile_period > 0.0)
+  {
+    profiler = std::make_unique<bt_ros::TickProfiler>(*hooks);
+    profile_publisher = std::make_unique<bt_ros::TickProfilePublisher>(*node, *profiler,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(tick_profile_period)));
+  }
+
+  // Callbacks run on their own executor thread(s), the main thread only ticks
+  rclcpp::executors::MultiThreadedExecutor executor;
+  executor.add_node(node);
+  auto t = std::thread([&executor](){ executor.spin(); });
 
   // start tree
+  const auto period = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(1.0 / tick_rate));
+  bt_ros::TickEngine engine{tree, period};
+  if (event_driven)
+  {
+    engine.setEventProbe([&node, report_wake_latency]()
+        {
+          auto arrival = node->consumeWakeUp();
+          if (arrival && report_wake_latency)
+          {
+            const auto delay = std::chrono::steady_clock::now() - *arrival;
+            RCLCPP_INFO_STREAM(node->get_logger(), "Feedback to tick delay [us]: "
+                << std::chrono::duration_cast<std::chrono::microseconds>(delay).count());
+          }
+          return arrival;
+        });
+  }
+
+  int result = EXIT_SUCCESS;
+  try
+  {
+    auto status = engine.run([](){ return rclcpp::ok(); });
+
+    const auto& stats = engine.stats();
+    RCLCPP_INFO_STREAM(node->get_logger(), "Tree finished with status " << BT::toStr(status)
+        << ": ticks=" << stats.ticks
+        << " overruns=" << stats.overruns
+        << " skipped=" << stats.skipped
+        << " jitter mean/max [us]=" << stats.meanJitter().count() / 1000
+        << "/" << stats.max_jitter.count() / 1000
+        << " tick mean/max [us]=" << stats.meanTickTime().count() / 1000
+        << "/" << stats.max_tick_time.count() / 1000
+        << " wake ups=" << stats.wake_ups
+        << " wake latency mean/max [us]=" << stats.meanWakeLatency().count() / 1000
+        << "/" << stats.max_wake_latency.count() / 1000);
+  }
+  catch (const std::exception& e)
+  {
+    RCLCPP_ERROR_STREAM(node->get_logger(), "Behavior tree error: " << e.what());
+    result = EXIT_FAILURE;
+  }
+
+  if (recorder)
+  {
+    recorder->sync();
+  }
+  if (tracer)
+  {
+    try
+    {
+      tracer->write(trace_file);
+      RCLCPP_INFO_STREAM(node->get_logger(), "Wrote trace of the last ticks to " << trace_file);
+    }
+    catch (const std::exception& e)
+    {
+      RCLCPP_ERROR_STREAM(node->get_logger(), "Behavior tree trace error: " << e.what());
+    }
+  }
 
+  executor.cancel();
+  t.join();
   rclcpp::shutdown();
 
-  return EXIT_SUCCESS;
+  return result;
 }
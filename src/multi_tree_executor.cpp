@@ -0,0 +1,473 @@
+#include "ros2-behaviortree/multi_tree_executor.hpp"
+
+// STL
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+
+#include "ros2-behaviortree/async_log.hpp"
+
+namespace bt_ros
+{
+  // What the status change subscribers of a tree share with the executor, never the tree itself
+  struct MultiTreeExecutor::Waker
+  {
+    Waker(MultiTreeExecutor& tree_executor, Worker& tree_worker, TreeId tree_id)
+      : executor{&tree_executor}
+      , worker{&tree_worker}
+      , id{tree_id}
+    {
+    }
+
+    void statusChanged()
+    {
+      if (ticking.load(std::memory_order_acquire))
+      {
+        changed.store(true, std::memory_order_relaxed);
+        return;
+      }
+      // An asynchronous node completed on its own thread
+      std::lock_guard lock{mutex};
+      if (executor)
+      {
+        executor->wake(*worker, id);
+      }
+    }
+
+    // Once returned, no subscriber still running reaches the executor
+    void detach()
+    {
+      std::lock_guard lock{mutex};
+      executor = nullptr;
+      worker = nullptr;
+    }
+
+    std::mutex mutex;
+    MultiTreeExecutor* executor;
+    Worker* worker;
+    const TreeId id;
+    // A status changed during the tick, or outside of it from another thread
+    std::atomic<bool> ticking {false};
+    std::atomic<bool> changed {false};
+  };
+
+  struct MultiTreeExecutor::Hosted
+  {
+    TreeId id;
+    BT::Tree tree;
+    TreeOptions options;
+    // Last slot of the schedule, the next one is a period later
+    Clock::time_point slot;
+    TimerWheel::Handle timer;
+    bool parked = false;
+    bool done = false;
+    // Round of the worker loop the tree was last ticked in
+    std::uint64_t round = 0;
+    std::shared_ptr<Waker> waker;
+    // After the tree, unsubscribed before it is destroyed
+    std::vector<BT::TreeNode::StatusChangeSubscriber> subscribers;
+
+    Hosted(TreeId tree_id, BT::Tree&& hosted_tree, TreeOptions&& tree_options)
+      : id{tree_id}
+      , tree{std::move(hosted_tree)}
+      , options{std::move(tree_options)}
+    {
+    }
+
+    // Subscribers notifying from another thread right now may finish, they only own the waker
+    void unsubscribe()
+    {
+      subscribers.clear();
+      waker->detach();
+    }
+  };
+
+  struct MultiTreeExecutor::Worker
+  {
+    DeadlineService deadlines;
+    // Tick slots and idle timeouts of the hosted trees
+    TimerWheel slots;
+    std::unordered_map<TreeId, std::unique_ptr<Hosted>> trees;
+    // Filled by the timers while the wheel advances
+    std::vector<Hosted*> due;
+    std::uint64_t round = 0;
+    // Parked trees, their wake up signal is polled
+    std::size_t parked = 0;
+
+    // Handed over by the other threads
+    std::mutex mutex;
+    std::condition_variable_any signal;
+    std::vector<std::unique_ptr<Hosted>> incoming;
+    std::vector<TreeId> woken;
+
+    std::atomic<std::size_t> hosted {0};
+    struct
+    {
+      std::atomic<std::uint64_t> ticks {0};
+      std::atomic<std::uint64_t> overruns {0};
+      std::atomic<std::uint64_t> skipped {0};
+      std::atomic<std::uint64_t> parked {0};
+      std::atomic<std::uint64_t> wake_ups {0};
+      std::atomic<std::uint64_t> completed {0};
+    } stats;
+
+    // Last member, joined before the rest goes away
+    std::jthread thread;
+  };
+
+  namespace
+  {
+    void count(std::atomic<std::uint64_t>& counter, std::uint64_t amount = 1)
+    {
+      // Single writer, the worker thread
+      counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+  } // anonymous namespace
+
+  MultiTreeExecutor::MultiTreeExecutor(std::size_t worker_count, std::chrono::nanoseconds wake_poll_period)
+    : wake_poll_period_{std::max(wake_poll_period, std::chrono::nanoseconds{1})}
+    , next_sequence_{0}
+    , pending_{0}
+  {
+    worker_count = std::max<std::size_t>(worker_count, 1);
+    for (std::size_t i = 0; i < worker_count; ++i)
+    {
+      workers_.push_back(std::make_unique<Worker>());
+    }
+    for (auto& worker : workers_)
+    {
+      worker->thread = std::jthread{[this, &worker = *worker](std::stop_token stop){ run(worker, stop); }};
+    }
+  }
+
+  MultiTreeExecutor::~MultiTreeExecutor()
+  {
+    for (auto& worker : workers_)
+    {
+      worker->thread.request_stop();
+    }
+    workers_.clear();
+  }
+
+  std::size_t MultiTreeExecutor::leastLoadedWorker() const
+  {
+    std::size_t least = 0;
+    for (std::size_t i = 1; i < workers_.size(); ++i)
+    {
+      if (workers_[i]->hosted.load(std::memory_order_relaxed) < workers_[least]->hosted.load(std::memory_order_relaxed))
+      {
+        least = i;
+      }
+    }
+    return least;
+  }
+
+  DeadlineService& MultiTreeExecutor::deadlines(std::size_t worker)
+  {
+    if (worker >= workers_.size())
+    {
+      throw BT::RuntimeError("MultiTreeExecutor: no worker ", worker);
+    }
+    return workers_[worker]->deadlines;
+  }
+
+  MultiTreeExecutor::TreeId MultiTreeExecutor::add(BT::Tree tree, TreeOptions options)
+  {
+    if (!tree.rootNode())
+    {
+      throw BT::RuntimeError("MultiTreeExecutor: empty tree");
+    }
+    if (options.period <= std::chrono::nanoseconds::zero())
+    {
+      throw BT::RuntimeError("MultiTreeExecutor: period must be positive");
+    }
+    options.idle_period = std::max(options.idle_period, options.period);
+
+    const auto index = options.worker >= 0
+        ? static_cast<std::size_t>(options.worker) % workers_.size() : leastLoadedWorker();
+    auto& worker = *workers_[index];
+    // The worker is found back from the id
+    const auto id = next_sequence_.fetch_add(1, std::memory_order_relaxed) * workers_.size() + index;
+
+    auto hosted = std::make_unique<Hosted>(id, std::move(tree), std::move(options));
+    hosted->waker = std::make_shared<Waker>(*this, worker, id);
+    const auto on_change = [waker = hosted->waker]
+        (BT::TimePoint, const BT::TreeNode&, BT::NodeStatus, BT::NodeStatus)
+        {
+          waker->statusChanged();
+        };
+    for (const auto& subtree : hosted->tree.subtrees)
+    {
+      for (const auto& node : subtree->nodes)
+      {
+        hosted->subscribers.push_back(node->subscribeToStatusChange(on_change));
+      }
+    }
+
+    {
+      std::lock_guard lock{pending_mutex_};
+      ++pending_;
+    }
+    worker.hosted.fetch_add(1, std::memory_order_relaxed);
+    {
+      std::lock_guard lock{worker.mutex};
+      worker.incoming.push_back(std::move(hosted));
+    }
+    worker.signal.notify_one();
+    return id;
+  }
+
+  MultiTreeExecutor::TreeId MultiTreeExecutor::add(BT::Tree tree)
+  {
+    return add(std::move(tree), TreeOptions{});
+  }
+
+  void MultiTreeExecutor::wake(TreeId id)
+  {
+    wake(*workers_[id % workers_.size()], id);
+  }
+
+  void MultiTreeExecutor::wake(Worker& worker, TreeId id)
+  {
+    {
+      std::lock_guard lock{worker.mutex};
+      worker.woken.push_back(id);
+    }
+    worker.signal.notify_one();
+  }
+
+  std::size_t MultiTreeExecutor::pending() const
+  {
+    std::lock_guard lock{pending_mutex_};
+    return pending_;
+  }
+
+  void MultiTreeExecutor::waitAll()
+  {
+    std::unique_lock lock{pending_mutex_};
+    all_done_.wait(lock, [this](){ return 0 == pending_; });
+  }
+
+  MultiTreeExecutor::Stats MultiTreeExecutor::stats() const
+  {
+    Stats total;
+    for (const auto& worker : workers_)
+    {
+      total.ticks += worker->stats.ticks.load(std::memory_order_relaxed);
+      total.overruns += worker->stats.overruns.load(std::memory_order_relaxed);
+      total.skipped += worker->stats.skipped.load(std::memory_order_relaxed);
+      total.parked += worker->stats.parked.load(std::memory_order_relaxed);
+      total.wake_ups += worker->stats.wake_ups.load(std::memory_order_relaxed);
+      total.completed += worker->stats.completed.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  void MultiTreeExecutor::run(Worker& worker, std::stop_token stop)
+  {
+    std::vector<std::unique_ptr<Hosted>> incoming;
+    std::vector<TreeId> woken;
+
+    while (!stop.stop_requested())
+    {
+      {
+        std::unique_lock lock{worker.mutex};
+        const auto ready = [&worker](){ return !worker.incoming.empty() || !worker.woken.empty(); };
+        auto next = worker.slots.nextExpiry();
+        if (const auto deadline = worker.deadlines.nextExpiry())
+        {
+          next = next ? std::min(*next, *deadline) : *deadline;
+        }
+        if (worker.parked > 0)
+        {
+          // Nodes may wake their tree up with emitWakeUpSignal() alone, which only the tree sees
+          const auto poll = Clock::now() + wake_poll_period_;
+          next = next ? std::min(*next, poll) : poll;
+        }
+        if (next)
+        {
+          worker.signal.wait_until(lock, stop, *next, ready);
+        }
+        else
+        {
+          worker.signal.wait(lock, stop, ready);
+        }
+        if (stop.stop_requested())
+        {
+          break;
+        }
+        std::swap(incoming, worker.incoming);
+        std::swap(woken, worker.woken);
+      }
+
+      ++worker.round;
+      const auto now = Clock::now();
+
+      // Slots first, so that a woken tree already ticked on schedule is not ticked twice
+      worker.due.clear();
+      for (auto& hosted : incoming)
+      {
+        hosted->slot = now;
+        worker.due.push_back(hosted.get());
+        const auto id = hosted->id;
+        worker.trees.emplace(id, std::move(hosted));
+      }
+      incoming.clear();
+      worker.slots.advance(now);
+      for (const auto hosted : worker.due)
+      {
+        tick(worker, *hosted, true);
+      }
+
+      // Expired deadlines and asynchronous nodes (e.g. an action result) wake their nodes up,
+      // the parked trees whose wake up signal was emitted are ticked
+      worker.deadlines.poll();
+      if (worker.parked > 0)
+      {
+        for (const auto& [id, hosted] : worker.trees)
+        {
+          if (hosted->parked && hosted->tree.sleep(std::chrono::system_clock::duration::zero()))
+          {
+            woken.push_back(id);
+          }
+        }
+      }
+      for (const auto id : woken)
+      {
+        const auto found = worker.trees.find(id);
+        if (worker.trees.end() == found || found->second->done || worker.round == found->second->round)
+        {
+          continue;
+        }
+        auto& hosted = *found->second;
+        count(worker.stats.wake_ups);
+        if (hosted.parked)
+        {
+          worker.slots.cancel(hosted.timer);
+          tick(worker, hosted, true);
+        }
+        else
+        {
+          // Between two slots, the schedule is left untouched
+          tick(worker, hosted, false);
+        }
+      }
+      woken.clear();
+
+      std::erase_if(worker.trees, [](const auto& entry){ return entry.second->done; });
+    }
+
+    // Stopped, halt the trees still running
+    for (auto& [id, hosted] : worker.trees)
+    {
+      hosted->unsubscribe();
+      if (!hosted->done)
+      {
+        hosted->tree.haltTree();
+      }
+    }
+    worker.trees.clear();
+    {
+      // Not under the lock, a subscriber holds its waker while waking the worker up
+      std::lock_guard lock{worker.mutex};
+      incoming.insert(incoming.end(), std::make_move_iterator(worker.incoming.begin()),
+          std::make_move_iterator(worker.incoming.end()));
+      worker.incoming.clear();
+    }
+    for (auto& hosted : incoming)
+    {
+      hosted->unsubscribe();
+    }
+    incoming.clear();
+  }
+
+  void MultiTreeExecutor::tick(Worker& worker, Hosted& hosted, bool on_schedule)
+  {
+    hosted.round = worker.round;
+    const bool was_parked = hosted.parked;
+    hosted.parked = false;
+    if (was_parked)
+    {
+      --worker.parked;
+      // Back on schedule from now on
+      hosted.slot = Clock::now();
+    }
+
+    auto status = BT::NodeStatus::FAILURE;
+    auto& waker = *hosted.waker;
+    waker.changed.store(false, std::memory_order_relaxed);
+    waker.ticking.store(true, std::memory_order_release);
+    try
+    {
+      status = hosted.tree.tickOnce();
+    }
+    catch (const std::exception& error)
+    {
+      logError("MultiTreeExecutor: tree ", hosted.id, " failed: ", error.what());
+      hosted.tree.haltTree();
+    }
+    waker.ticking.store(false, std::memory_order_release);
+    count(worker.stats.ticks);
+    const auto end = Clock::now();
+
+    if (BT::NodeStatus::RUNNING != status)
+    {
+      complete(worker, hosted, status);
+      return;
+    }
+
+    // Only waiting on asynchronous nodes, until one of them wakes the tree up
+    if (!waker.changed.load(std::memory_order_relaxed) && hosted.options.idle_period > hosted.options.period)
+    {
+      worker.slots.cancel(hosted.timer);
+      hosted.parked = true;
+      ++worker.parked;
+      hosted.timer = worker.slots.schedule(end + hosted.options.idle_period,
+          [&worker, &hosted](){ worker.due.push_back(&hosted); });
+      if (!was_parked)
+      {
+        count(worker.stats.parked);
+      }
+      return;
+    }
+
+    // Event ticks happen between two slots and leave the schedule untouched
+    if (!on_schedule && !was_parked)
+    {
+      return;
+    }
+    // Next slot is always a multiple of the period from the first one
+    hosted.slot += hosted.options.period;
+    if (end > hosted.slot)
+    {
+      count(worker.stats.overruns);
+      // Tick right away on the latest slot that already passed
+      const auto missed = (end - hosted.slot) / hosted.options.period;
+      count(worker.stats.skipped, static_cast<std::uint64_t>(missed));
+      hosted.slot += hosted.options.period * missed;
+    }
+    worker.slots.cancel(hosted.timer);
+    hosted.timer = worker.slots.schedule(hosted.slot, [&worker, &hosted](){ worker.due.push_back(&hosted); });
+  }
+
+  void MultiTreeExecutor::complete(Worker& worker, Hosted& hosted, BT::NodeStatus status)
+  {
+    worker.slots.cancel(hosted.timer);
+    hosted.unsubscribe();
+    hosted.done = true;
+    worker.hosted.fetch_sub(1, std::memory_order_relaxed);
+    count(worker.stats.completed);
+    if (hosted.options.on_done)
+    {
+      hosted.options.on_done(hosted.id, status);
+    }
+
+    std::lock_guard lock{pending_mutex_};
+    if (0 == --pending_)
+    {
+      all_done_.notify_all();
+    }
+  }
+} // bt_ros
@@ -0,0 +1,142 @@
+#include "ros2-behaviortree/thread_pool_parallel_node.hpp"
+
+// STL
+#include <algorithm>
+
+namespace bt_ros
+{
+  ThreadPoolParallelNode::ThreadPoolParallelNode(const std::string& name, const BT::NodeConfig& config)
+    : ThreadPoolParallelNode(name, config, WorkStealingPool::shared())
+  {
+  }
+
+  ThreadPoolParallelNode::ThreadPoolParallelNode(const std::string& name, const BT::NodeConfig& config,
+      WorkStealingPool& pool)
+    : BT::ControlNode(name, config)
+    , pool_{pool}
+    , success_count_{0}
+    , failure_count_{0}
+    , skipped_count_{0}
+  {
+  }
+
+  BT::PortsList ThreadPoolParallelNode::providedPorts()
+  {
+    return { BT::InputPort<int>("success_count", -1,
+                 "number of children that need to succeed to trigger a SUCCESS"),
+             BT::InputPort<int>("failure_count", 1,
+                 "number of children that need to fail to trigger a FAILURE") };
+  }
+
+  BT::NodeStatus ThreadPoolParallelNode::tick()
+  {
+    const auto children_count = children_nodes_.size();
+    int success_threshold = -1;
+    int failure_threshold = 1;
+    getInput("success_count", success_threshold);
+    getInput("failure_count", failure_threshold);
+    const auto required_success = static_cast<std::size_t>(success_threshold < 0
+        ? std::max<int>(static_cast<int>(children_count) + success_threshold + 1, 0) : success_threshold);
+    const auto required_failure = static_cast<std::size_t>(failure_threshold < 0
+        ? std::max<int>(static_cast<int>(children_count) + failure_threshold + 1, 0) : failure_threshold);
+    if (children_count < required_success)
+    {
+      throw BT::LogicError("ThreadPoolParallel: success_count is larger than the number of children");
+    }
+    if (children_count < required_failure)
+    {
+      throw BT::LogicError("ThreadPoolParallel: failure_count is larger than the number of children");
+    }
+
+    if (BT::NodeStatus::IDLE == status())
+    {
+      clear();
+    }
+    setStatus(BT::NodeStatus::RUNNING);
+
+    const auto account = [this](std::size_t index, BT::NodeStatus child_status)
+      {
+        switch (child_status)
+        {
+          case BT::NodeStatus::SUCCESS:
+            completed_[index] = true;
+            ++success_count_;
+            break;
+          case BT::NodeStatus::FAILURE:
+            completed_[index] = true;
+            ++failure_count_;
+            break;
+          case BT::NodeStatus::SKIPPED:
+            completed_[index] = true;
+            ++skipped_count_;
+            break;
+          case BT::NodeStatus::RUNNING:
+            break;
+          case BT::NodeStatus::IDLE:
+            throw BT::LogicError("[", name(), "]: a child returned IDLE");
+        }
+      };
+
+    pooled_.clear();
+    for (std::size_t i = 0; i < children_count; ++i)
+    {
+      if (completed_[i])
+      {
+        continue;
+      }
+      if (dynamic_cast<BT::SyncActionNode*>(children_nodes_[i]))
+      {
+        pooled_.push_back(i);
+      }
+      else
+      {
+        account(i, children_nodes_[i]->executeTick());
+      }
+    }
+
+    pooled_status_.assign(pooled_.size(), BT::NodeStatus::IDLE);
+    pool_.parallelFor(pooled_.size(), [this](std::size_t job)
+        {
+          pooled_status_[job] = children_nodes_[pooled_[job]]->executeTick();
+        });
+    for (std::size_t job = 0; job < pooled_.size(); ++job)
+    {
+      account(pooled_[job], pooled_status_[job]);
+    }
+
+    if (skipped_count_ == children_count)
+    {
+      clear();
+      return BT::NodeStatus::SKIPPED;
+    }
+    if (success_count_ >= required_success ||
+        (success_threshold < 0 && success_count_ + skipped_count_ >= required_success))
+    {
+      clear();
+      resetChildren();
+      return BT::NodeStatus::SUCCESS;
+    }
+    // Fails once success is out of reach, or on enough failures
+    if (children_count - failure_count_ < required_success || failure_count_ >= required_failure)
+    {
+      clear();
+      resetChildren();
+      return BT::NodeStatus::FAILURE;
+    }
+    return BT::NodeStatus::RUNNING;
+  }
+
+  void ThreadPoolParallelNode::halt()
+  {
+    clear();
+    BT::ControlNode::halt();
+  }
+
+  void ThreadPoolParallelNode::clear()
+  {
+    completed_.assign(children_nodes_.size(), false);
+    success_count_ = 0;
+    failure_count_ = 0;
+    skipped_count_ = 0;
+  }
+} // bt_ros
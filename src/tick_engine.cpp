@@ -0,0 +1,118 @@
+#include "ros2-behaviortree/tick_engine.hpp"
+
+// STL
+#include <algorithm>
+
+namespace bt_ros
+{
+  TickEngine::TickEngine(BT::Tree& tree, std::chrono::nanoseconds period)
+    : tree_{tree}
+    , period_{period}
+    , deadlines_{nullptr}
+    , stop_requested_{false}
+  {
+    if (period_ <= std::chrono::nanoseconds::zero())
+    {
+      throw BT::RuntimeError("TickEngine: period must be positive");
+    }
+  }
+
+  BT::NodeStatus TickEngine::run(const std::function<bool()>& keep_running)
+  {
+    auto status = BT::NodeStatus::IDLE;
+    auto deadline = Clock::now();
+    bool woken = false;
+
+    while (!stop_requested_ && (!keep_running || keep_running()))
+    {
+      const auto start = Clock::now();
+      if (probe_)
+      {
+        if (const auto arrival = probe_())
+        {
+          const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(start - *arrival);
+          ++stats_.wake_ups;
+          stats_.total_wake_latency += latency;
+          stats_.max_wake_latency = std::max(stats_.max_wake_latency, latency);
+        }
+      }
+      status = tree_.tickOnce();
+      const auto end = Clock::now();
+
+      const auto tick_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+      ++stats_.ticks;
+      stats_.total_tick_time += tick_time;
+      stats_.max_tick_time = std::max(stats_.max_tick_time, tick_time);
+
+      if (BT::NodeStatus::RUNNING != status)
+      {
+        break;
+      }
+
+      // Event ticks happen between two slots and leave the schedule untouched
+      if (!woken)
+      {
+        const auto jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(start - deadline);
+        stats_.total_jitter += jitter;
+        stats_.max_jitter = std::max(stats_.max_jitter, jitter);
+
+        // Next slot is always a multiple of the period from the first one
+        deadline += period_;
+        if (end > deadline)
+        {
+          ++stats_.overruns;
+          // Tick right away on the latest slot that already passed
+          const auto missed = (end - deadline) / period_;
+          stats_.skipped += missed;
+          deadline += period_ * missed;
+        }
+      }
+      woken = sleepUntil(deadline);
+    }
+    return status;
+  }
+
+  bool TickEngine::sleepUntil(Clock::time_point deadline)
+  {
+    // The fired timers emitted the wake up signal of their node, consume it
+    // or tickOnce() sees it pending and ticks the tree a second time
+    const auto fired = [this]()
+      {
+        if (!deadlines_ || 0 == deadlines_->poll())
+        {
+          return false;
+        }
+        tree_.sleep(std::chrono::system_clock::duration::zero());
+        return true;
+      };
+
+    for (auto now = Clock::now(); now < deadline; now = Clock::now())
+    {
+      auto until = deadline;
+      if (deadlines_)
+      {
+        if (const auto next = deadlines_->nextExpiry())
+        {
+          until = std::min(until, *next);
+        }
+      }
+
+      // Tree::sleep() returns true when the wake up signal was emitted
+      bool signaled = false;
+      if (until > now)
+      {
+        signaled = tree_.sleep(std::chrono::duration_cast<std::chrono::system_clock::duration>(until - now));
+      }
+      if (fired())
+      {
+        return true;
+      }
+      if (signaled && probe_)
+      {
+        return true;
+      }
+    }
+    fired();
+    return false;
+  }
+} // bt_ros
@@ -0,0 +1,129 @@
+#include "ros2-behaviortree/tick_hooks.hpp"
+
+// STL
+#include <algorithm>
+#include <type_traits>
+
+namespace bt_ros
+{
+  namespace
+  {
+    // TreeNode::setTickMonitorCallback() exists from BT.CPP 4.x releases on,
+    // nothing of BT.CPP itself uses it
+    template <typename Node>
+    concept HasTickMonitor = requires(Node& node)
+    {
+      node.setTickMonitorCallback(nullptr);
+    };
+  } // anonymous namespace
+
+  TickHooks::TickHooks(const BT::Tree& tree)
+  {
+    for (const auto& subtree : tree.subtrees)
+    {
+      for (const auto& node : subtree->nodes)
+      {
+        nodes_.push_back(node.get());
+      }
+    }
+
+    // Generic, so that only the branch of the BT.CPP version in use is compiled
+    const auto attach = [this](auto& node)
+      {
+        using Node = std::remove_reference_t<decltype(node)>;
+        if constexpr (HasTickMonitor<Node>)
+        {
+          // Called right after tick(), before the node takes its new status
+          node.setTickMonitorCallback([this](BT::TreeNode& ticked, BT::NodeStatus status,
+                std::chrono::microseconds duration)
+              {
+                if (!listeners_.empty())
+                {
+                  const auto now = TickListener::Clock::now();
+                  tickStarted(ticked, now - duration);
+                  tickEnded(ticked, status, now);
+                }
+              });
+        }
+        else
+        {
+          // IDLE leaves the tick and its result untouched
+          node.setPreTickFunction([this](BT::TreeNode& ticked)
+              {
+                if (!listeners_.empty())
+                {
+                  tickStarted(ticked, TickListener::Clock::now());
+                }
+                return BT::NodeStatus::IDLE;
+              });
+          node.setPostTickFunction([this](BT::TreeNode& ticked, BT::NodeStatus status)
+              {
+                if (!listeners_.empty())
+                {
+                  tickEnded(ticked, status, TickListener::Clock::now());
+                }
+                return BT::NodeStatus::IDLE;
+              });
+        }
+      };
+    for (const auto node : nodes_)
+    {
+      attach(*node);
+    }
+  }
+
+  TickHooks::~TickHooks()
+  {
+    const auto detach = [](auto& node)
+      {
+        using Node = std::remove_reference_t<decltype(node)>;
+        if constexpr (HasTickMonitor<Node>)
+        {
+          node.setTickMonitorCallback({});
+        }
+        else
+        {
+          node.setPreTickFunction({});
+          node.setPostTickFunction({});
+        }
+      };
+    for (const auto node : nodes_)
+    {
+      detach(*node);
+    }
+  }
+
+  bool TickHooks::usesTickMonitor()
+  {
+    return HasTickMonitor<BT::TreeNode>;
+  }
+
+  void TickHooks::addListener(TickListener* listener)
+  {
+    if (listeners_.end() == std::find(listeners_.begin(), listeners_.end(), listener))
+    {
+      listeners_.push_back(listener);
+    }
+  }
+
+  void TickHooks::removeListener(TickListener* listener)
+  {
+    listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), listener), listeners_.end());
+  }
+
+  void TickHooks::tickStarted(const BT::TreeNode& node, TickListener::Clock::time_point time)
+  {
+    for (const auto listener : listeners_)
+    {
+      listener->onTickStart(node, time);
+    }
+  }
+
+  void TickHooks::tickEnded(const BT::TreeNode& node, BT::NodeStatus status, TickListener::Clock::time_point time)
+  {
+    for (const auto listener : listeners_)
+    {
+      listener->onTickEnd(node, status, time);
+    }
+  }
+} // bt_ros
@@ -0,0 +1,210 @@
+#include "ros2-behaviortree/tick_profiler.hpp"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace bt_ros
+{
+  namespace
+  {
+    TickProfiler::Latency summarize(const LatencyHistogram::Snapshot& snapshot)
+    {
+      return {snapshot.count, snapshot.percentile(0.5), snapshot.percentile(0.99), snapshot.max()};
+    }
+
+    void addValue(diagnostic_msgs::msg::DiagnosticStatus& status, const std::string& key, std::uint64_t value)
+    {
+      diagnostic_msgs::msg::KeyValue entry;
+      entry.key = key;
+      entry.value = std::to_string(value);
+      status.values.push_back(std::move(entry));
+    }
+
+    void addValue(diagnostic_msgs::msg::DiagnosticStatus& status, const std::string& key,
+        std::chrono::nanoseconds value)
+    {
+      char text[32];
+      std::snprintf(text, sizeof(text), "%.3f", static_cast<double>(value.count()) * 1e-3);
+      diagnostic_msgs::msg::KeyValue entry;
+      entry.key = key;
+      entry.value = text;
+      status.values.push_back(std::move(entry));
+    }
+
+    void addLatency(diagnostic_msgs::msg::DiagnosticStatus& status, const std::string& prefix,
+        const TickProfiler::Latency& latency)
+    {
+      addValue(status, prefix + "_count", latency.count);
+      addValue(status, prefix + "_p50_us", latency.p50);
+      addValue(status, prefix + "_p99_us", latency.p99);
+      addValue(status, prefix + "_max_us", latency.max);
+    }
+  } // anonymous namespace
+
+  std::uint64_t LatencyHistogram::bucketUpperBound(std::size_t bucket) noexcept
+  {
+    const std::uint64_t shift = bucket < 2 * SUB_BUCKET_COUNT ? 0 : bucket / SUB_BUCKET_COUNT - 1;
+    const auto lower = (bucket - shift * SUB_BUCKET_COUNT) << shift;
+    return lower + (std::uint64_t{1} << shift) - 1;
+  }
+
+  LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+  {
+    Snapshot result;
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+      result.counts[i] = counts_[i].load(std::memory_order_relaxed);
+      result.count += result.counts[i];
+    }
+    return result;
+  }
+
+  LatencyHistogram::Snapshot LatencyHistogram::Snapshot::since(const Snapshot& earlier) const
+  {
+    Snapshot result;
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+      // Unsigned: right across a wrap around
+      result.counts[i] = counts[i] - earlier.counts[i];
+      result.count += result.counts[i];
+    }
+    return result;
+  }
+
+  std::chrono::nanoseconds LatencyHistogram::Snapshot::percentile(double q) const
+  {
+    if (0 == count)
+    {
+      return std::chrono::nanoseconds{0};
+    }
+    const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count))));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+      seen += counts[i];
+      if (seen >= rank)
+      {
+        return std::chrono::nanoseconds{bucketUpperBound(i)};
+      }
+    }
+    return max();
+  }
+
+  std::chrono::nanoseconds LatencyHistogram::Snapshot::max() const
+  {
+    for (auto i = BUCKET_COUNT; i > 0; --i)
+    {
+      if (counts[i - 1])
+      {
+        return std::chrono::nanoseconds{bucketUpperBound(i - 1)};
+      }
+    }
+    return std::chrono::nanoseconds{0};
+  }
+
+  TickProfiler::TickProfiler(TickHooks& hooks)
+    : hooks_{hooks}
+  {
+    for (const auto node : hooks_.nodes())
+    {
+      if (states_.size() <= node->UID())
+      {
+        states_.resize(node->UID() + 1);
+      }
+      auto& state = states_[node->UID()];
+      state = std::make_unique<NodeState>();
+      state->node = node;
+      // A node reset to IDLE (halted, or by its parent once done) starts over at its next tick
+      state->reset_subscriber = node->subscribeToStatusChange(
+          [last_status = &state->last_status](BT::TimePoint, const BT::TreeNode&, BT::NodeStatus,
+            BT::NodeStatus status)
+          {
+            if (BT::NodeStatus::IDLE == status)
+            {
+              last_status->store(BT::NodeStatus::IDLE, std::memory_order_relaxed);
+            }
+          });
+    }
+    hooks_.addListener(this);
+  }
+
+  TickProfiler::~TickProfiler()
+  {
+    hooks_.removeListener(this);
+  }
+
+  void TickProfiler::onTickStart(const BT::TreeNode& node, Clock::time_point time)
+  {
+    auto& state = *states_[node.UID()];
+    state.tick_start = time;
+    // Not node.status(): with the tick monitor, control nodes and decorators already set
+    // themselves RUNNING inside the tick being reported
+    state.from_running = BT::NodeStatus::RUNNING == state.last_status.load(std::memory_order_relaxed);
+    state.ticking = true;
+  }
+
+  void TickProfiler::onTickEnd(const BT::TreeNode& node, BT::NodeStatus status, Clock::time_point time)
+  {
+    auto& state = *states_[node.UID()];
+    state.last_status.store(status, std::memory_order_relaxed);
+    if (!state.ticking)
+    {
+      // Replaced by a precondition, tick() did not run
+      return;
+    }
+    state.ticking = false;
+    (state.from_running ? state.running : state.start).record(time - state.tick_start);
+  }
+
+  std::vector<TickProfiler::NodeLatency> TickProfiler::collect()
+  {
+    std::vector<NodeLatency> result;
+    for (const auto& state : states_)
+    {
+      if (!state)
+      {
+        continue;
+      }
+      const auto start = state->start.snapshot();
+      const auto running = state->running.snapshot();
+      const auto new_start = start.since(state->collected_start);
+      const auto new_running = running.since(state->collected_running);
+      state->collected_start = start;
+      state->collected_running = running;
+      if (new_start.count || new_running.count)
+      {
+        result.push_back(NodeLatency{state->node->UID(), state->node->fullPath(), state->node->registrationName(),
+            summarize(new_start), summarize(new_running)});
+      }
+    }
+    return result;
+  }
+
+  TickProfilePublisher::TickProfilePublisher(rclcpp::Node& node, TickProfiler& profiler,
+      std::chrono::nanoseconds period, const std::string& topic)
+    : profiler_{profiler}
+    , clock_{node.get_clock()}
+    , publisher_{node.create_publisher<diagnostic_msgs::msg::DiagnosticArray>(topic, 5)}
+    , timer_{node.create_wall_timer(period, [this](){ publish(); })}
+  {
+  }
+
+  void TickProfilePublisher::publish()
+  {
+    diagnostic_msgs::msg::DiagnosticArray message;
+    message.header.stamp = clock_->now();
+    for (const auto& latency : profiler_.collect())
+    {
+      diagnostic_msgs::msg::DiagnosticStatus status;
+      status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+      status.name = latency.path;
+      status.hardware_id = latency.registration_name;
+      addLatency(status, "start", latency.start);
+      addLatency(status, "running", latency.running);
+      message.status.push_back(std::move(status));
+    }
+    publisher_->publish(message);
+  }
+} // bt_ros
@@ -0,0 +1,245 @@
+#include "ros2-behaviortree/timer_wheel.hpp"
+
+// STL
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+namespace bt_ros
+{
+  TimerWheel::TimerWheel(std::chrono::nanoseconds resolution, Clock::time_point start)
+    : resolution_{resolution}
+    , start_{start}
+    , current_{0}
+    , size_{0}
+  {
+    if (resolution_ <= std::chrono::nanoseconds::zero())
+    {
+      throw std::invalid_argument("TimerWheel: resolution must be positive");
+    }
+    heads_.fill(NIL);
+    occupied_.fill(0);
+  }
+
+  TimerWheel::Handle TimerWheel::schedule(Clock::time_point deadline, Callback callback)
+  {
+    std::uint32_t index;
+    if (free_.empty())
+    {
+      index = static_cast<std::uint32_t>(entries_.size());
+      entries_.emplace_back();
+    }
+    else
+    {
+      index = free_.back();
+      free_.pop_back();
+    }
+
+    auto& entry = entries_[index];
+    entry.callback = std::move(callback);
+    entry.expiry = toTick(deadline);
+    entry.active = true;
+    insert(index, current_ + 1);
+    ++size_;
+    return {index, entry.generation};
+  }
+
+  bool TimerWheel::cancel(Handle handle)
+  {
+    if (handle.index >= entries_.size())
+    {
+      return false;
+    }
+    auto& entry = entries_[handle.index];
+    if (!entry.active || entry.generation != handle.generation)
+    {
+      return false;
+    }
+    unlink(handle.index);
+    entry.active = false;
+    entry.callback = nullptr;
+    ++entry.generation;
+    free_.push_back(handle.index);
+    --size_;
+    return true;
+  }
+
+  std::size_t TimerWheel::advance(Clock::time_point now)
+  {
+    const auto target = (now > start_) ? static_cast<std::uint64_t>((now - start_) / resolution_) : 0;
+    std::size_t fired = 0;
+    while (current_ < target)
+    {
+      // Jump straight to the next tick with something to fire or cascade
+      const auto next = nextEventTick();
+      if (!next || *next > target)
+      {
+        current_ = target;
+        break;
+      }
+      current_ = *next;
+      fired += processTick(current_);
+    }
+    return fired;
+  }
+
+  std::optional<TimerWheel::Clock::time_point> TimerWheel::nextExpiry() const
+  {
+    if (const auto tick = nextEventTick())
+    {
+      return start_ + resolution_ * static_cast<std::int64_t>(*tick);
+    }
+    return {};
+  }
+
+  std::optional<std::uint64_t> TimerWheel::nextEventTick() const
+  {
+    std::optional<std::uint64_t> next;
+    for (unsigned level = 0; level < LEVELS; ++level)
+    {
+      if (0 == occupied_[level])
+      {
+        continue;
+      }
+      // Each level is a ring starting right after its current slot
+      const unsigned shift = level * SLOT_BITS;
+      const auto position = (current_ >> shift) & SLOT_MASK;
+      const auto after = std::rotr(occupied_[level], static_cast<int>((position + 1) & SLOT_MASK));
+      const auto distance = static_cast<std::uint64_t>(std::countr_zero(after)) + 1;
+      // Tick at which that slot fires (level 0) or cascades (upper levels)
+      const auto tick = ((current_ >> shift) + distance) << shift;
+      if (!next || tick < *next)
+      {
+        next = tick;
+      }
+    }
+    return next;
+  }
+
+  std::uint64_t TimerWheel::toTick(Clock::time_point time) const
+  {
+    if (time <= start_)
+    {
+      return 0;
+    }
+    // Round up, a timer must not fire before its deadline
+    const auto elapsed = time - start_;
+    return static_cast<std::uint64_t>((elapsed + resolution_ - std::chrono::nanoseconds(1)) / resolution_);
+  }
+
+  void TimerWheel::insert(std::uint32_t index, std::uint64_t base)
+  {
+    // base is the next tick to be processed, overdue timers fire on it
+    auto& entry = entries_[index];
+    auto expiry = std::max(entry.expiry, base);
+    const auto horizon = std::uint64_t{1} << (LEVELS * SLOT_BITS);
+    if (expiry - base >= horizon)
+    {
+      expiry = base + horizon - 1;
+    }
+
+    // A timer at level n is cascaded down when the wheel reaches the start of
+    // its level n slot, which always lies after base for delta >= 64^n
+    unsigned level = 0;
+    while (level + 1 < LEVELS && (expiry - base) >= (std::uint64_t{1} << ((level + 1) * SLOT_BITS)))
+    {
+      ++level;
+    }
+    const auto slot = static_cast<unsigned>((expiry >> (level * SLOT_BITS)) & SLOT_MASK);
+    const auto key = static_cast<std::uint16_t>(level * SLOTS + slot);
+
+    entry.slot = key;
+    entry.prev = NIL;
+    entry.next = heads_[key];
+    if (NIL != entry.next)
+    {
+      entries_[entry.next].prev = index;
+    }
+    heads_[key] = index;
+    occupied_[level] |= std::uint64_t{1} << slot;
+  }
+
+  void TimerWheel::unlink(std::uint32_t index)
+  {
+    auto& entry = entries_[index];
+    if (NIL != entry.prev)
+    {
+      entries_[entry.prev].next = entry.next;
+    }
+    else
+    {
+      heads_[entry.slot] = entry.next;
+    }
+    if (NIL != entry.next)
+    {
+      entries_[entry.next].prev = entry.prev;
+    }
+    if (FIRING != entry.slot && NIL == heads_[entry.slot])
+    {
+      occupied_[entry.slot / SLOTS] &= ~(std::uint64_t{1} << (entry.slot % SLOTS));
+    }
+    entry.prev = NIL;
+    entry.next = NIL;
+  }
+
+  void TimerWheel::cascade(unsigned level, unsigned slot, std::uint64_t tick)
+  {
+    const auto key = level * SLOTS + slot;
+    auto index = heads_[key];
+    heads_[key] = NIL;
+    occupied_[level] &= ~(std::uint64_t{1} << slot);
+    while (NIL != index)
+    {
+      const auto next = entries_[index].next;
+      insert(index, tick);
+      index = next;
+    }
+  }
+
+  std::size_t TimerWheel::processTick(std::uint64_t tick)
+  {
+    // Cascade the upper levels whose slot boundary is reached, highest first
+    unsigned top = 0;
+    while (top + 1 < LEVELS && 0 == (tick & ((std::uint64_t{1} << ((top + 1) * SLOT_BITS)) - 1)))
+    {
+      ++top;
+    }
+    for (unsigned level = top; level > 0; --level)
+    {
+      cascade(level, static_cast<unsigned>((tick >> (level * SLOT_BITS)) & SLOT_MASK), tick);
+    }
+
+    // Move the slot to the firing list first: callbacks may schedule new
+    // timers in this slot, or cancel timers of the list not fired yet
+    const auto key = static_cast<unsigned>(tick & SLOT_MASK);
+    heads_[FIRING] = heads_[key];
+    heads_[key] = NIL;
+    occupied_[0] &= ~(std::uint64_t{1} << key);
+    for (auto index = heads_[FIRING]; NIL != index; index = entries_[index].next)
+    {
+      entries_[index].slot = FIRING;
+    }
+
+    std::size_t fired = 0;
+    while (NIL != heads_[FIRING])
+    {
+      const auto index = heads_[FIRING];
+      unlink(index);
+      auto& entry = entries_[index];
+      auto callback = std::move(entry.callback);
+      entry.callback = nullptr;
+      entry.active = false;
+      ++entry.generation;
+      free_.push_back(index);
+      --size_;
+      ++fired;
+      // entry may dangle from here, callbacks can grow entries_
+      if (callback)
+      {
+        callback();
+      }
+    }
+    return fired;
+  }
+} // bt_ros
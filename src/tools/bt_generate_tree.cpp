@@ -0,0 +1,62 @@
+/**
+ * bt_generate_tree
+ * Writes the XML of a synthetic tree (bt_ros::generateTree) to stdout.
+ *
+ *   bt_generate_tree [--depth N] [--fan-out N] [--subtree-every N] [--remap-density X] [--keys N]
+ *
+ * The nodes it uses are registered by bt_ros::registerGeneratedNodes().
+ */
+
+// STL
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "ros2-behaviortree/tree_generator.hpp"
+
+int main(int argc, char* argv[])
+{
+  bt_ros::TreeShape shape;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string argument = argv[i];
+    if (i + 1 >= argc)
+    {
+      std::cerr << "usage: bt_generate_tree [--depth N] [--fan-out N] [--subtree-every N]"
+          " [--remap-density X] [--keys N]" << std::endl;
+      return EXIT_FAILURE;
+    }
+    const char* value = argv[++i];
+    if ("--depth" == argument)
+    {
+      shape.depth = std::strtoull(value, nullptr, 10);
+    }
+    else if ("--fan-out" == argument)
+    {
+      shape.fan_out = std::strtoull(value, nullptr, 10);
+    }
+    else if ("--subtree-every" == argument)
+    {
+      shape.subtree_every = std::strtoull(value, nullptr, 10);
+    }
+    else if ("--remap-density" == argument)
+    {
+      shape.remap_density = std::atof(value);
+    }
+    else if ("--keys" == argument)
+    {
+      shape.blackboard_keys = std::strtoull(value, nullptr, 10);
+    }
+    else
+    {
+      std::cerr << "unknown option " << argument << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  const auto tree = bt_ros::generateTree(shape);
+  std::cout << tree.xml;
+  std::cerr << tree.nodes << " nodes, " << tree.leaves << " leaves, " << tree.subtree_instances
+      << " subtree instances" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,202 @@
+/**
+ * bt_replay
+ * Offline reader of the recordings written by bt_ros::TransitionRecorder.
+ *
+ *   bt_replay <recording> [replay|summary] [--last N] [--node <path part>]
+ *
+ * replay prints the transitions in order, with their time since the start
+ * of the recording; summary prints, per node, the number of transitions,
+ * of SUCCESS and FAILURE, and how long the node stayed RUNNING.
+ */
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ros2-behaviortree/transition_recorder.hpp"
+
+namespace
+{
+  struct Options
+  {
+    std::string path;
+    std::string mode = "replay";
+    std::size_t last = 0;
+    std::string node_filter;
+  };
+
+  void printUsage()
+  {
+    std::cerr << "usage: bt_replay <recording> [replay|summary] [--last N] [--node <path part>]" << std::endl;
+  }
+
+  bool parseArguments(int argc, char* argv[], Options& options)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      const std::string argument = argv[i];
+      if ("--last" == argument && i + 1 < argc)
+      {
+        options.last = std::strtoull(argv[++i], nullptr, 10);
+      }
+      else if ("--node" == argument && i + 1 < argc)
+      {
+        options.node_filter = argv[++i];
+      }
+      else if ("replay" == argument || "summary" == argument)
+      {
+        options.mode = argument;
+      }
+      else if (options.path.empty() && !argument.empty() && '-' != argument.front())
+      {
+        options.path = argument;
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return !options.path.empty();
+  }
+
+  std::string statusName(std::uint8_t status)
+  {
+    return BT::toStr(static_cast<BT::NodeStatus>(status));
+  }
+
+  double seconds(std::uint64_t nanoseconds)
+  {
+    return static_cast<double>(nanoseconds) * 1e-9;
+  }
+
+  void printHeader(const bt_ros::TransitionRecording& recording)
+  {
+    const auto start = std::chrono::system_clock::to_time_t(recording.startSystemTime());
+    char date[64];
+    std::strftime(date, sizeof(date), "%F %T", std::localtime(&start));
+    std::cout << "recording started " << date << ", " << recording.nodes().size() << " nodes, "
+        << recording.recorded() << " transitions (" << recording.overwritten() << " overwritten)" << std::endl;
+  }
+
+  void replay(const bt_ros::TransitionRecording& recording, const std::vector<bt_ros::TransitionRecord>& transitions)
+  {
+    for (const auto& transition : transitions)
+    {
+      const auto node = recording.node(transition.uid);
+      char time[32];
+      std::snprintf(time, sizeof(time), "%14.6f",
+          seconds(transition.timestamp_ns - std::min(transition.timestamp_ns, recording.startSteadyTime())));
+      std::cout << time << "  [" << (node ? node->path : "UID " + std::to_string(transition.uid)) << "] "
+          << statusName(transition.previous_status) << " -> " << statusName(transition.status) << std::endl;
+    }
+  }
+
+  void summary(const bt_ros::TransitionRecording& recording, const std::vector<bt_ros::TransitionRecord>& transitions)
+  {
+    struct Statistics
+    {
+      std::uint64_t transitions = 0;
+      std::uint64_t success = 0;
+      std::uint64_t failure = 0;
+      std::uint64_t runs = 0;
+      std::uint64_t running_ns = 0;
+      std::uint64_t longest_run_ns = 0;
+      std::uint64_t running_since = 0;
+      bool running = false;
+    };
+
+    std::map<std::uint16_t, Statistics> statistics;
+    for (const auto& transition : transitions)
+    {
+      auto& node = statistics[transition.uid];
+      ++node.transitions;
+      const auto status = static_cast<BT::NodeStatus>(transition.status);
+      node.success += BT::NodeStatus::SUCCESS == status;
+      node.failure += BT::NodeStatus::FAILURE == status;
+      if (BT::NodeStatus::RUNNING == status)
+      {
+        node.running = true;
+        node.running_since = transition.timestamp_ns;
+      }
+      else if (node.running)
+      {
+        const auto duration = transition.timestamp_ns - node.running_since;
+        node.running = false;
+        ++node.runs;
+        node.running_ns += duration;
+        node.longest_run_ns = std::max(node.longest_run_ns, duration);
+      }
+    }
+
+    std::cout << "     T      S      F   runs  mean RUNNING [ms]  max RUNNING [ms]  node" << std::endl;
+    for (const auto& [uid, node] : statistics)
+    {
+      const auto info = recording.node(uid);
+      char line[128];
+      std::snprintf(line, sizeof(line), "%6llu %6llu %6llu %6llu %18.3f %17.3f  ",
+          static_cast<unsigned long long>(node.transitions), static_cast<unsigned long long>(node.success),
+          static_cast<unsigned long long>(node.failure), static_cast<unsigned long long>(node.runs),
+          node.runs ? seconds(node.running_ns) * 1e3 / static_cast<double>(node.runs) : 0.0,
+          seconds(node.longest_run_ns) * 1e3);
+      std::cout << line << (info ? info->path + " (" + info->registration_name + ")" : "UID " + std::to_string(uid))
+          << std::endl;
+    }
+  }
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  if (!parseArguments(argc, argv, options))
+  {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  try
+  {
+    const bt_ros::TransitionRecording recording{options.path};
+
+    std::vector<bt_ros::TransitionRecord> transitions;
+    for (const auto& transition : recording.transitions())
+    {
+      const auto node = recording.node(transition.uid);
+      if (options.node_filter.empty() || (node && std::string::npos != node->path.find(options.node_filter)))
+      {
+        transitions.push_back(transition);
+      }
+    }
+    if (options.last && transitions.size() > options.last)
+    {
+      transitions.erase(transitions.begin(), transitions.end() - static_cast<std::ptrdiff_t>(options.last));
+    }
+
+    printHeader(recording);
+    if ("summary" == options.mode)
+    {
+      summary(recording, transitions);
+    }
+    else
+    {
+      replay(recording, transitions);
+    }
+  }
+  catch (const BT::RuntimeError& error)
+  {
+    std::cerr << error.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,332 @@
+#include "ros2-behaviortree/transition_recorder.hpp"
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <utility>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bt_ros
+{
+  namespace
+  {
+    constexpr char MAGIC[4] = {'B', 'T', 'T', 'R'};
+    constexpr std::uint32_t VERSION = 1;
+
+    // Start of the file, followed by the node table then the records
+    struct FileHeader
+    {
+      char magic[4];
+      std::uint32_t version;
+      std::uint64_t capacity;
+      std::uint64_t node_count;
+      std::uint64_t records_offset;
+      std::uint64_t start_steady_ns;
+      std::int64_t start_system_ns;
+      // Index of the next record, incremented by the recorder
+      std::uint64_t next;
+      std::uint64_t reserved;
+    };
+    static_assert(64 == sizeof(FileHeader));
+
+    // One per node, followed by the path then the registration name, padded to 8 bytes
+    struct NodeEntry
+    {
+      std::uint16_t uid;
+      std::uint16_t path_length;
+      std::uint16_t name_length;
+      std::uint16_t reserved;
+    };
+    static_assert(8 == sizeof(NodeEntry));
+
+    constexpr std::size_t align(std::size_t size, std::size_t alignment)
+    {
+      return (size + alignment - 1) / alignment * alignment;
+    }
+
+    std::size_t entrySize(const BT::TreeNode& node)
+    {
+      return align(sizeof(NodeEntry) + node.fullPath().size() + node.registrationName().size(), 8);
+    }
+
+    std::uint64_t nanoseconds(std::chrono::nanoseconds duration)
+    {
+      return static_cast<std::uint64_t>(duration.count());
+    }
+
+    // Closes the descriptor on every path out of a constructor
+    struct FileDescriptor
+    {
+      int fd;
+      ~FileDescriptor()
+      {
+        if (fd >= 0)
+        {
+          ::close(fd);
+        }
+      }
+    };
+
+    // Unmaps on every path out of a constructor, until released
+    struct Mapping
+    {
+      void* address;
+      std::size_t size;
+      ~Mapping()
+      {
+        if (MAP_FAILED != address)
+        {
+          ::munmap(address, size);
+        }
+      }
+      void* release()
+      {
+        return std::exchange(address, MAP_FAILED);
+      }
+    };
+  } // anonymous namespace
+
+  TransitionRecorder::TransitionRecorder(const BT::Tree& tree, const std::string& path, std::size_t capacity)
+    : mapping_{MAP_FAILED}
+    , mapping_size_{0}
+    , next_{nullptr}
+    , records_{nullptr}
+    , mask_{std::bit_ceil(std::max<std::size_t>(capacity, 1)) - 1}
+  {
+    std::vector<BT::TreeNode*> nodes;
+    for (const auto& subtree : tree.subtrees)
+    {
+      for (const auto& node : subtree->nodes)
+      {
+        nodes.push_back(node.get());
+      }
+    }
+
+    std::size_t table_size = 0;
+    for (const auto node : nodes)
+    {
+      table_size += entrySize(*node);
+    }
+    const auto records_offset = align(sizeof(FileHeader) + table_size, 64);
+    mapping_size_ = records_offset + (mask_ + 1) * sizeof(TransitionRecord);
+
+    FileDescriptor file{::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+    if (file.fd < 0)
+    {
+      throw BT::RuntimeError("TransitionRecorder: cannot create [", path, "]: ", std::strerror(errno));
+    }
+    if (0 != ::ftruncate(file.fd, static_cast<off_t>(mapping_size_)))
+    {
+      throw BT::RuntimeError("TransitionRecorder: cannot size [", path, "]: ", std::strerror(errno));
+    }
+    Mapping mapping{::mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, 0), mapping_size_};
+    if (MAP_FAILED == mapping.address)
+    {
+      throw BT::RuntimeError("TransitionRecorder: cannot map [", path, "]: ", std::strerror(errno));
+    }
+
+    auto base = static_cast<std::byte*>(mapping.address);
+    auto header = new (base) FileHeader{};
+    std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    header->version = VERSION;
+    header->capacity = mask_ + 1;
+    header->node_count = nodes.size();
+    header->records_offset = records_offset;
+    header->start_steady_ns = nanoseconds(std::chrono::steady_clock::now().time_since_epoch());
+    header->start_system_ns = static_cast<std::int64_t>(
+        nanoseconds(std::chrono::system_clock::now().time_since_epoch()));
+
+    auto out = base + sizeof(FileHeader);
+    for (const auto node : nodes)
+    {
+      const auto& node_path = node->fullPath();
+      const auto& name = node->registrationName();
+      const NodeEntry entry{node->UID(), static_cast<std::uint16_t>(node_path.size()),
+          static_cast<std::uint16_t>(name.size()), 0};
+      std::memcpy(out, &entry, sizeof(entry));
+      std::memcpy(out + sizeof(entry), node_path.data(), node_path.size());
+      std::memcpy(out + sizeof(entry) + node_path.size(), name.data(), name.size());
+      out += entrySize(*node);
+    }
+
+    next_ = &header->next;
+    records_ = reinterpret_cast<TransitionRecord*>(base + records_offset);
+
+    try
+    {
+      subscribers_.reserve(nodes.size());
+      for (const auto node : nodes)
+      {
+        subscribers_.push_back(node->subscribeToStatusChange(
+            [this](BT::TimePoint, const BT::TreeNode& changed, BT::NodeStatus previous, BT::NodeStatus status)
+            {
+              record(changed, previous, status);
+            }));
+      }
+    }
+    catch (...)
+    {
+      // Unsubscribe before the records are unmapped
+      subscribers_.clear();
+      throw;
+    }
+    mapping_ = mapping.release();
+  }
+
+  TransitionRecorder::~TransitionRecorder()
+  {
+    // Unsubscribe before the records go away
+    subscribers_.clear();
+    if (MAP_FAILED != mapping_)
+    {
+      ::munmap(mapping_, mapping_size_);
+    }
+  }
+
+  void TransitionRecorder::sync()
+  {
+    ::msync(mapping_, mapping_size_, MS_ASYNC);
+  }
+
+  std::uint64_t TransitionRecorder::recorded() const
+  {
+    return std::atomic_ref<std::uint64_t>{*next_}.load(std::memory_order_relaxed);
+  }
+
+  void TransitionRecorder::record(const BT::TreeNode& node, BT::NodeStatus previous, BT::NodeStatus status) noexcept
+  {
+    const auto now = nanoseconds(std::chrono::steady_clock::now().time_since_epoch());
+    // Nodes of a Parallel running on several threads may change at the same time
+    const auto index = std::atomic_ref<std::uint64_t>{*next_}.fetch_add(1, std::memory_order_relaxed);
+    records_[index & mask_] = TransitionRecord{now, static_cast<std::uint32_t>(index), node.UID(),
+        static_cast<std::uint8_t>(previous), static_cast<std::uint8_t>(status)};
+  }
+
+  TransitionRecording::TransitionRecording(const std::string& path)
+  {
+    FileDescriptor file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (file.fd < 0)
+    {
+      throw BT::RuntimeError("TransitionRecording: cannot read [", path, "]: ", std::strerror(errno));
+    }
+    struct stat info;
+    if (0 != ::fstat(file.fd, &info) || info.st_size < static_cast<off_t>(sizeof(FileHeader)))
+    {
+      throw BT::RuntimeError("TransitionRecording: [", path, "] is not a transition recording");
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    const Mapping mapping{::mmap(nullptr, size, PROT_READ, MAP_SHARED, file.fd, 0), size};
+    if (MAP_FAILED == mapping.address)
+    {
+      throw BT::RuntimeError("TransitionRecording: cannot map [", path, "]: ", std::strerror(errno));
+    }
+    // Copied out, the mapping is released once read
+    const auto base = static_cast<const std::byte*>(mapping.address);
+    std::string error;
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (0 != std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) || VERSION != header.version)
+    {
+      error = "is not a transition recording";
+    }
+    else if (!std::has_single_bit(header.capacity) || header.records_offset > size ||
+             (size - header.records_offset) / sizeof(TransitionRecord) < header.capacity)
+    {
+      error = "is truncated";
+    }
+    else
+    {
+      auto in = base + sizeof(FileHeader);
+      const auto end = base + header.records_offset;
+      for (std::uint64_t i = 0; i < header.node_count && error.empty(); ++i)
+      {
+        NodeEntry entry;
+        if (end - in < static_cast<std::ptrdiff_t>(sizeof(entry)))
+        {
+          error = "has a damaged node table";
+          break;
+        }
+        std::memcpy(&entry, in, sizeof(entry));
+        const auto entry_size = align(sizeof(entry) + entry.path_length + entry.name_length, 8);
+        if (end - in < static_cast<std::ptrdiff_t>(entry_size))
+        {
+          error = "has a damaged node table";
+          break;
+        }
+        const auto text = reinterpret_cast<const char*>(in + sizeof(entry));
+        node_index_.emplace(entry.uid, nodes_.size());
+        nodes_.push_back(Node{entry.uid, std::string(text, entry.path_length),
+            std::string(text + entry.path_length, entry.name_length)});
+        in += entry_size;
+      }
+
+      // The recorder may still be running: read `next` once, then keep the slots holding the index they should
+      recorded_ = std::atomic_ref<std::uint64_t>{
+          *const_cast<std::uint64_t*>(reinterpret_cast<const std::uint64_t*>(base + offsetof(FileHeader, next)))}
+          .load(std::memory_order_acquire);
+      const auto records = reinterpret_cast<const TransitionRecord*>(base + header.records_offset);
+      const auto first = recorded_ - std::min(recorded_, header.capacity);
+      transitions_.reserve(recorded_ - first);
+      for (auto index = first; index < recorded_; ++index)
+      {
+        const auto& record = records[index & (header.capacity - 1)];
+        if (static_cast<std::uint32_t>(index) == record.sequence)
+        {
+          transitions_.push_back(record);
+        }
+      }
+    }
+    if (!error.empty())
+    {
+      throw BT::RuntimeError("TransitionRecording: [", path, "] ", error);
+    }
+    start_steady_ns_ = header.start_steady_ns;
+    start_system_ns_ = header.start_system_ns;
+  }
+
+  const std::vector<TransitionRecording::Node>& TransitionRecording::nodes() const
+  {
+    return nodes_;
+  }
+
+  const TransitionRecording::Node* TransitionRecording::node(std::uint16_t uid) const
+  {
+    const auto it = node_index_.find(uid);
+    return node_index_.end() == it ? nullptr : &nodes_[it->second];
+  }
+
+  const std::vector<TransitionRecord>& TransitionRecording::transitions() const
+  {
+    return transitions_;
+  }
+
+  std::uint64_t TransitionRecording::recorded() const
+  {
+    return recorded_;
+  }
+
+  std::uint64_t TransitionRecording::overwritten() const
+  {
+    return recorded_ - std::min<std::uint64_t>(recorded_, transitions_.size());
+  }
+
+  std::uint64_t TransitionRecording::startSteadyTime() const
+  {
+    return start_steady_ns_;
+  }
+
+  std::chrono::system_clock::time_point TransitionRecording::startSystemTime() const
+  {
+    return std::chrono::system_clock::time_point{
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{start_system_ns_})};
+  }
+} // bt_ros
@@ -0,0 +1,113 @@
+#include "ros2-behaviortree/tree_arena.hpp"
+
+// STL
+#include <algorithm>
+
+namespace bt_ros
+{
+  namespace
+  {
+    thread_local TreeArena* active_arena = nullptr;
+
+    // Stored right before each ArenaAllocated object
+    struct alignas(std::max_align_t) AllocationHeader
+    {
+      bool from_arena;
+    };
+
+    std::size_t headerSize(std::size_t alignment)
+    {
+      // Powers of two: the object stays aligned after the header
+      return std::max(alignment, sizeof(AllocationHeader));
+    }
+
+    AllocationHeader& headerOf(void* ptr)
+    {
+      return *(static_cast<AllocationHeader*>(ptr) - 1);
+    }
+
+    void* allocateObject(std::size_t size, std::size_t alignment)
+    {
+      alignment = std::max(alignment, alignof(AllocationHeader));
+      const auto header_size = headerSize(alignment);
+      void* block = nullptr;
+      if (active_arena)
+      {
+        block = active_arena->allocate(header_size + size, alignment);
+      }
+      else if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+      {
+        block = ::operator new(header_size + size, std::align_val_t{alignment});
+      }
+      else
+      {
+        block = ::operator new(header_size + size);
+      }
+      void* object = static_cast<std::byte*>(block) + header_size;
+      headerOf(object).from_arena = nullptr != active_arena;
+      return object;
+    }
+
+    void deallocateObject(void* ptr, std::size_t alignment) noexcept
+    {
+      if (!ptr || headerOf(ptr).from_arena)
+      {
+        // Given back with its arena
+        return;
+      }
+      alignment = std::max(alignment, alignof(AllocationHeader));
+      void* block = static_cast<std::byte*>(ptr) - headerSize(alignment);
+      if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+      {
+        ::operator delete(block, std::align_val_t{alignment});
+      }
+      else
+      {
+        ::operator delete(block);
+      }
+    }
+  } // anonymous namespace
+
+  TreeArena::TreeArena(std::size_t initial_size)
+    : resource_{initial_size}
+    , used_{0}
+  {
+  }
+
+  void* TreeArena::allocate(std::size_t size, std::size_t alignment)
+  {
+    used_ += size;
+    return resource_.allocate(size, alignment);
+  }
+
+  ArenaScope::ArenaScope(TreeArena& arena)
+    : previous_{active_arena}
+  {
+    active_arena = &arena;
+  }
+
+  ArenaScope::~ArenaScope()
+  {
+    active_arena = previous_;
+  }
+
+  void* ArenaAllocated::operator new(std::size_t size)
+  {
+    return allocateObject(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+  }
+
+  void* ArenaAllocated::operator new(std::size_t size, std::align_val_t alignment)
+  {
+    return allocateObject(size, static_cast<std::size_t>(alignment));
+  }
+
+  void ArenaAllocated::operator delete(void* ptr, std::size_t) noexcept
+  {
+    deallocateObject(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+  }
+
+  void ArenaAllocated::operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept
+  {
+    deallocateObject(ptr, static_cast<std::size_t>(alignment));
+  }
+} // bt_ros
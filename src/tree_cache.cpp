@@ -0,0 +1,1468 @@
+#include "ros2-behaviortree/tree_cache.hpp"
+
+// BT
+#include <behaviortree_cpp/xml_parsing.h>
+
+// XML
+#include <tinyxml2.h>
+
+// STL
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bt_ros
+{
+  namespace
+  {
+    constexpr char MAGIC[4] = {'B', 'T', 'R', 'C'};
+    constexpr std::uint32_t FORMAT_VERSION = 3;
+    constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+    // Header flags
+    // The XML uses constructs the cache does not model, trees are built by BT::XMLParser
+    constexpr std::uint32_t NEEDS_PARSER = 1u << 0;
+
+    // Cache file records, native endianness. Sections follow the header in
+    // this order, each one starting on a multiple of 8 bytes.
+    struct Header
+    {
+      char magic[4];
+      std::uint32_t version;
+      std::uint32_t source_count;
+      std::uint32_t input_count;  // the first sources are the files given to load()
+      std::uint32_t tree_count;
+      std::uint32_t node_count;
+      std::uint32_t attribute_count;
+      std::uint32_t child_count;
+      std::uint32_t string_count;
+      std::uint32_t string_bytes;
+      std::uint32_t main_tree;  // string index or NONE
+      std::uint32_t flags;
+    };
+
+    struct SourceRecord
+    {
+      std::uint64_t hash;
+      std::int64_t mtime;  // nanoseconds
+      std::uint64_t size;
+      std::uint32_t path;
+      std::uint32_t reserved;
+    };
+
+    struct TreeRecord
+    {
+      std::uint32_t id;
+      std::uint32_t root;  // node index or NONE
+    };
+
+    // One XML element, its attributes and children are contiguous ranges
+    struct NodeRecord
+    {
+      std::uint32_t tag;
+      std::uint32_t first_attribute;
+      std::uint32_t attribute_count;
+      std::uint32_t first_child;
+      std::uint32_t child_count;
+    };
+
+    struct AttributeRecord
+    {
+      std::uint32_t name;
+      std::uint32_t value;
+    };
+
+    struct StringRecord
+    {
+      std::uint32_t offset;
+      std::uint32_t size;
+    };
+
+    struct Layout
+    {
+      std::uint64_t sources;
+      std::uint64_t trees;
+      std::uint64_t nodes;
+      std::uint64_t attributes;
+      std::uint64_t children;
+      std::uint64_t strings;
+      std::uint64_t blob;
+      std::uint64_t total;
+
+      static Layout of(const Header& header)
+      {
+        std::uint64_t offset = sizeof(Header);
+        const auto section = [&offset](std::uint64_t bytes)
+        {
+          const auto start = offset;
+          offset = (offset + bytes + 7) & ~std::uint64_t{7};
+          return start;
+        };
+
+        Layout layout;
+        layout.sources = section(std::uint64_t{header.source_count} * sizeof(SourceRecord));
+        layout.trees = section(std::uint64_t{header.tree_count} * sizeof(TreeRecord));
+        layout.nodes = section(std::uint64_t{header.node_count} * sizeof(NodeRecord));
+        layout.attributes = section(std::uint64_t{header.attribute_count} * sizeof(AttributeRecord));
+        layout.children = section(std::uint64_t{header.child_count} * sizeof(std::uint32_t));
+        layout.strings = section(std::uint64_t{header.string_count} * sizeof(StringRecord));
+        layout.blob = section(header.string_bytes);
+        layout.total = offset;
+        return layout;
+      }
+    };
+
+    std::uint64_t fnv1a(std::string_view data)
+    {
+      std::uint64_t hash = 0xcbf29ce484222325ull;
+      for (const unsigned char c : data)
+      {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+      }
+      return hash;
+    }
+
+    std::string normalize(const std::filesystem::path& path)
+    {
+      return std::filesystem::absolute(path).lexically_normal().string();
+    }
+
+    struct FileStamp
+    {
+      std::int64_t mtime;
+      std::uint64_t size;
+    };
+
+    std::optional<FileStamp> fileStamp(const std::string& path)
+    {
+      struct stat info;
+      if (0 != ::stat(path.c_str(), &info))
+      {
+        return std::nullopt;
+      }
+      return FileStamp{std::int64_t{info.st_mtim.tv_sec} * 1'000'000'000 + info.st_mtim.tv_nsec,
+        static_cast<std::uint64_t>(info.st_size)};
+    }
+
+    std::optional<std::string> readFile(const std::string& path)
+    {
+      std::ifstream file(path, std::ios::binary);
+      if (!file)
+      {
+        return std::nullopt;
+      }
+      return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // Same rules as the BT.CPP XML parser
+    bool isAllowedPortName(std::string_view name)
+    {
+      return !name.empty()
+        && std::isalpha(static_cast<unsigned char>(name.front()))
+        && "name" != name
+        && "ID" != name;
+    }
+
+    BT::NodeType nodeTypeOf(std::string_view tag)
+    {
+      if ("Action" == tag) return BT::NodeType::ACTION;
+      if ("Condition" == tag) return BT::NodeType::CONDITION;
+      if ("Control" == tag) return BT::NodeType::CONTROL;
+      if ("Decorator" == tag) return BT::NodeType::DECORATOR;
+      if ("SubTree" == tag) return BT::NodeType::SUBTREE;
+      return BT::NodeType::UNDEFINED;
+    }
+
+    // Validated typed view over the bytes of a cache
+    class CacheView
+    {
+    public:
+      // False if the bytes are not a well formed cache of the current version
+      bool attach(const char* data, std::size_t size)
+      {
+        if (size < sizeof(Header))
+        {
+          return false;
+        }
+        header_ = reinterpret_cast<const Header*>(data);
+        if (0 != std::memcmp(header_->magic, MAGIC, sizeof(MAGIC))
+            || FORMAT_VERSION != header_->version)
+        {
+          return false;
+        }
+        const auto layout = Layout::of(*header_);
+        if (layout.total != size)
+        {
+          return false;
+        }
+
+        sources_ = {reinterpret_cast<const SourceRecord*>(data + layout.sources), header_->source_count};
+        trees_ = {reinterpret_cast<const TreeRecord*>(data + layout.trees), header_->tree_count};
+        nodes_ = {reinterpret_cast<const NodeRecord*>(data + layout.nodes), header_->node_count};
+        attributes_ = {reinterpret_cast<const AttributeRecord*>(data + layout.attributes), header_->attribute_count};
+        children_ = {reinterpret_cast<const std::uint32_t*>(data + layout.children), header_->child_count};
+        strings_ = {reinterpret_cast<const StringRecord*>(data + layout.strings), header_->string_count};
+        blob_ = data + layout.blob;
+
+        return validate();
+      }
+
+      std::string_view string(std::uint32_t index) const
+      {
+        const auto& record = strings_[index];
+        return {blob_ + record.offset, record.size};
+      }
+
+      std::uint32_t mainTree() const { return header_->main_tree; }
+      bool needsParser() const { return 0 != (header_->flags & NEEDS_PARSER); }
+      std::span<const SourceRecord> sources() const { return sources_; }
+      std::span<const SourceRecord> inputs() const { return sources_.first(header_->input_count); }
+      std::span<const TreeRecord> trees() const { return trees_; }
+      const NodeRecord& node(std::uint32_t index) const { return nodes_[index]; }
+
+      std::span<const AttributeRecord> attributes(const NodeRecord& node) const
+      {
+        return attributes_.subspan(node.first_attribute, node.attribute_count);
+      }
+
+      std::span<const std::uint32_t> children(const NodeRecord& node) const
+      {
+        return children_.subspan(node.first_child, node.child_count);
+      }
+
+      std::optional<std::string_view> attribute(const NodeRecord& node, std::string_view name) const
+      {
+        for (const auto& attribute : attributes(node))
+        {
+          if (string(attribute.name) == name)
+          {
+            return string(attribute.value);
+          }
+        }
+        return std::nullopt;
+      }
+
+      // Same time and size, or else same content, for every source file
+      bool upToDate() const
+      {
+        for (const auto& source : sources_)
+        {
+          const std::string path{string(source.path)};
+          const auto stamp = fileStamp(path);
+          if (!stamp)
+          {
+            return false;
+          }
+          if (stamp->mtime == source.mtime && stamp->size == source.size)
+          {
+            continue;
+          }
+          // Touched, reading and hashing is still far cheaper than parsing
+          const auto content = readFile(path);
+          if (!content || fnv1a(*content) != source.hash)
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      std::span<const NodeRecord> nodes() const { return nodes_; }
+
+    private:
+      bool validate()
+      {
+        const auto string_count = header_->string_count;
+        for (const auto& record : strings_)
+        {
+          if (std::uint64_t{record.offset} + record.size > header_->string_bytes)
+          {
+            return false;
+          }
+        }
+        if (header_->input_count > header_->source_count
+            || (NONE != header_->main_tree && header_->main_tree >= string_count))
+        {
+          return false;
+        }
+        for (const auto& source : sources_)
+        {
+          if (source.path >= string_count)
+          {
+            return false;
+          }
+        }
+        for (const auto& attribute : attributes_)
+        {
+          if (attribute.name >= string_count || attribute.value >= string_count)
+          {
+            return false;
+          }
+        }
+        for (std::uint32_t i = 0; i < nodes_.size(); ++i)
+        {
+          const auto& node = nodes_[i];
+          if (node.tag >= string_count
+              || std::uint64_t{node.first_attribute} + node.attribute_count > attributes_.size()
+              || std::uint64_t{node.first_child} + node.child_count > children_.size())
+          {
+            return false;
+          }
+          // Nodes are stored in pre-order, a child always comes after its parent (no cycles)
+          for (const auto child : children(node))
+          {
+            if (child <= i || child >= nodes_.size())
+            {
+              return false;
+            }
+          }
+        }
+        for (const auto& tree : trees_)
+        {
+          if (tree.id >= string_count || (NONE != tree.root && tree.root >= nodes_.size()))
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      const Header* header_ = nullptr;
+      std::span<const SourceRecord> sources_;
+      std::span<const TreeRecord> trees_;
+      std::span<const NodeRecord> nodes_;
+      std::span<const AttributeRecord> attributes_;
+      std::span<const std::uint32_t> children_;
+      std::span<const StringRecord> strings_;
+      const char* blob_ = nullptr;
+    };
+
+    // Flattens XML documents into the cache format
+    class Compiler
+    {
+    public:
+      std::vector<char> compile(const std::vector<std::string>& xml_files)
+      {
+        // Inputs are recorded first, in order, their includes come after them
+        std::vector<std::pair<std::string, std::string>> inputs;
+        for (const auto& xml_file : xml_files)
+        {
+          auto path = normalize(xml_file);
+          auto content = readSource(path);
+          inputs.emplace_back(std::move(path), std::move(content));
+        }
+        input_count_ = static_cast<std::uint32_t>(sources_.size());
+
+        for (const auto& [path, content] : inputs)
+        {
+          parseDocument(path, content);
+        }
+        return serialize();
+      }
+
+    private:
+      std::string readSource(const std::string& path)
+      {
+        // Stamp first, a file modified while it is read gets a newer time and is hashed again
+        const auto stamp = fileStamp(path);
+        auto content = readFile(path);
+        if (!stamp || !content)
+        {
+          throw BT::RuntimeError("TreeLibrary: cannot read [", path, "]");
+        }
+        if (recorded_.insert(path).second)
+        {
+          sources_.push_back({fnv1a(*content), stamp->mtime, stamp->size, intern(path), 0});
+        }
+        return std::move(*content);
+      }
+
+      void parseDocument(const std::string& path, const std::string& content)
+      {
+        if (!parsed_.insert(path).second)
+        {
+          return;
+        }
+
+        tinyxml2::XMLDocument doc;
+        if (tinyxml2::XML_SUCCESS != doc.Parse(content.data(), content.size()))
+        {
+          throw BT::RuntimeError("TreeLibrary: cannot parse [", path, "]: ", doc.ErrorStr());
+        }
+        const auto* root = doc.RootElement();
+        if (!root || std::string_view("root") != root->Name())
+        {
+          throw BT::RuntimeError("TreeLibrary: [", path, "] has no <root> element");
+        }
+        if (const char* main_tree = root->Attribute("main_tree_to_execute"))
+        {
+          main_tree_ = intern(main_tree);
+        }
+        // Anything the cache does not model is left to the BT.CPP parser rather than
+        // approximated: another format, <TreeNodesModel> (SubTree port models and
+        // their defaults), unknown elements, a BehaviorTree without exactly one root
+        if (const char* format = root->Attribute("BTCPP_format"); format && std::string_view("4") != format)
+        {
+          flags_ |= NEEDS_PARSER;
+        }
+        for (auto element = root->FirstChildElement(); element; element = element->NextSiblingElement())
+        {
+          const std::string_view name = element->Name();
+          if ("include" != name && "BehaviorTree" != name)
+          {
+            flags_ |= NEEDS_PARSER;
+          }
+          else if ("BehaviorTree" == name
+              && (!element->FirstChildElement() || element->FirstChildElement()->NextSiblingElement()))
+          {
+            flags_ |= NEEDS_PARSER;
+          }
+        }
+
+        // Included files are loaded before the trees of the including file, like the BT.CPP parser
+        for (auto include = root->FirstChildElement("include"); include; include = include->NextSiblingElement("include"))
+        {
+          const char* include_path = include->Attribute("path");
+          if (!include_path || include->Attribute("ros_pkg"))
+          {
+            throw BT::RuntimeError("TreeLibrary: only <include path=\"...\"/> is supported in [", path, "]");
+          }
+          const auto included = normalize(std::filesystem::path(path).parent_path() / include_path);
+          if (!parsed_.count(included))
+          {
+            parseDocument(included, readSource(included));
+          }
+        }
+
+        for (auto tree = root->FirstChildElement("BehaviorTree"); tree; tree = tree->NextSiblingElement("BehaviorTree"))
+        {
+          const char* id = tree->Attribute("ID");
+          const std::string tree_ID = id ? id : "BehaviorTree_" + std::to_string(anonymous_trees_++);
+          if (!tree_ids_.insert(tree_ID).second)
+          {
+            throw BT::RuntimeError("TreeLibrary: duplicated BehaviorTree ID [", tree_ID, "] in [", path, "]");
+          }
+          const auto* root_element = tree->FirstChildElement();
+          const auto id_index = intern(tree_ID);
+          trees_.push_back({id_index, root_element ? addNode(root_element) : NONE});
+        }
+      }
+
+      std::uint32_t addNode(const tinyxml2::XMLElement* element)
+      {
+        const auto index = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.push_back({intern(element->Name()), static_cast<std::uint32_t>(attributes_.size()), 0, 0, 0});
+
+        std::uint32_t attribute_count = 0;
+        for (auto attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+        {
+          attributes_.push_back({intern(attribute->Name()), intern(attribute->Value())});
+          ++attribute_count;
+        }
+
+        std::vector<std::uint32_t> children;
+        for (auto child = element->FirstChildElement(); child; child = child->NextSiblingElement())
+        {
+          children.push_back(addNode(child));
+        }
+
+        // nodes_ may have grown, index again
+        auto& node = nodes_[index];
+        node.attribute_count = attribute_count;
+        node.first_child = static_cast<std::uint32_t>(children_.size());
+        node.child_count = static_cast<std::uint32_t>(children.size());
+        children_.insert(children_.end(), children.begin(), children.end());
+        return index;
+      }
+
+      std::uint32_t intern(std::string_view str)
+      {
+        const auto it = string_index_.find(std::string(str));
+        if (string_index_.end() != it)
+        {
+          return it->second;
+        }
+        if (blob_.size() + str.size() > std::numeric_limits<std::uint32_t>::max())
+        {
+          throw BT::RuntimeError("TreeLibrary: string table too large");
+        }
+        const auto index = static_cast<std::uint32_t>(strings_.size());
+        strings_.push_back({static_cast<std::uint32_t>(blob_.size()), static_cast<std::uint32_t>(str.size())});
+        blob_.insert(blob_.end(), str.begin(), str.end());
+        string_index_.emplace(str, index);
+        return index;
+      }
+
+      template <typename RecordT>
+      static void copySection(std::vector<char>& bytes, std::uint64_t offset, const std::vector<RecordT>& records)
+      {
+        if (!records.empty())
+        {
+          std::memcpy(bytes.data() + offset, records.data(), records.size() * sizeof(RecordT));
+        }
+      }
+
+      std::vector<char> serialize() const
+      {
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = FORMAT_VERSION;
+        header.source_count = static_cast<std::uint32_t>(sources_.size());
+        header.input_count = input_count_;
+        header.tree_count = static_cast<std::uint32_t>(trees_.size());
+        header.node_count = static_cast<std::uint32_t>(nodes_.size());
+        header.attribute_count = static_cast<std::uint32_t>(attributes_.size());
+        header.child_count = static_cast<std::uint32_t>(children_.size());
+        header.string_count = static_cast<std::uint32_t>(strings_.size());
+        header.string_bytes = static_cast<std::uint32_t>(blob_.size());
+        header.main_tree = main_tree_;
+        header.flags = flags_;
+
+        const auto layout = Layout::of(header);
+        std::vector<char> bytes(layout.total, 0);
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        copySection(bytes, layout.sources, sources_);
+        copySection(bytes, layout.trees, trees_);
+        copySection(bytes, layout.nodes, nodes_);
+        copySection(bytes, layout.attributes, attributes_);
+        copySection(bytes, layout.children, children_);
+        copySection(bytes, layout.strings, strings_);
+        copySection(bytes, layout.blob, blob_);
+        return bytes;
+      }
+
+      std::uint32_t input_count_ = 0;
+      std::uint32_t main_tree_ = NONE;
+      std::uint32_t flags_ = 0;
+      int anonymous_trees_ = 0;
+      std::unordered_set<std::string> recorded_;
+      std::unordered_set<std::string> parsed_;
+      std::unordered_set<std::string> tree_ids_;
+      std::unordered_map<std::string, std::uint32_t> string_index_;
+      std::vector<SourceRecord> sources_;
+      std::vector<TreeRecord> trees_;
+      std::vector<NodeRecord> nodes_;
+      std::vector<AttributeRecord> attributes_;
+      std::vector<std::uint32_t> children_;
+      std::vector<StringRecord> strings_;
+      std::vector<char> blob_;
+    };
+
+    // A tree of one of the caches of a library
+    struct TreeRef
+    {
+      const CacheView* cache;
+      std::uint32_t index;
+    };
+
+    using TreeFinder = std::function<std::optional<TreeRef>(std::string_view)>;
+
+    // DecoratorNode only sets its child, reaching the member is the way to unlink it
+    struct ChildUnlinker : BT::DecoratorNode
+    {
+      static void unlink(BT::DecoratorNode& node)
+      {
+        node.*(&ChildUnlinker::child_node_) = nullptr;
+      }
+    };
+
+    // The SubTree instances of a tree being rebuilt, by path
+    class PreviousTree
+    {
+    public:
+      struct Instance
+      {
+        std::size_t index;          // in BT::Tree::subtrees
+        BT::SubTreeNode* node;      // the SubTree node that instantiated it
+      };
+
+      PreviousTree(BT::Tree& tree, const std::unordered_set<std::string>& changed_tree_IDs)
+        : subtrees_{tree.subtrees}
+        , changed_{changed_tree_IDs}
+      {
+        // Both parsers create subtrees[k] right after the k-th SubTree node met depth first
+        std::vector<BT::SubTreeNode*> nodes;
+        if (auto root = tree.rootNode())
+        {
+          BT::applyRecursiveVisitor(root, [&nodes](BT::TreeNode* node)
+            {
+              if (auto subtree_node = dynamic_cast<BT::SubTreeNode*>(node))
+              {
+                nodes.push_back(subtree_node);
+              }
+            });
+        }
+        if (nodes.size() + 1 != subtrees_.size())
+        {
+          // Not built by a parser, nothing can be matched
+          return;
+        }
+        for (std::size_t i = 1; i < subtrees_.size(); ++i)
+        {
+          instances_.emplace(subtrees_[i]->instance_name, Instance{i, nodes[i - 1]});
+        }
+      }
+
+      const Instance* find(const std::string& path) const
+      {
+        const auto it = instances_.find(path);
+        return instances_.end() == it ? nullptr : &it->second;
+      }
+
+      const BT::Tree::Subtree& subtree(const Instance& instance) const
+      {
+        return *subtrees_[instance.index];
+      }
+
+      // The subtree of an instance followed by the ones nested in it, contiguous depth first
+      std::span<const BT::Tree::Subtree::Ptr> nested(const Instance& instance) const
+      {
+        const auto prefix = subtrees_[instance.index]->instance_name + "/";
+        auto end = instance.index + 1;
+        while (end < subtrees_.size() && subtrees_[end]->instance_name.starts_with(prefix))
+        {
+          ++end;
+        }
+        return {subtrees_.data() + instance.index, end - instance.index};
+      }
+
+      bool unchanged(std::span<const BT::Tree::Subtree::Ptr> subtrees) const
+      {
+        return std::none_of(subtrees.begin(), subtrees.end(), [this](const auto& subtree)
+          {
+            return 0 != changed_.count(subtree->tree_ID);
+          });
+      }
+
+    private:
+      const std::vector<BT::Tree::Subtree::Ptr>& subtrees_;
+      const std::unordered_set<std::string>& changed_;
+      std::unordered_map<std::string, Instance> instances_;
+    };
+
+    // Instantiates the nodes of a cached tree, mirrors BT::XMLParser::instantiateTree()
+    class TreeBuilder
+    {
+    public:
+      TreeBuilder(TreeFinder find_tree, const BT::BehaviorTreeFactory& factory, BT::Tree& tree)
+        : find_tree_{std::move(find_tree)}
+        , factory_{factory}
+        , tree_{tree}
+      {}
+
+      // Reuse what did not change in `previous`, its root blackboard must be the one of the new tree
+      void reuse(const PreviousTree& previous, const BT::Blackboard::Ptr& root_blackboard)
+      {
+        previous_ = &previous;
+        reused_blackboards_.insert(root_blackboard.get());
+      }
+
+      // SubTree instances whose nodes were moved from the previous tree
+      std::size_t reusedSubtrees() const
+      {
+        return reused_subtrees_;
+      }
+
+      // Once the new tree is complete: the previous one keeps only the nodes that were not
+      // moved, so halting or destroying it leaves the reused ones running
+      void detachReused(BT::Tree& previous) const
+      {
+        std::unordered_set<const BT::Tree::Subtree*> moved;
+        for (const auto& [subtree_node, subtrees] : moved_)
+        {
+          ChildUnlinker::unlink(*subtree_node);
+          for (const auto& subtree : subtrees)
+          {
+            moved.insert(subtree.get());
+          }
+        }
+        std::erase_if(previous.subtrees, [&moved](const auto& subtree)
+          {
+            return 0 != moved.count(subtree.get());
+          });
+      }
+
+      void createSubtree(const TreeRef& ref,
+          const std::string& tree_path,
+          const std::string& prefix,
+          const BT::Blackboard::Ptr& blackboard,
+          const BT::TreeNode::Ptr& parent)
+      {
+        const auto& cache = *ref.cache;
+        const auto& record = cache.trees()[ref.index];
+
+        auto subtree = std::make_shared<BT::Tree::Subtree>();
+        subtree->blackboard = blackboard;
+        subtree->instance_name = tree_path;
+        subtree->tree_ID = std::string(cache.string(record.id));
+        tree_.subtrees.push_back(subtree);
+
+        if (NONE == record.root)
+        {
+          throw BT::RuntimeError("TreeLibrary: BehaviorTree [", subtree->tree_ID, "] is empty");
+        }
+        createNode(cache, record.root, blackboard, parent, prefix, *subtree);
+      }
+
+    private:
+      void createNode(const CacheView& cache,
+          std::uint32_t index,
+          const BT::Blackboard::Ptr& blackboard,
+          const BT::TreeNode::Ptr& parent,
+          const std::string& prefix,
+          BT::Tree::Subtree& subtree)
+      {
+        const auto& record = cache.node(index);
+        const auto tag = std::string(cache.string(record.tag));
+        const auto node_type = nodeTypeOf(tag);
+        const auto id = cache.attribute(record, "ID");
+
+        std::string type_ID;
+        if (BT::NodeType::UNDEFINED == node_type)
+        {
+          if (0 == factory_.builders().count(tag))
+          {
+            throw BT::RuntimeError(tag, " is not a registered node");
+          }
+          if (id)
+          {
+            throw BT::RuntimeError("Attribute [ID] is not allowed in <", tag, ">");
+          }
+          type_ID = tag;
+        }
+        else
+        {
+          if (!id)
+          {
+            throw BT::RuntimeError("Attribute [ID] is mandatory in <", tag, ">");
+          }
+          type_ID = std::string(*id);
+        }
+
+        const auto name = cache.attribute(record, "name");
+        const std::string instance_name = name ? std::string(*name) : type_ID;
+
+        const auto& manifests = factory_.manifests();
+        const auto manifest_it = manifests.find(type_ID);
+        const BT::TreeNodeManifest* manifest = manifests.end() == manifest_it ? nullptr : &manifest_it->second;
+
+        BT::PortsRemapping port_remap;
+        for (const auto& attribute : cache.attributes(record))
+        {
+          const auto port_name = cache.string(attribute.name);
+          if (isAllowedPortName(port_name))
+          {
+            std::string port_value{cache.string(attribute.value)};
+            if ("{=}" == port_value)
+            {
+              port_value = "{" + std::string(port_name) + "}";
+            }
+            port_remap.emplace(port_name, std::move(port_value));
+          }
+        }
+
+        BT::NodeConfig config;
+        config.blackboard = blackboard;
+        config.path = prefix + instance_name;
+        config.uid = tree_.getUID();
+        config.manifest = manifest;
+        if (type_ID == instance_name)
+        {
+          config.path += "::" + std::to_string(config.uid);
+        }
+        for (int i = 0; i < static_cast<int>(BT::PreCond::COUNT_); ++i)
+        {
+          const auto condition = static_cast<BT::PreCond>(i);
+          if (const auto script = cache.attribute(record, BT::toStr(condition)))
+          {
+            config.pre_conditions.emplace(condition, std::string(*script));
+          }
+        }
+        for (int i = 0; i < static_cast<int>(BT::PostCond::COUNT_); ++i)
+        {
+          const auto condition = static_cast<BT::PostCond>(i);
+          if (const auto script = cache.attribute(record, BT::toStr(condition)))
+          {
+            config.post_conditions.emplace(condition, std::string(*script));
+          }
+        }
+
+        BT::TreeNode::Ptr node;
+        if (BT::NodeType::SUBTREE == node_type)
+        {
+          config.input_ports = port_remap;
+          node = factory_.instantiateTreeNode(instance_name, BT::toStr(BT::NodeType::SUBTREE), config);
+          if (auto subtree_node = dynamic_cast<BT::SubTreeNode*>(node.get()))
+          {
+            subtree_node->setSubtreeID(type_ID);
+          }
+        }
+        else
+        {
+          if (!manifest)
+          {
+            throw BT::RuntimeError(type_ID, " is not a registered node");
+          }
+          remapPorts(*manifest, type_ID, port_remap, blackboard, config);
+          node = factory_.instantiateTreeNode(instance_name, type_ID, config);
+        }
+
+        if (parent)
+        {
+          if (auto control = dynamic_cast<BT::ControlNode*>(parent.get()))
+          {
+            control->addChild(node.get());
+          }
+          else if (auto decorator = dynamic_cast<BT::DecoratorNode*>(parent.get()))
+          {
+            decorator->setChild(node.get());
+          }
+        }
+        subtree.nodes.push_back(node);
+        checkChildren(*node, tag, cache.children(record).size());
+
+        if (BT::NodeType::SUBTREE != node->type())
+        {
+          for (const auto child : cache.children(record))
+          {
+            createNode(cache, child, blackboard, node, prefix, subtree);
+          }
+          return;
+        }
+
+        std::string subtree_path = subtree.instance_name;
+        if (!subtree_path.empty())
+        {
+          subtree_path += "/";
+        }
+        subtree_path += name ? std::string(*name) : type_ID + "::" + std::to_string(node->UID());
+
+        // The referenced tree may come from another file of the library
+        const auto ref = find_tree_(type_ID);
+        if (!ref)
+        {
+          throw BT::RuntimeError("Can't find a tree with name: ", type_ID);
+        }
+
+        bool autoremap = false;
+        if (const auto value = cache.attribute(record, "_autoremap"))
+        {
+          autoremap = BT::convertFromString<bool>(*value);
+        }
+
+        const auto* previous = previous_ ? previous_->find(subtree_path) : nullptr;
+        if (previous && reused_blackboards_.count(blackboard.get())
+            && previous_->subtree(*previous).tree_ID == type_ID
+            && previous->node->config().input_ports == port_remap)
+        {
+          // Same instance, same remapping into a blackboard kept as well: keep its blackboard
+          const auto& subtree_blackboard = previous_->subtree(*previous).blackboard;
+          subtree_blackboard->enableAutoRemapping(autoremap);
+          reused_blackboards_.insert(subtree_blackboard.get());
+
+          const auto nested = previous_->nested(*previous);
+          if (previous_->unchanged(nested))
+          {
+            moveSubtrees(nested, *node);
+            moved_.push_back({previous->node, nested});
+            return;
+          }
+          createSubtree(*ref, subtree_path, subtree_path + "/", subtree_blackboard, node);
+          return;
+        }
+
+        // SubTree: new blackboard with the remapped or constant ports, then recurse into its tree
+        auto subtree_blackboard = BT::Blackboard::create(blackboard);
+        subtree_blackboard->enableAutoRemapping(autoremap);
+        std::unordered_map<std::string, std::string> remapping;
+        for (const auto& attribute : cache.attributes(record))
+        {
+          const std::string attribute_name{cache.string(attribute.name)};
+          std::string attribute_value{cache.string(attribute.value)};
+          if ("{=}" == attribute_value)
+          {
+            attribute_value = "{" + attribute_name + "}";
+          }
+          if (isAllowedPortName(attribute_name))
+          {
+            remapping.emplace(attribute_name, std::move(attribute_value));
+          }
+        }
+        for (const auto& [attribute_name, attribute_value] : remapping)
+        {
+          if (BT::TreeNode::isBlackboardPointer(attribute_value))
+          {
+            subtree_blackboard->addSubtreeRemapping(attribute_name, BT::TreeNode::stripBlackboardPointer(attribute_value));
+          }
+          else
+          {
+            // A constant is set in the subtree blackboard, never autoremapped
+            subtree_blackboard->enableAutoRemapping(false);
+            subtree_blackboard->set(attribute_name, attribute_value);
+            subtree_blackboard->enableAutoRemapping(autoremap);
+          }
+        }
+        if (previous)
+        {
+          copyEntries(*previous_->subtree(*previous).blackboard, *subtree_blackboard);
+        }
+        createSubtree(*ref, subtree_path, subtree_path + "/", subtree_blackboard, node);
+      }
+
+      // Same rules as BT::VerifyXML, which the parser runs before instantiating
+      static void checkChildren(const BT::TreeNode& node, const std::string& tag, std::size_t children)
+      {
+        switch (node.type())
+        {
+          case BT::NodeType::ACTION:
+          case BT::NodeType::CONDITION:
+          case BT::NodeType::SUBTREE:
+            if (0 != children)
+            {
+              throw BT::RuntimeError("The node <", tag, "> must not have any child");
+            }
+            break;
+          case BT::NodeType::DECORATOR:
+            if (1 != children)
+            {
+              throw BT::RuntimeError("The node <", tag, "> must have exactly 1 child");
+            }
+            break;
+          case BT::NodeType::CONTROL:
+            if (0 == children)
+            {
+              throw BT::RuntimeError("The node <", tag, "> must have at least 1 child");
+            }
+            break;
+          default:
+            break;
+        }
+      }
+
+      // Attach the nodes of previous subtrees under a new SubTree node
+      void moveSubtrees(std::span<const BT::Tree::Subtree::Ptr> subtrees, BT::TreeNode& subtree_node)
+      {
+        auto root = subtrees.front()->nodes.front().get();
+        static_cast<BT::DecoratorNode&>(subtree_node).setChild(root);
+        tree_.subtrees.insert(tree_.subtrees.end(), subtrees.begin(), subtrees.end());
+
+        // Depth first, the UIDs a fresh instantiation would have given
+        BT::applyRecursiveVisitor(root, [this](BT::TreeNode* node)
+          {
+            node->config().uid = tree_.getUID();
+          });
+        ++reused_subtrees_;
+      }
+
+      // Best effort for an instance whose blackboard could not be kept: copy the entries it owned
+      static void copyEntries(const BT::Blackboard& from, BT::Blackboard& to)
+      {
+        for (const auto key : from.getKeys())
+        {
+          const std::string entry_name{key};
+          const auto source = from.getEntry(entry_name);
+          if (!source || to.getEntry(entry_name))
+          {
+            continue;
+          }
+          to.createEntry(entry_name, source->info);
+          if (const auto entry = to.getEntry(entry_name))
+          {
+            std::scoped_lock lock{source->entry_mutex, entry->entry_mutex};
+            entry->value = source->value;
+          }
+        }
+      }
+
+      // Split the remapping in input and output ports, create blackboard entries, apply defaults
+      static void remapPorts(const BT::TreeNodeManifest& manifest,
+          const std::string& type_ID,
+          const BT::PortsRemapping& port_remap,
+          const BT::Blackboard::Ptr& blackboard,
+          BT::NodeConfig& config)
+      {
+        for (const auto& [port_name, port_value] : port_remap)
+        {
+          const auto port_it = manifest.ports.find(port_name);
+          if (manifest.ports.end() == port_it)
+          {
+            throw BT::RuntimeError("a port with name [", port_name, "] is found in the XML (<",
+                type_ID, ">) but not in the providedPorts() of its registered node type.");
+          }
+          const auto& port_info = port_it->second;
+
+          if (const auto remapped_key = BT::TreeNode::getRemappedKey(port_name, port_value))
+          {
+            const std::string port_key{remapped_key.value()};
+            if (const auto previous = blackboard->entryInfo(port_key))
+            {
+              const bool mismatch = previous->isStronglyTyped() && port_info.isStronglyTyped()
+                && previous->type() != port_info.type();
+              if (mismatch && previous->type() != typeid(std::string))
+              {
+                throw BT::RuntimeError("The creation of the tree failed because the port [", port_key,
+                    "] was initially created with type [", BT::demangle(previous->type()),
+                    "] and, later type [", BT::demangle(port_info.type()), "] was used somewhere else.");
+              }
+            }
+            else
+            {
+              blackboard->createEntry(port_key, port_info);
+            }
+          }
+
+          const auto direction = port_info.direction();
+          if (BT::PortDirection::OUTPUT != direction)
+          {
+            config.input_ports.emplace(port_name, port_value);
+          }
+          if (BT::PortDirection::INPUT != direction)
+          {
+            config.output_ports.emplace(port_name, port_value);
+          }
+        }
+
+        for (const auto& [port_name, port_info] : manifest.ports)
+        {
+          const auto direction = port_info.direction();
+          const auto& default_value = port_info.defaultValueString();
+          if (default_value.empty())
+          {
+            continue;
+          }
+          if (BT::PortDirection::OUTPUT != direction && 0 == config.input_ports.count(port_name))
+          {
+            config.input_ports.emplace(port_name, default_value);
+          }
+          if (BT::PortDirection::INPUT != direction && 0 == config.output_ports.count(port_name)
+              && BT::TreeNode::isBlackboardPointer(default_value))
+          {
+            config.output_ports.emplace(port_name, default_value);
+          }
+        }
+      }
+
+      TreeFinder find_tree_;
+      const BT::BehaviorTreeFactory& factory_;
+      BT::Tree& tree_;
+      const PreviousTree* previous_ = nullptr;
+      std::unordered_set<const BT::Blackboard*> reused_blackboards_;
+      std::size_t reused_subtrees_ = 0;
+      // The SubTree node of the previous tree and the subtrees moved from under it
+      std::vector<std::pair<BT::SubTreeNode*, std::span<const BT::Tree::Subtree::Ptr>>> moved_;
+    };
+  } // anonymous namespace
+
+  // Bytes of a library, owned or memory-mapped, with their validated view
+  class TreeLibrary::Storage
+  {
+  public:
+    explicit Storage(std::vector<char> bytes)
+      : bytes_{std::move(bytes)}
+      , mapping_{nullptr}
+      , mapping_size_{0}
+    {}
+
+    Storage(void* mapping, std::size_t size)
+      : mapping_{mapping}
+      , mapping_size_{size}
+    {}
+
+    Storage(const Storage&) = delete;
+    Storage& operator=(const Storage&) = delete;
+
+    ~Storage()
+    {
+      if (mapping_)
+      {
+        ::munmap(mapping_, mapping_size_);
+      }
+    }
+
+    const char* data() const { return mapping_ ? static_cast<const char*>(mapping_) : bytes_.data(); }
+    std::size_t size() const { return mapping_ ? mapping_size_ : bytes_.size(); }
+    bool mapped() const { return nullptr != mapping_; }
+
+    CacheView view;
+
+  private:
+    std::vector<char> bytes_;
+    void* mapping_;
+    std::size_t mapping_size_;
+  };
+
+  TreeLibrary::TreeLibrary(std::shared_ptr<const Storage> storage)
+    : units_{std::move(storage)}
+  {
+    indexTrees();
+  }
+
+  void TreeLibrary::indexTrees()
+  {
+    trees_.clear();
+    for (std::size_t unit = 0; unit < units_.size(); ++unit)
+    {
+      const auto& view = units_[unit]->view;
+      const auto trees = view.trees();
+      for (std::uint32_t i = 0; i < trees.size(); ++i)
+      {
+        const auto tree_ID = view.string(trees[i].id);
+        if (!trees_.emplace(tree_ID, TreeLocation{unit, i}).second)
+        {
+          throw BT::RuntimeError("TreeLibrary: duplicated BehaviorTree ID [", tree_ID, "] in [",
+              view.string(view.inputs().front().path), "]");
+        }
+      }
+    }
+  }
+
+  TreeLibrary TreeLibrary::fromXmlFiles(const std::vector<std::string>& xml_files)
+  {
+    auto storage = std::make_shared<Storage>(Compiler{}.compile(xml_files));
+    if (!storage->view.attach(storage->data(), storage->size()))
+    {
+      throw BT::LogicError("TreeLibrary: compiled an invalid cache");
+    }
+    return TreeLibrary{std::move(storage)};
+  }
+
+  std::optional<TreeLibrary> TreeLibrary::mapCache(const std::string& cache_path,
+      const std::vector<std::string>& xml_files)
+  {
+    const int fd = ::open(cache_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+      return std::nullopt;
+    }
+    struct stat info;
+    if (0 != ::fstat(fd, &info) || info.st_size < static_cast<off_t>(sizeof(Header)))
+    {
+      ::close(fd);
+      return std::nullopt;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == mapping)
+    {
+      return std::nullopt;
+    }
+
+    auto storage = std::make_shared<Storage>(mapping, size);
+    auto& view = storage->view;
+    if (!view.attach(storage->data(), storage->size()) || view.inputs().size() != xml_files.size())
+    {
+      return std::nullopt;
+    }
+    for (std::size_t i = 0; i < xml_files.size(); ++i)
+    {
+      if (view.string(view.inputs()[i].path) != normalize(xml_files[i]))
+      {
+        return std::nullopt;
+      }
+    }
+    if (!view.upToDate())
+    {
+      return std::nullopt;
+    }
+    try
+    {
+      return TreeLibrary{std::move(storage)};
+    }
+    catch (const BT::RuntimeError&)
+    {
+      // Duplicated tree IDs, only a damaged cache can have them
+      return std::nullopt;
+    }
+  }
+
+  TreeLibrary TreeLibrary::load(const std::vector<std::string>& xml_files, const std::string& cache_path)
+  {
+    if (auto library = mapCache(cache_path, xml_files))
+    {
+      return std::move(*library);
+    }
+    auto library = fromXmlFiles(xml_files);
+    // Best effort, a read-only location only costs a parse on the next start
+    library.save(cache_path);
+    return library;
+  }
+
+  TreeLibrary TreeLibrary::load(const std::string& xml_file, const std::string& cache_path)
+  {
+    return load(std::vector<std::string>{xml_file}, cache_path);
+  }
+
+  TreeLibrary TreeLibrary::merge(const std::vector<TreeLibrary>& libraries)
+  {
+    TreeLibrary merged;
+    for (const auto& library : libraries)
+    {
+      merged.units_.insert(merged.units_.end(), library.units_.begin(), library.units_.end());
+    }
+    merged.indexTrees();
+    return merged;
+  }
+
+  bool TreeLibrary::save(const std::string& cache_path) const
+  {
+    if (1 != units_.size())
+    {
+      return false;
+    }
+    const auto& storage = units_.front();
+
+    std::error_code error;
+    const std::filesystem::path path{cache_path};
+    if (path.has_parent_path())
+    {
+      std::filesystem::create_directories(path.parent_path(), error);
+    }
+
+    // Write aside and rename, a concurrent reader never maps a partial file
+    const auto temporary = cache_path + ".tmp" + std::to_string(::getpid());
+    {
+      std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+      file.write(storage->data(), static_cast<std::streamsize>(storage->size()));
+      if (!file.flush())
+      {
+        std::filesystem::remove(temporary, error);
+        return false;
+      }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+    {
+      std::filesystem::remove(temporary, error);
+      return false;
+    }
+    return true;
+  }
+
+  bool TreeLibrary::fromCache() const
+  {
+    return std::all_of(units_.begin(), units_.end(),
+        [](const auto& unit){ return unit->mapped(); });
+  }
+
+  bool TreeLibrary::needsParser() const
+  {
+    return std::any_of(units_.begin(), units_.end(),
+        [](const auto& unit){ return unit->view.needsParser(); });
+  }
+
+  bool TreeLibrary::upToDate() const
+  {
+    return std::all_of(units_.begin(), units_.end(),
+        [](const auto& unit){ return unit->view.upToDate(); });
+  }
+
+  std::vector<std::string> TreeLibrary::sourceFiles() const
+  {
+    std::vector<std::string> files;
+    for (const auto& unit : units_)
+    {
+      for (const auto& source : unit->view.sources())
+      {
+        files.emplace_back(unit->view.string(source.path));
+      }
+    }
+    return files;
+  }
+
+  std::vector<std::string> TreeLibrary::treeIDs() const
+  {
+    std::vector<std::string> IDs;
+    for (const auto& unit : units_)
+    {
+      for (const auto& tree : unit->view.trees())
+      {
+        IDs.emplace_back(unit->view.string(tree.id));
+      }
+    }
+    return IDs;
+  }
+
+  bool TreeLibrary::hasTree(std::string_view tree_ID) const
+  {
+    return trees_.count(tree_ID) > 0;
+  }
+
+  std::vector<std::string> TreeLibrary::subTreeReferences() const
+  {
+    std::unordered_set<std::string_view> seen;
+    std::vector<std::string> IDs;
+    for (const auto& unit : units_)
+    {
+      const auto& view = unit->view;
+      for (const auto& node : view.nodes())
+      {
+        if ("SubTree" != view.string(node.tag))
+        {
+          continue;
+        }
+        const auto ID = view.attribute(node, "ID");
+        if (ID && seen.insert(*ID).second)
+        {
+          IDs.emplace_back(*ID);
+        }
+      }
+    }
+    return IDs;
+  }
+
+  std::string TreeLibrary::mainTreeID() const
+  {
+    for (const auto& unit : units_)
+    {
+      if (NONE != unit->view.mainTree())
+      {
+        return std::string(unit->view.string(unit->view.mainTree()));
+      }
+    }
+    if (1 == trees_.size())
+    {
+      return std::string(trees_.begin()->first);
+    }
+    return {};
+  }
+
+  BT::Tree TreeLibrary::createTree(const BT::BehaviorTreeFactory& factory,
+      const std::string& tree_ID,
+      BT::Blackboard::Ptr blackboard) const
+  {
+    if (!blackboard)
+    {
+      throw BT::RuntimeError("TreeLibrary::createTree needs a non-empty blackboard");
+    }
+    return buildTree(factory, tree_ID, std::move(blackboard), nullptr, nullptr, nullptr);
+  }
+
+  BT::Tree TreeLibrary::rebuildTree(const BT::BehaviorTreeFactory& factory,
+      BT::Tree& previous,
+      const std::unordered_set<std::string>& changed_tree_IDs,
+      const std::string& tree_ID,
+      std::size_t* reused_subtrees) const
+  {
+    if (previous.subtrees.empty())
+    {
+      throw BT::RuntimeError("TreeLibrary::rebuildTree needs a previous tree");
+    }
+    return buildTree(factory, tree_ID, previous.rootBlackboard(), &previous, &changed_tree_IDs, reused_subtrees);
+  }
+
+  BT::Tree TreeLibrary::buildTree(const BT::BehaviorTreeFactory& factory,
+      const std::string& tree_ID,
+      BT::Blackboard::Ptr blackboard,
+      BT::Tree* previous,
+      const std::unordered_set<std::string>* changed_tree_IDs,
+      std::size_t* reused_subtrees) const
+  {
+    const auto ID = tree_ID.empty() ? mainTreeID() : tree_ID;
+    if (ID.empty())
+    {
+      throw BT::RuntimeError("TreeLibrary: no main tree to execute, a tree ID is required");
+    }
+    const auto find_tree = [this](std::string_view tree_ID) -> std::optional<TreeRef>
+    {
+      const auto it = trees_.find(tree_ID);
+      if (trees_.end() == it)
+      {
+        return std::nullopt;
+      }
+      return TreeRef{&units_[it->second.unit]->view, it->second.index};
+    };
+    const auto root = find_tree(ID);
+    if (!root)
+    {
+      throw BT::RuntimeError("Can't find a tree with name: ", ID);
+    }
+
+    if (needsParser())
+    {
+      // Built from the source files by BT.CPP itself, nothing is reused
+      if (reused_subtrees)
+      {
+        *reused_subtrees = 0;
+      }
+      return parseTree(factory, ID, std::move(blackboard));
+    }
+
+    BT::Tree tree;
+    TreeBuilder builder{find_tree, factory, tree};
+    std::optional<PreviousTree> previous_tree;
+    if (previous)
+    {
+      previous_tree.emplace(*previous, *changed_tree_IDs);
+      builder.reuse(*previous_tree, blackboard);
+    }
+    builder.createSubtree(*root, {}, {}, blackboard, nullptr);
+    tree.initialize();
+    if (previous)
+    {
+      builder.detachReused(*previous);
+    }
+    if (reused_subtrees)
+    {
+      *reused_subtrees = builder.reusedSubtrees();
+    }
+    adoptManifests(factory, tree);
+    return tree;
+  }
+
+  BT::Tree TreeLibrary::parseTree(const BT::BehaviorTreeFactory& factory,
+      const std::string& tree_ID,
+      BT::Blackboard::Ptr blackboard) const
+  {
+    // The files given to each unit, their includes are loaded by the parser
+    BT::XMLParser parser{factory};
+    for (const auto& unit : units_)
+    {
+      for (const auto& input : unit->view.inputs())
+      {
+        parser.loadFromFile(std::string(unit->view.string(input.path)));
+      }
+    }
+    auto tree = parser.instantiateTree(blackboard, tree_ID);
+    adoptManifests(factory, tree);
+    return tree;
+  }
+
+  void TreeLibrary::adoptManifests(const BT::BehaviorTreeFactory& factory, BT::Tree& tree)
+  {
+    // The tree keeps its own copy of the manifests, like BehaviorTreeFactory::createTree()
+    tree.manifests = factory.manifests();
+    for (auto& subtree : tree.subtrees)
+    {
+      for (auto& node : subtree->nodes)
+      {
+        if (const auto* manifest = node->config().manifest)
+        {
+          const auto it = tree.manifests.find(manifest->registration_ID);
+          if (tree.manifests.end() != it)
+          {
+            node->config().manifest = &it->second;
+          }
+        }
+      }
+    }
+  }
+} // bt_ros
@@ -0,0 +1,165 @@
+#include "ros2-behaviortree/tree_directory_loader.hpp"
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+namespace bt_ros
+{
+  const char* toStr(TreeFileReport::Origin origin)
+  {
+    switch (origin)
+    {
+      case TreeFileReport::Origin::UNCHANGED: return "unchanged";
+      case TreeFileReport::Origin::CACHE: return "cache";
+      case TreeFileReport::Origin::PARSED: return "parsed";
+    }
+    return "unknown";
+  }
+
+  TreeDirectoryLoader::TreeDirectoryLoader(std::string directory, std::string cache_directory, std::size_t threads)
+    : directory_{std::move(directory)}
+    , cache_directory_{std::move(cache_directory)}
+    , threads_{threads ? threads : std::max(1u, std::thread::hardware_concurrency())}
+    , load_time_{0}
+  {
+  }
+
+  TreeLibrary TreeDirectoryLoader::load()
+  {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::error_code error;
+    std::vector<std::string> files;
+    for (std::filesystem::directory_iterator it{directory_, error}, end; !error && it != end; it.increment(error))
+    {
+      if (it->is_regular_file() && ".xml" == it->path().extension())
+      {
+        files.push_back(it->path().string());
+      }
+    }
+    if (error)
+    {
+      throw BT::RuntimeError("TreeDirectoryLoader: cannot read [", directory_, "]: ", error.message());
+    }
+    // The iteration order is unspecified, keep the libraries and the report stable
+    std::sort(files.begin(), files.end());
+
+    std::vector<std::optional<TreeLibrary>> libraries(files.size());
+    std::vector<TreeFileReport> report(files.size());
+    std::vector<std::exception_ptr> errors(files.size());
+    std::atomic<std::size_t> next{0};
+
+    // loaded_ is only read until every worker is done
+    const auto worker = [&]()
+    {
+      for (auto i = next.fetch_add(1); i < files.size(); i = next.fetch_add(1))
+      {
+        const auto file_start = std::chrono::steady_clock::now();
+        auto& entry = report[i];
+        entry.path = files[i];
+        try
+        {
+          const auto previous = loaded_.find(files[i]);
+          if (loaded_.end() != previous && previous->second.upToDate())
+          {
+            libraries[i] = previous->second;
+            entry.origin = TreeFileReport::Origin::UNCHANGED;
+          }
+          else
+          {
+            libraries[i] = cache_directory_.empty() ? TreeLibrary::fromXmlFiles({files[i]})
+              : TreeLibrary::load(files[i], cachePath(files[i]));
+            entry.origin = libraries[i]->fromCache() ? TreeFileReport::Origin::CACHE
+              : TreeFileReport::Origin::PARSED;
+          }
+          entry.tree_count = libraries[i]->treeIDs().size();
+        }
+        catch (...)
+        {
+          errors[i] = std::current_exception();
+        }
+        entry.load_time = std::chrono::steady_clock::now() - file_start;
+      }
+    };
+
+    {
+      // The calling thread is one of the workers
+      std::vector<std::jthread> pool;
+      for (std::size_t t = 1; t < std::min(threads_, files.size()); ++t)
+      {
+        pool.emplace_back(worker);
+      }
+      worker();
+    }
+
+    report_ = std::move(report);
+    load_time_ = std::chrono::steady_clock::now() - start;
+    for (const auto& file_error : errors)
+    {
+      if (file_error)
+      {
+        std::rethrow_exception(file_error);
+      }
+    }
+
+    std::map<std::string, TreeLibrary> loaded;
+    std::vector<TreeLibrary> units;
+    units.reserve(files.size());
+    for (std::size_t i = 0; i < files.size(); ++i)
+    {
+      loaded.insert_or_assign(files[i], *libraries[i]);
+      units.push_back(std::move(*libraries[i]));
+    }
+    auto library = TreeLibrary::merge(units);
+
+    // Every file was parsed on its own, SubTree references are only resolved now
+    for (const auto& [path, file_library] : loaded)
+    {
+      for (const auto& ID : file_library.subTreeReferences())
+      {
+        if (!library.hasTree(ID))
+        {
+          throw BT::RuntimeError("TreeDirectoryLoader: SubTree [", ID, "] used in [", path,
+              "] is not defined in [", directory_, "]");
+        }
+      }
+    }
+
+    // Only a valid directory replaces the previous one
+    loaded_ = std::move(loaded);
+    load_time_ = std::chrono::steady_clock::now() - start;
+    return library;
+  }
+
+  const std::vector<TreeFileReport>& TreeDirectoryLoader::report() const
+  {
+    return report_;
+  }
+
+  std::chrono::nanoseconds TreeDirectoryLoader::loadTime() const
+  {
+    return load_time_;
+  }
+
+  const std::map<std::string, TreeLibrary>& TreeDirectoryLoader::fileLibraries() const
+  {
+    return loaded_;
+  }
+
+  std::string TreeDirectoryLoader::cachePath(const std::string& xml_file) const
+  {
+    // One cache per file, named after the file and a hash of its absolute path
+    const auto path = std::filesystem::absolute(xml_file).lexically_normal();
+    std::ostringstream name;
+    name << path.stem().string() << '-' << std::hex << std::hash<std::string>{}(path.string()) << ".btc";
+    return (std::filesystem::path(cache_directory_) / name.str()).string();
+  }
+} // bt_ros
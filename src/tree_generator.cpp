@@ -0,0 +1,172 @@
+#include "ros2-behaviortree/tree_generator.hpp"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace bt_ros
+{
+  namespace
+  {
+    // Leaf of generated trees: reads `in`, writes `in + 1` to `out` when remapped
+    class WorkNode : public BT::SyncActionNode
+    {
+    public:
+      WorkNode(const std::string& name, const BT::NodeConfig& config)
+        : BT::SyncActionNode(name, config)
+      {}
+
+      static BT::PortsList providedPorts()
+      {
+        return { BT::InputPort<int>("in"), BT::OutputPort<int>("out") };
+      }
+
+      BT::NodeStatus tick() override
+      {
+        int value = 0;
+        getInput("in", value);
+        setOutput("out", value + 1);
+        return BT::NodeStatus::SUCCESS;
+      }
+    };
+
+    class Generator
+    {
+    public:
+      explicit Generator(const TreeShape& shape)
+        : shape_{shape}
+        , depth_{std::max<std::size_t>(shape.depth, 1)}
+        , fan_out_{std::max<std::size_t>(shape.fan_out, 1)}
+        , keys_{std::max<std::size_t>(shape.blackboard_keys, 1)}
+        , density_{std::clamp(shape.remap_density, 0.0, 1.0)}
+        , leaf_{0}
+      {}
+
+      GeneratedTree generate()
+      {
+        std::string main_body;
+        sequence(main_body, 0, 2);
+
+        GeneratedTree result;
+        result.xml = "<root BTCPP_format=\"4\" main_tree_to_execute=\"MainTree\">\n";
+        result.xml += "  <BehaviorTree ID=\"MainTree\">\n" + main_body + "  </BehaviorTree>\n";
+        for (const auto& [level, body] : subtrees_)
+        {
+          result.xml += "  <BehaviorTree ID=\"" + subtreeID(level) + "\">\n" + body + "  </BehaviorTree>\n";
+        }
+        result.xml += "</root>\n";
+
+        count(0, result, 1);
+        return result;
+      }
+
+    private:
+      bool isSubtree(std::size_t level) const
+      {
+        return level > 0 && level < depth_ && shape_.subtree_every && 0 == level % shape_.subtree_every;
+      }
+
+      static std::string subtreeID(std::size_t level)
+      {
+        return "Level" + std::to_string(level);
+      }
+
+      static void indent(std::string& out, std::size_t depth)
+      {
+        out.append(2 * depth, ' ');
+      }
+
+      void sequence(std::string& out, std::size_t level, std::size_t depth)
+      {
+        indent(out, depth);
+        out += "<Sequence>\n";
+        for (std::size_t i = 0; i < fan_out_; ++i)
+        {
+          child(out, level + 1, depth + 1);
+        }
+        indent(out, depth);
+        out += "</Sequence>\n";
+      }
+
+      void child(std::string& out, std::size_t level, std::size_t depth)
+      {
+        if (level >= depth_)
+        {
+          leaf(out, depth);
+        }
+        else if (isSubtree(level))
+        {
+          if (!subtrees_.count(level))
+          {
+            // Reserve the slot first, the body may define deeper subtrees
+            subtrees_[level];
+            std::string body;
+            sequence(body, level, 2);
+            subtrees_[level] = std::move(body);
+          }
+          indent(out, depth);
+          out += "<SubTree ID=\"" + subtreeID(level) + "\" _autoremap=\"true\"/>\n";
+        }
+        else
+        {
+          sequence(out, level, depth);
+        }
+      }
+
+      void leaf(std::string& out, std::size_t depth)
+      {
+        // Spread the remapped leaves evenly: leaf n is remapped when floor(n * density) steps
+        const auto n = static_cast<double>(leaf_);
+        const bool remapped = std::floor((n + 1) * density_) > std::floor(n * density_);
+        indent(out, depth);
+        if (remapped)
+        {
+          out += "<Work in=\"{key_" + std::to_string(leaf_ % keys_) + "}\" out=\"{key_" +
+              std::to_string((leaf_ + 1) % keys_) + "}\"/>\n";
+        }
+        else
+        {
+          out += "<Work in=\"1\"/>\n";
+        }
+        ++leaf_;
+      }
+
+      // Instances below a node of `level`, `multiplicity` of them
+      void count(std::size_t level, GeneratedTree& result, std::size_t multiplicity) const
+      {
+        if (level >= depth_)
+        {
+          result.nodes += multiplicity;
+          result.leaves += multiplicity;
+          return;
+        }
+        if (isSubtree(level))
+        {
+          result.nodes += multiplicity;
+          result.subtree_instances += multiplicity;
+        }
+        result.nodes += multiplicity;
+        count(level + 1, result, multiplicity * fan_out_);
+      }
+
+      const TreeShape& shape_;
+      const std::size_t depth_;
+      const std::size_t fan_out_;
+      const std::size_t keys_;
+      const double density_;
+      std::size_t leaf_;
+      std::map<std::size_t, std::string> subtrees_;
+    };
+  } // anonymous namespace
+
+  GeneratedTree generateTree(const TreeShape& shape)
+  {
+    return Generator{shape}.generate();
+  }
+
+  void registerGeneratedNodes(BT::BehaviorTreeFactory& factory)
+  {
+    factory.registerNodeType<WorkNode>("Work");
+  }
+} // bt_ros
@@ -0,0 +1,236 @@
+#include "ros2-behaviortree/tree_pool.hpp"
+
+// STL
+#include <exception>
+#include <unordered_set>
+
+#include "ros2-behaviortree/async_log.hpp"
+
+namespace bt_ros
+{
+  struct PooledTree::Instance
+  {
+    struct SavedEntry
+    {
+      BT::TypeInfo info;
+      BT::Any value;
+    };
+
+    // Entries a blackboard owned right after construction
+    struct Snapshot
+    {
+      BT::Blackboard::Ptr blackboard;
+      std::unordered_map<std::string, SavedEntry> entries;
+    };
+
+    Instance(std::string ID, BT::Tree built)
+      : tree_ID{std::move(ID)}
+      , tree{std::move(built)}
+    {
+      std::unordered_set<const BT::Blackboard*> seen;
+      for (const auto& subtree : tree.subtrees)
+      {
+        if (!subtree->blackboard || !seen.insert(subtree->blackboard.get()).second)
+        {
+          continue;
+        }
+        auto& snapshot = blackboards.emplace_back();
+        snapshot.blackboard = subtree->blackboard;
+        for (const auto key : subtree->blackboard->getKeys())
+        {
+          const std::string entry_name{key};
+          if (const auto entry = subtree->blackboard->getEntry(entry_name))
+          {
+            std::scoped_lock lock{entry->entry_mutex};
+            snapshot.entries.emplace(entry_name, SavedEntry{entry->info, entry->value});
+          }
+        }
+      }
+      for (const auto& subtree : tree.subtrees)
+      {
+        for (const auto& node : subtree->nodes)
+        {
+          if (auto resettable = dynamic_cast<ResettableNode*>(node.get()))
+          {
+            resettable_nodes.push_back(resettable);
+          }
+        }
+      }
+    }
+
+    void reset()
+    {
+      tree.haltTree();
+      for (auto& snapshot : blackboards)
+      {
+        auto& blackboard = *snapshot.blackboard;
+        std::vector<std::string> added;
+        for (const auto key : blackboard.getKeys())
+        {
+          if (0 == snapshot.entries.count(std::string(key)))
+          {
+            added.emplace_back(key);
+          }
+        }
+        for (const auto& key : added)
+        {
+          blackboard.unset(key);
+        }
+        for (const auto& [key, saved] : snapshot.entries)
+        {
+          auto entry = blackboard.getEntry(key);
+          if (!entry)
+          {
+            // Unset by the tree itself
+            blackboard.createEntry(key, saved.info);
+            entry = blackboard.getEntry(key);
+          }
+          std::scoped_lock lock{entry->entry_mutex};
+          entry->info = saved.info;
+          entry->value = saved.value;
+        }
+      }
+      for (auto node : resettable_nodes)
+      {
+        node->resetState();
+      }
+    }
+
+    std::string tree_ID;
+    BT::Tree tree;
+    std::vector<Snapshot> blackboards;
+    std::vector<ResettableNode*> resettable_nodes;
+  };
+
+  PooledTree::PooledTree(TreePool* pool, std::unique_ptr<Instance> instance)
+    : pool_{pool}
+    , instance_{std::move(instance)}
+  {}
+
+  PooledTree::PooledTree(PooledTree&& other) noexcept
+    : pool_{other.pool_}
+    , instance_{std::move(other.instance_)}
+  {}
+
+  PooledTree& PooledTree::operator=(PooledTree&& other) noexcept
+  {
+    if (this != &other)
+    {
+      release();
+      pool_ = other.pool_;
+      instance_ = std::move(other.instance_);
+    }
+    return *this;
+  }
+
+  PooledTree::~PooledTree()
+  {
+    release();
+  }
+
+  BT::Tree& PooledTree::tree()
+  {
+    if (!instance_)
+    {
+      throw BT::RuntimeError("PooledTree: the tree was released");
+    }
+    return instance_->tree;
+  }
+
+  void PooledTree::release()
+  {
+    if (instance_)
+    {
+      pool_->giveBack(std::move(instance_));
+    }
+  }
+
+  TreePool::TreePool(BT::BehaviorTreeFactory& factory)
+    : TreePool([&factory](const std::string& tree_ID) { return factory.createTree(tree_ID, BT::Blackboard::create()); })
+  {}
+
+  TreePool::TreePool(Builder builder)
+    : builder_{std::move(builder)}
+  {}
+
+  TreePool::~TreePool() = default;
+
+  void TreePool::reserve(const std::string& tree_ID, std::size_t count)
+  {
+    while (idle(tree_ID) < count)
+    {
+      auto instance = build(tree_ID);
+      std::scoped_lock lock{mutex_};
+      idle_[tree_ID].push_back(std::move(instance));
+    }
+  }
+
+  PooledTree TreePool::acquire(const std::string& tree_ID)
+  {
+    {
+      std::scoped_lock lock{mutex_};
+      const auto it = idle_.find(tree_ID);
+      if (idle_.end() != it && !it->second.empty())
+      {
+        auto instance = std::move(it->second.back());
+        it->second.pop_back();
+        return PooledTree{this, std::move(instance)};
+      }
+    }
+    // Built outside of the lock, other trees can still be handed out meanwhile
+    return PooledTree{this, build(tree_ID)};
+  }
+
+  std::size_t TreePool::idle(const std::string& tree_ID) const
+  {
+    std::scoped_lock lock{mutex_};
+    const auto it = idle_.find(tree_ID);
+    return idle_.end() == it ? 0 : it->second.size();
+  }
+
+  std::size_t TreePool::built() const
+  {
+    std::scoped_lock lock{mutex_};
+    return built_;
+  }
+
+  std::size_t TreePool::dropped() const
+  {
+    std::scoped_lock lock{mutex_};
+    return dropped_;
+  }
+
+  std::unique_ptr<PooledTree::Instance> TreePool::build(const std::string& tree_ID)
+  {
+    std::unique_ptr<PooledTree::Instance> instance;
+    {
+      // The factory is not meant to build several trees at once
+      std::scoped_lock build_lock{build_mutex_};
+      instance = std::make_unique<PooledTree::Instance>(tree_ID, builder_(tree_ID));
+    }
+    std::scoped_lock lock{mutex_};
+    ++built_;
+    return instance;
+  }
+
+  void TreePool::giveBack(std::unique_ptr<PooledTree::Instance> instance)
+  {
+    // Reset by the releasing thread, acquire() stays a pop
+    try
+    {
+      instance->reset();
+    }
+    catch (const std::exception& error)
+    {
+      // Called from a destructor, a tree that cannot be reset is dropped
+      logError("TreePool: dropping an instance of tree [", instance->tree_ID, "], its reset failed: ",
+          error.what());
+      std::scoped_lock lock{mutex_};
+      ++dropped_;
+      return;
+    }
+    std::scoped_lock lock{mutex_};
+    auto& idle = idle_[instance->tree_ID];
+    idle.push_back(std::move(instance));
+  }
+} // bt_ros
@@ -9,11 +9,12 @@
 
 // STL
 #include <string>
-#include <iostream>
 
 // ROS2
 #include <rclcpp/rclcpp.hpp>
 
+#include "ros2-behaviortree/async_log.hpp"
+
 // Example of custom synchronous action
 // without ports!
 class ApproachObject : public BT::SyncActionNode
@@ -25,7 +26,7 @@ public:
 
   BT::NodeStatus tick() override
   {
-    std::cout << "[Inherit Method] ApproachObject Node: " << this->name() << '\n';
+    bt_ros::logInfo("[Inherit Method] ApproachObject Node: ", this->name());
     return BT::NodeStatus::SUCCESS;
   }
 };
@@ -33,7 +34,7 @@ public:
 // Simple funciton
 BT::NodeStatus CheckBattery()
 {
-  std::cout << "[Lambda Method] Battery: OK" << '\n';
+  bt_ros::logInfo("[Lambda Method] Battery: OK");
   return BT::NodeStatus::SUCCESS;
 }
 
@@ -46,14 +47,14 @@ public:
   BT::NodeStatus openGripper()
   {
     is_open_ = true;
-    std::cout << "[Class Method] GripperInterface::open" << '\n';
+    bt_ros::logInfo("[Class Method] GripperInterface::open");
     return BT::NodeStatus::SUCCESS;
   }
 
   BT::NodeStatus closeGripper()
   {
     is_open_ = false;
-    std::cout << "[Class Method] GripperInterface::close" << '\n';
+    bt_ros::logInfo("[Class Method] GripperInterface::close");
     return BT::NodeStatus::SUCCESS;
   }
 
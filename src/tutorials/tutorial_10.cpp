@@ -12,6 +12,9 @@
 #include <string>
 #include <map>
 
+#include "ros2-behaviortree/chrome_tracer.hpp"
+#include "ros2-behaviortree/tick_profiler.hpp"
+
 // class AlwaysSuccessNode : public BT::SyncActionNode
 // {
 // public:
@@ -61,6 +64,14 @@ int main (int argc, char *argv[])
   // a certain set of transitions has happened as expected
   BT::TreeObserver observer{tree};
 
+  // The observer counts transitions but does not time them, the tick
+  // profiler keeps a latency histogram of every node: tick() or onStart()
+  // when ticked from IDLE, onRunning() when ticked while RUNNING
+  bt_ros::TickHooks hooks{tree};
+  bt_ros::TickProfiler profiler{hooks};
+  // The same ticks as nested slices, to open in chrome://tracing or ui.perfetto.dev
+  bt_ros::ChromeTracer tracer{hooks};
+
   // Print the unique ID the corresponding human readable path
   // Path is also expected to be unique
   std::map<uint16_t, std::string> ordered_UID_to_path;
@@ -75,6 +86,7 @@ int main (int argc, char *argv[])
   }
 
   tree.tickWhileRunning();
+  tracer.write("/tmp/ros2-behaviortree/tutorial_10.json");
 
   // You may access a specific statistic, using its full path or the UID
   const auto& last_action_stats = observer.getStatistics("last_action");
@@ -93,5 +105,22 @@ int main (int argc, char *argv[])
         << std::endl;
   }
 
+  std::cout << "--------------------" << std::endl;
+  // print tick latencies, p50/p99/max in microseconds
+  for (const auto& latency : profiler.collect())
+  {
+    const auto us = [](std::chrono::nanoseconds value){ return value.count() / 1000.0; };
+    std::cout << "[" << latency.path
+        << "] \tstart N/p50/p99/max: " << latency.start.count
+        << "/" << us(latency.start.p50)
+        << "/" << us(latency.start.p99)
+        << "/" << us(latency.start.max)
+        << " \trunning N/p50/p99/max: " << latency.running.count
+        << "/" << us(latency.running.p50)
+        << "/" << us(latency.running.p99)
+        << "/" << us(latency.running.max)
+        << std::endl;
+  }
+
   return EXIT_SUCCESS;
 }
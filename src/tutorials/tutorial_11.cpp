@@ -12,6 +12,8 @@
 #include <fstream>
 #include <string>
 
+#include "ros2-behaviortree/async_log.hpp"
+
 class SaySomethingNode : public BT::SyncActionNode
 {
 public:
@@ -36,7 +38,7 @@ public:
       throw BT::RuntimeError("missing required input [message]: ", msg.error());
     }
     // Use the msg value
-    std::cout << "Robot says: " << msg.value() << '\n';
+    bt_ros::logInfo("Robot says: ", msg.value());
     return BT::NodeStatus::SUCCESS;
   }
 };
@@ -51,7 +53,7 @@ int main (int argc, char *argv[])
   factory.registerSimpleAction("TestAction",
       [](BT::TreeNode& self)
       {
-        std::cout << "TestAction substituting: " << self.name() << std::endl;
+        bt_ros::logInfo("TestAction substituting: ", self.name());
         return BT::NodeStatus::SUCCESS;
       }
     );
@@ -66,7 +68,7 @@ int main (int argc, char *argv[])
         {
           throw BT::RuntimeError("missing required input [message]: ", msg.error());
         }
-        std::cout << "TestSaySomething: " << msg.value() << std::endl;
+        bt_ros::logInfo("TestSaySomething: ", msg.value());
         return BT::NodeStatus::SUCCESS;
       }
     );
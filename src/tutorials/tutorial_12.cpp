@@ -0,0 +1,115 @@
+/**
+ * tutorial 12
+ * Non-blocking ROS action client node
+ * Uses bt_ros::RosActionClientNode against a local bt_ros::FakeActionServer
+ */
+
+// ROS2
+#include <rclcpp/rclcpp.hpp>
+#include <example_interfaces/action/fibonacci.hpp>
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "ros2-behaviortree/async_log.hpp"
+#include "ros2-behaviortree/behaviortree_action_template.hpp"
+#include "ros2-behaviortree/fake_action_server.hpp"
+
+using Fibonacci = example_interfaces::action::Fibonacci;
+
+class FibonacciActionNode : public bt_ros::RosActionClientNode<Fibonacci>
+{
+public:
+  FibonacciActionNode(const std::string& name,
+      const BT::NodeConfig& config,
+      rclcpp::Node::SharedPtr node)
+    : bt_ros::RosActionClientNode<Fibonacci>(name, config, node, "fibonacci")
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<int>("order") };
+  }
+
+  bool setGoal(Goal& goal) override
+  {
+    auto order = getInput<int>("order");
+    if (!order)
+    {
+      return false;
+    }
+    goal.order = order.value();
+    return true;
+  }
+
+  BT::NodeStatus onResult(const WrappedResult& result) override
+  {
+    if (rclcpp_action::ResultCode::SUCCEEDED != result.code)
+    {
+      return BT::NodeStatus::FAILURE;
+    }
+    bt_ros::logInfo("[Fibonacci] received ", result.result->sequence.size(), " numbers");
+    return BT::NodeStatus::SUCCESS;
+  }
+};
+
+static const char* xml_text = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Fibonacci order="5"/>
+      <Fibonacci order="10"/>
+    </Sequence>
+  </BehaviorTree>
+</root>
+)";
+
+int main (int argc, char *argv[])
+{
+  rclcpp::init(argc, argv);
+  auto node = std::make_shared<rclcpp::Node>("tutorial_12");
+
+  // The server answers after 200ms and fills the sequence up to the goal order
+  bt_ros::FakeActionServer<Fibonacci> server{node, "fibonacci", std::chrono::milliseconds(200),
+    [](const Fibonacci::Goal& goal, Fibonacci::Result& result)
+    {
+      result.sequence = {0, 1};
+      for (int i = 2; i < goal.order; ++i)
+      {
+        result.sequence.push_back(result.sequence[i - 1] + result.sequence[i - 2]);
+      }
+    }};
+
+  // Responses are processed by the executor thread, ticks never block on them
+  rclcpp::executors::MultiThreadedExecutor executor;
+  executor.add_node(node);
+  auto t = std::thread([&executor](){ executor.spin(); });
+
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<FibonacciActionNode>("Fibonacci", node);
+  auto tree = factory.createTreeFromText(xml_text);
+
+  // The server may need a moment to be discovered
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  auto status = tree.tickOnce();
+  while (BT::NodeStatus::RUNNING == status && rclcpp::ok())
+  {
+    // Woken up as soon as the action server answers
+    tree.sleep(std::chrono::milliseconds(100));
+    status = tree.tickOnce();
+  }
+  bt_ros::logInfo("--- status: ", BT::toStr(status));
+
+  executor.cancel();
+  t.join();
+  rclcpp::shutdown();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,78 @@
+/**
+ * tutorial 13
+ * Hot reload of XML trees
+ * Ticks the trees of tutorial 7 and swaps in the SubTrees edited meanwhile, try
+ * changing a message of ./config/behaviortree/tutorial_7/subtree_B.xml while it runs
+ */
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "ros2-behaviortree/async_log.hpp"
+#include "ros2-behaviortree/hot_reloader.hpp"
+
+class SaySomethingNode : public BT::SyncActionNode
+{
+public:
+  SaySomethingNode(const std::string& name, const BT::NodeConfig& config)
+    : BT::SyncActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<std::string>("message") };
+  }
+
+  BT::NodeStatus tick() override
+  {
+    BT::Expected<std::string> msg = getInput<std::string>("message");
+    if (!msg)
+    {
+      throw BT::RuntimeError("missing required input [message]: ", msg.error());
+    }
+    bt_ros::logInfo("Robot says: ", msg.value());
+    return BT::NodeStatus::SUCCESS;
+  }
+};
+
+int main (int argc, char *argv[])
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<SaySomethingNode>("SaySomething");
+
+  // Watches the directory, the tree is only replaced when we ask for it
+  bt_ros::TreeHotReloader reloader{factory, "./config/behaviortree/tutorial_7",
+    "/tmp/ros2-behaviortree/tutorial_13", "MainTree"};
+
+  for (int tick = 0; tick < 120; ++tick)
+  {
+    bt_ros::logInfo("\n--- tick ", tick, " ---");
+    reloader.tree().tickOnce();
+
+    // Between two ticks is the only safe place to swap the tree
+    if (reloader.applyPendingChanges())
+    {
+      const auto& reload = reloader.lastReload();
+      std::string changed;
+      for (const auto& ID : reload.changed_trees)
+      {
+        changed += " " + ID;
+      }
+      bt_ros::logInfo("Reloaded in ", std::chrono::duration_cast<std::chrono::microseconds>(reload.duration).count(),
+        " us, changed:", changed, reload.swapped ? ", tree replaced, " : ", tree not affected, ",
+        reload.reused_subtrees, " subtree(s) kept");
+      if (!reload.error.empty())
+      {
+        bt_ros::logInfo("Reload failed, keeping the running tree: ", reload.error);
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  }
+
+  return EXIT_SUCCESS;
+}
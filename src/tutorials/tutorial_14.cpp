@@ -0,0 +1,86 @@
+/**
+ * tutorial 14
+ * Ticking CPU-bound synchronous children in parallel
+ * A Parallel node ticks its children one after another on the tick thread,
+ * ThreadPoolParallel sends its SyncActionNode children to a thread pool
+ */
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <chrono>
+#include <cmath>
+#include <string>
+
+#include "ros2-behaviortree/async_log.hpp"
+#include "ros2-behaviortree/thread_pool_parallel_node.hpp"
+
+// Stands for a perception check, a few ms of computation independent from the others
+class CheckRegionNode : public BT::SyncActionNode
+{
+public:
+  CheckRegionNode(const std::string& name, const BT::NodeConfig& config)
+    : BT::SyncActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<int>("samples", 2000000, "amount of work") };
+  }
+
+  BT::NodeStatus tick() override
+  {
+    int samples = 0;
+    getInput("samples", samples);
+    double sum = 0.0;
+    for (int i = 0; i < samples; ++i)
+    {
+      sum += std::sqrt(static_cast<double>(i));
+    }
+    return sum >= 0.0 ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
+  }
+};
+
+static const char* xml_text = R"(
+ <root BTCPP_format="4" >
+     <BehaviorTree ID="SerialChecks">
+        <Parallel success_count="-1" failure_count="1">
+            <CheckRegion name="front"/>
+            <CheckRegion name="left"/>
+            <CheckRegion name="right"/>
+            <CheckRegion name="back"/>
+        </Parallel>
+     </BehaviorTree>
+     <BehaviorTree ID="PooledChecks">
+        <ThreadPoolParallel success_count="-1" failure_count="1">
+            <CheckRegion name="front"/>
+            <CheckRegion name="left"/>
+            <CheckRegion name="right"/>
+            <CheckRegion name="back"/>
+        </ThreadPoolParallel>
+     </BehaviorTree>
+ </root>
+ )";
+
+int main (int argc, char *argv[])
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<CheckRegionNode>("CheckRegion");
+  // Uses bt_ros::WorkStealingPool::shared(), pass std::ref(pool) as extra argument to use another one
+  factory.registerNodeType<bt_ros::ThreadPoolParallelNode>("ThreadPoolParallel");
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  bt_ros::logInfo("Pool threads: ", bt_ros::WorkStealingPool::shared().threadCount(), " + the tick thread");
+  for (const std::string tree_ID : {"SerialChecks", "PooledChecks"})
+  {
+    auto tree = factory.createTree(tree_ID);
+    const auto start = std::chrono::steady_clock::now();
+    const auto status = tree.tickWhileRunning();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    bt_ros::logInfo(tree_ID, ": ", BT::toStr(status), " in ", elapsed.count(), " us");
+  }
+
+  return EXIT_SUCCESS;
+}
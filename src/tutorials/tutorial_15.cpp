@@ -0,0 +1,138 @@
+/**
+ * tutorial 15
+ * Running the tutorial 4 mission on many robots from a few threads
+ * Each robot has its own tree, MultiTreeExecutor ticks all of them on a
+ * handful of worker threads and skips the trees waiting on MoveBase
+ */
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ros2-behaviortree/async_log.hpp"
+#include "ros2-behaviortree/cached_input.hpp"
+#include "ros2-behaviortree/custom_types.hpp"
+#include "ros2-behaviortree/deadline_service.hpp"
+#include "ros2-behaviortree/multi_tree_executor.hpp"
+
+using bt_ros::Pose2D;
+
+// Same as tutorial 4, quiet since hundreds of them run at once
+class MoveBaseActionNode : public BT::StatefulActionNode
+{
+public:
+  MoveBaseActionNode(const std::string& name, const BT::NodeConfig& config, bt_ros::DeadlineService& deadlines)
+    : BT::StatefulActionNode(name, config)
+    , goal_input_{*this, "goal"}
+    , completion_timer_{deadlines}
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<Pose2D>("goal") };
+  }
+
+  BT::NodeStatus onStart() override
+  {
+    auto goal = goal_input_.get();
+    if (!goal)
+    {
+      throw BT::RuntimeError("missing required input [goal]: ", goal.error());
+    }
+    // Pretend the robot needs 200ms to get there
+    completion_timer_.start(*this, std::chrono::milliseconds(200));
+    return BT::NodeStatus::RUNNING;
+  }
+
+  BT::NodeStatus onRunning() override
+  {
+    return completion_timer_.expired() ? BT::NodeStatus::SUCCESS : BT::NodeStatus::RUNNING;
+  }
+
+  void onHalted() override
+  {
+    completion_timer_.cancel();
+  }
+
+private:
+  bt_ros::CachedInput<Pose2D> goal_input_;
+  bt_ros::DeadlineTimer completion_timer_;
+};
+
+// Checks its message but keeps it to itself
+class SaySomethingNode : public BT::SyncActionNode
+{
+public:
+  SaySomethingNode(const std::string& name, const BT::NodeConfig& config)
+    : BT::SyncActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<std::string>("message") };
+  }
+
+  BT::NodeStatus tick() override
+  {
+    BT::Expected<std::string> msg = getInput<std::string>("message");
+    if (!msg)
+    {
+      throw BT::RuntimeError("missing required input [message]: ", msg.error());
+    }
+    return BT::NodeStatus::SUCCESS;
+  }
+};
+
+int main (int argc, char *argv[])
+{
+  const std::size_t robots = argc > 1 ? std::stoul(argv[1]) : 500;
+
+  bt_ros::MultiTreeExecutor executor;
+
+  // MoveBase arms its timer on the deadlines of the worker ticking its tree,
+  // so there is one factory per worker
+  std::vector<std::unique_ptr<BT::BehaviorTreeFactory>> factories;
+  for (std::size_t worker = 0; worker < executor.workerCount(); ++worker)
+  {
+    auto factory = std::make_unique<BT::BehaviorTreeFactory>();
+    factory->registerSimpleCondition("BatteryOK", [](BT::TreeNode&){ return BT::NodeStatus::SUCCESS; });
+    factory->registerNodeType<MoveBaseActionNode>("MoveBase", std::ref(executor.deadlines(worker)));
+    factory->registerNodeType<SaySomethingNode>("SaySomething");
+    factories.push_back(std::move(factory));
+  }
+
+  std::atomic<std::size_t> succeeded{0};
+  const auto start = std::chrono::steady_clock::now();
+  for (std::size_t robot = 0; robot < robots; ++robot)
+  {
+    bt_ros::MultiTreeExecutor::TreeOptions options;
+    options.period = std::chrono::milliseconds(10);
+    options.worker = static_cast<int>(executor.leastLoadedWorker());
+    options.on_done = [&succeeded](bt_ros::MultiTreeExecutor::TreeId, BT::NodeStatus status)
+      {
+        if (BT::NodeStatus::SUCCESS == status)
+        {
+          ++succeeded;
+        }
+      };
+    auto tree = factories[options.worker]->createTreeFromFile("./config/behaviortree/tutorial_4.xml");
+    executor.add(std::move(tree), std::move(options));
+  }
+  executor.waitAll();
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+  const auto stats = executor.stats();
+  bt_ros::logInfo(succeeded.load(), "/", robots, " missions completed in ", elapsed.count(), " ms on ",
+      executor.workerCount(), " threads");
+  bt_ros::logInfo("ticks: ", stats.ticks, " parked: ", stats.parked, " woken up: ", stats.wake_ups,
+      " overruns: ", stats.overruns);
+
+  return EXIT_SUCCESS;
+}
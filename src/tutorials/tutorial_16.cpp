@@ -0,0 +1,115 @@
+/**
+ * tutorial 16
+ * Asynchronous action written as a coroutine
+ * The MoveBase of tutorial 4 without onStart/onRunning/onHalted: the body
+ * co_awaits its timer and the tree resumes it once the timer expired
+ */
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <chrono>
+#include <functional>
+#include <string>
+
+#include "ros2-behaviortree/async_log.hpp"
+#include "ros2-behaviortree/coro_action_node.hpp"
+#include "ros2-behaviortree/custom_types.hpp"
+#include "ros2-behaviortree/deadline_service.hpp"
+
+using bt_ros::Pose2D;
+
+class MoveBaseActionNode : public bt_ros::CoroActionNode
+{
+public:
+  MoveBaseActionNode(const std::string& name, const BT::NodeConfig& config, bt_ros::DeadlineService& deadlines)
+    : bt_ros::CoroActionNode(name, config)
+    , deadlines_{deadlines}
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<Pose2D>("goal") };
+  }
+
+private:
+  bt_ros::CoroAction run() override
+  {
+    Pose2D goal;
+    if (!getInput<Pose2D>("goal", goal))
+    {
+      throw BT::RuntimeError("missing required input [goal]");
+    }
+    bt_ros::logInfo("[MoveBase: SEND REQUEST ]. goal: x=", goal.x, " y=", goal.y, " theta=", goal.theta);
+
+    try
+    {
+      // Simulate an action that takes 200ms, no tick resumes the body before
+      co_await sleepFor(deadlines_, std::chrono::milliseconds(200));
+    }
+    catch (const bt_ros::ActionCancelled&)
+    {
+      bt_ros::logInfo("[MoveBase: ABORTED]");
+      throw;
+    }
+
+    bt_ros::logInfo("[MoveBase: FINISHED]");
+    co_return BT::NodeStatus::SUCCESS;
+  }
+
+  bt_ros::DeadlineService& deadlines_;
+};
+
+class SaySomethingNode : public BT::SyncActionNode
+{
+public:
+  SaySomethingNode(const std::string& name, const BT::NodeConfig& config)
+    : BT::SyncActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return { BT::InputPort<std::string>("message") };
+  }
+
+  BT::NodeStatus tick() override
+  {
+    BT::Expected<std::string> msg = getInput<std::string>("message");
+    if (!msg)
+    {
+      throw BT::RuntimeError("missing required input [message]: ", msg.error());
+    }
+    bt_ros::logInfo("Robot says: ", msg.value());
+    return BT::NodeStatus::SUCCESS;
+  }
+};
+
+int main (int argc, char *argv[])
+{
+  // Deadlines of the asynchronous nodes, it must outlive the tree
+  bt_ros::DeadlineService deadlines;
+
+  BT::BehaviorTreeFactory factory;
+  factory.registerSimpleCondition("BatteryOK", [](BT::TreeNode&){ return BT::NodeStatus::SUCCESS; });
+  factory.registerNodeType<MoveBaseActionNode>("MoveBase", std::ref(deadlines));
+  factory.registerNodeType<SaySomethingNode>("SaySomething");
+
+  auto tree = factory.createTreeFromFile("./config/behaviortree/tutorial_4.xml");
+
+  bt_ros::logInfo("--- ticking");
+  auto status = tree.tickOnce();
+  bt_ros::logInfo("--- status: ", BT::toStr(status), "\n");
+
+  while (BT::NodeStatus::RUNNING == status)
+  {
+    // Sleep until the timer of MoveBase fires
+    deadlines.sleep(tree, std::chrono::seconds(1));
+
+    bt_ros::logInfo("--- ticking");
+    status = tree.tickOnce();
+    bt_ros::logInfo("--- status: ", BT::toStr(status), "\n");
+  }
+
+  return EXIT_SUCCESS;
+}
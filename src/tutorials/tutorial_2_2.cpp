@@ -10,6 +10,8 @@
 // STL
 #include <string>
 
+#include "ros2-behaviortree/async_log.hpp"
+
 class ThoughtsInterface
 {
 public:
@@ -25,7 +27,7 @@ public:
       throw BT::RuntimeError("missing required input [message]: ", msg.error());
     }
     // Use the msg value
-    std::cout << "Robot says: " << msg.value() << '\n';
+    bt_ros::logInfo("Robot says: ", msg.value());
     return BT::NodeStatus::SUCCESS;
   }
 
@@ -10,31 +10,11 @@
 // STL
 #include <string>
 
-// Custom type
-struct Position2D
-{
-  float x;
-  float y;
-};
+#include "ros2-behaviortree/async_log.hpp"
+#include "ros2-behaviortree/custom_types.hpp"
 
-// To allow xml loader to instantiate a `Position2D` from a string, we need to provide
-// a template specialization of `BT::convertFromString<Position2D>(StringView)`
-namespace BT
-{
-  template <> inline Position2D convertFromString(StringView str)
-  {
-    // We expect real numbers separeted by semicolons
-    auto parts = splitString(str, ';');
-    if (2 != parts.size())
-    {
-      throw RuntimeError("invalid input");
-    }
-    else
-    {
-      return {convertFromString<float>(parts[0]), convertFromString<float>(parts[1])};
-    }
-  }
-} // end namespace BT
+// Custom type, with its string conversion in custom_types.hpp
+using bt_ros::Position2D;
 
 class CalculateGoalNode : public BT::SyncActionNode
 {
@@ -77,7 +57,7 @@ public:
       throw BT::RuntimeError("Error reading port [target]: ", res.error());
     }
     Position2D target = res.value();
-    std::cout << "Target position: (" << target.x << ", " << target.y << ")\n";
+    bt_ros::logInfo("Target position: (", target.x, ", ", target.y, ")");
     return BT::NodeStatus::SUCCESS;
   }
 };
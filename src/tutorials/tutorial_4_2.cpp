@@ -1,7 +1,8 @@
 /**
- * tutorial 4_2 (NOT WORKING, for reference only!)
+ * tutorial 4_2
  * Reactive and Asynchronous behaviors
  * https://www.behaviortree.dev/docs/tutorial-basics/tutorial_04_sequence
+ * MoveBase is a plain class, bt_ros::StatefulAdapter turns it into a node
  */
 
 // BT
@@ -9,180 +10,82 @@
 
 // STL
 #include <chrono>
+#include <functional>
 #include <string>
-#include <iostream>
-#include <thread>
 
-// Custom type
-struct Pose2D
-{
-  float x, y, theta;
-};
+#include "ros2-behaviortree/async_log.hpp"
+#include "ros2-behaviortree/custom_types.hpp"
+#include "ros2-behaviortree/deadline_service.hpp"
+#include "ros2-behaviortree/stateful_adapter.hpp"
 
-class BTStateWrapper : public BT::StatefulActionNode
-{
-public:
-  BTStateWrapper(const std::string& name, const BT::NodeConfig& config)
-  : BT::StatefulActionNode{name, config}
-  {}
-  virtual ~BTStateWrapper();
+// Custom type, with its string conversion in custom_types.hpp
+using bt_ros::Pose2D;
 
-  // It is mandatory to define this static method
-  static BT::PortsList providedPorts()
-  {
-    return { BT::InputPort<Pose2D>("goal") };
-  }
-
-
-  // This method is invoked once in the beginning
-  BT::NodeStatus onStart() override
-  {
-    if (callback_on_start_)
-    {
-      if (!getInput<Pose2D>("goal", goal_))
-      {
-        throw BT::RuntimeError("missing required input [goal]");
-      }
-      return callback_on_start_(goal_);
-    }
-    else
-    {
-      std::cout << "BTStateWrapper: invalid callback on start." << '\n';
-      return BT::NodeStatus::FAILURE;
-    }
-  }
-
-  // If onStart() returned RUNNING, then we will keep calling
-  // this method until it return something different than RUNNING
-  BT::NodeStatus onRunning() override
-  {
-    if (callback_on_running_)
-    {
-      return callback_on_running_();
-    }
-    else
-    {
-      std::cout << "BTStateWrapper: invalid callback on running." << '\n';
-      return BT::NodeStatus::FAILURE;
-    }
-  }
-
-  // Callback to execute if the action was aborted by another node
-  void onHalted() override
-  {
-    if (callback_on_halted_)
-    {
-      callback_on_halted_();
-    }
-    else
-    {
-      std::cout << "BTStateWrapper: invalid callback on running." << '\n';
-    }
-  }
-
-  // Methods to register callbacks
-  void addCBOnStart(std::function<BT::NodeStatus(Pose2D &goal)> callback)
-  {
-    callback_on_start_ = callback;
-  }
-
-  void addCBOnRunning(std::function<BT::NodeStatus()> callback)
-  {
-    callback_on_running_ = callback;
-  }
-
-  void addCBOnHalted(std::function<void()> callback)
-  {
-    callback_on_halted_ = callback;
-  }
-
-private:
-  std::function<BT::NodeStatus(Pose2D &goal)> callback_on_start_;
-  std::function<BT::NodeStatus()> callback_on_running_;
-  std::function<void()>           callback_on_halted_;
-  Pose2D goal_;
-};
-
-class MoveBaseActionNode
+// Not a TreeNode, the adapter owns one per node of the tree
+class MoveBaseAction
 {
 public:
-  // Any node with ports must have at least one constructor with this signature
-  MoveBaseActionNode(const std::string& name, const BT::NodeConfig& config)
-    : bt_wrapper_{name, config}
+  // Built from the extra arguments given to registerNodeType()
+  explicit MoveBaseAction(bt_ros::DeadlineService& deadlines)
+    : completion_timer_{deadlines}
   {}
 
-  // It is mandatory to define this static method
+  // Ports of the node
   static BT::PortsList providedPorts()
   {
     return { BT::InputPort<Pose2D>("goal") };
   }
 
-  BT::NodeStatus onStart(Pose2D &goal);
+  BT::NodeStatus onStart(BT::StatefulActionNode& self);
   BT::NodeStatus onRunning();
   void onHalted();
 
 private:
-  std::chrono::system_clock::time_point completion_time_;
-  BTStateWrapper bt_wrapper_;
+  bt_ros::DeadlineTimer completion_timer_;
 };
 
+// Checked at compile time, a missing or mistyped member fails here
+static_assert(bt_ros::StatefulBehavior<MoveBaseAction>);
+
 // IMPLEMENTATION
-BT::NodeStatus MoveBaseActionNode::onStart(Pose2D &goal)
+BT::NodeStatus MoveBaseAction::onStart(BT::StatefulActionNode& self)
 {
-  std::cout << "[MoveBase: SEND REQUEST ]. goal: x=" << goal.x
-    << " y=" << goal.y << " theta=" << goal.theta << "\n";
+  Pose2D goal;
+  if (!self.getInput<Pose2D>("goal", goal))
+  {
+    throw BT::RuntimeError("missing required input [goal]");
+  }
+  bt_ros::logInfo("[MoveBase: SEND REQUEST ]. goal: x=", goal.x, " y=", goal.y, " theta=", goal.theta);
 
-  // We use this counter to simulate an action that takes a certain
+  // We use this timer to simulate an action that takes a certain
   // amount of time to be completed (200ms)
-  completion_time_ = std::chrono::system_clock::now() + std::chrono::milliseconds(200);
+  completion_timer_.start(self, std::chrono::milliseconds(200));
 
   return BT::NodeStatus::RUNNING;
 }
 
-BT::NodeStatus MoveBaseActionNode::onRunning()
+BT::NodeStatus MoveBaseAction::onRunning()
 {
-  // Pretend that we are checking if the reply has been received
-  // try no to block inside this function for too much time
-  std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
-  // Pretend after a certain amount of time,
-  // we have completed the operation
-  if (std::chrono::system_clock::now() >= completion_time_)
+  // Pretend that we are checking if the reply has been received.
+  // The deadline service wakes the tree up when the timer expires
+  if (completion_timer_.expired())
   {
-    std::cout << "[MoveBase: FINISHED]\n";
+    bt_ros::logInfo("[MoveBase: FINISHED]");
     return BT::NodeStatus::SUCCESS;
   }
   return BT::NodeStatus::RUNNING;
 }
 
-void MoveBaseActionNode::onHalted()
+void MoveBaseAction::onHalted()
 {
-  std::cout << "[MoveBase: ABORTED]";
+  completion_timer_.cancel();
+  bt_ros::logInfo("[MoveBase: ABORTED]");
 }
 
-// To allow xml loader to instantiate a `Position2D` from a string, we need to provide
-// a template specialization of `BT::convertFromString<Position2D>(StringView)`
-namespace BT
-{
-  template <> inline Pose2D convertFromString(StringView str)
-  {
-    // We expect real numbers separeted by semicolons
-    auto parts = splitString(str, ';');
-    if (3 != parts.size())
-    {
-      throw RuntimeError("invalid input");
-    }
-    else
-    {
-      return {convertFromString<float>(parts[0]), convertFromString<float>(parts[1]), convertFromString<float>(parts[2])};
-    }
-  }
-} // end namespace BT
-
 // Simple funciton
 BT::NodeStatus CheckBattery()
 {
-  std::cout << "[Lambda Method] Battery: OK" << '\n';
+  bt_ros::logInfo("[Lambda Method] Battery: OK");
   return BT::NodeStatus::SUCCESS;
 }
 
@@ -210,37 +113,37 @@ public:
       throw BT::RuntimeError("missing required input [message]: ", msg.error());
     }
     // Use the msg value
-    std::cout << "Robot says: " << msg.value() << '\n';
+    bt_ros::logInfo("Robot says: ", msg.value());
     return BT::NodeStatus::SUCCESS;
   }
 };
 
 int main (int argc, char *argv[])
 {
+  // Deadlines of the asynchronous nodes, it must outlive the tree
+  bt_ros::DeadlineService deadlines;
+
   BT::BehaviorTreeFactory factory;
   factory.registerSimpleCondition("BatteryOK", [&](BT::TreeNode&){ return CheckBattery(); });
-  factory.registerNodeType<MoveBaseActionNode>("MoveBase");
+  factory.registerNodeType<bt_ros::StatefulAdapter<MoveBaseAction>>("MoveBase", std::ref(deadlines));
   factory.registerNodeType<SaySomethingNode>("SaySomething");
 
   auto tree = factory.createTreeFromFile("./config/behaviortree/tutorial_4.xml");
 
   // Here instead of tree.tickWhileRunning();
   // we prefer our own loop
-  std::cout << "--- ticking\n";
+  bt_ros::logInfo("--- ticking");
   auto status = tree.tickOnce();
-  std::cout << "--- status: " << BT::toStr(status) << "\n\n";
+  bt_ros::logInfo("--- status: ", BT::toStr(status), "\n");
 
   while (BT::NodeStatus::RUNNING == status)
   {
-    // Sleep to aviod busy loops.
-    // do NOT use other sleep functions!
-    // Small sleep time is alright, for demo purposes we use 
-    // a larger sleep time to have less messages to the console
-    tree.sleep(std::chrono::milliseconds(40));
+    // Sleep until the next deadline fires or a node wakes the tree up
+    deadlines.sleep(tree, std::chrono::seconds(1));
 
-    std::cout << "--- ticking\n";
+    bt_ros::logInfo("--- ticking");
     status = tree.tickOnce();
-    std::cout << "--- status: " << BT::toStr(status) << "\n\n";
+    bt_ros::logInfo("--- status: ", BT::toStr(status), "\n");
   }
 
   return EXIT_SUCCESS;
@@ -9,24 +9,27 @@
 
 // STL
 #include <chrono>
+#include <functional>
 #include <string>
-#include <iostream>
-#include <thread>
 
-// Custom type
-struct Pose2D
-{
-  float x, y, theta;
-};
+#include "ros2-behaviortree/async_log.hpp"
+#include "ros2-behaviortree/cached_input.hpp"
+#include "ros2-behaviortree/custom_types.hpp"
+#include "ros2-behaviortree/deadline_service.hpp"
+
+// Custom type, with its string conversion in custom_types.hpp
+using bt_ros::Pose2D;
 
 class MoveBaseActionNode : public BT::StatefulActionNode
 {
 public:
   // Any node with ports must have at least one constructor with this signature
-  MoveBaseActionNode(const std::string& name, const BT::NodeConfig& config, const std::string &message={})
+  MoveBaseActionNode(const std::string& name, const BT::NodeConfig& config, bt_ros::DeadlineService& deadlines, const std::string &message={})
     : BT::StatefulActionNode(name, config)
+    , goal_input_{*this, "goal"}
     , message_{message}
     , count_{0}
+    , completion_timer_{deadlines}
   {}
 
   // // It is mandatory to define this static method
@@ -47,40 +50,40 @@ public:
 
 private:
   Pose2D goal_;
+  bt_ros::CachedInput<Pose2D> goal_input_;
   std::string message_;
   int count_;
-  std::chrono::system_clock::time_point completion_time_;
+  bt_ros::DeadlineTimer completion_timer_;
 };
 
 // IMPLEMENTATION
 BT::NodeStatus MoveBaseActionNode::onStart()
 {
-  if (!getInput<Pose2D>("goal", goal_))
+  // A literal goal="1;2;3" is only parsed on the first start
+  auto goal = goal_input_.get();
+  if (!goal)
   {
-    throw BT::RuntimeError("missing required input [goal]");
+    throw BT::RuntimeError("missing required input [goal]: ", goal.error());
   }
-  std::cout << "[MoveBase: SEND REQUEST ]. goal: x=" << goal_.x
-    << " y=" << goal_.y << " theta=" << goal_.theta << "\n";
+  goal_ = goal.value();
+  bt_ros::logInfo("[MoveBase: SEND REQUEST ]. goal: x=", goal_.x, " y=", goal_.y, " theta=", goal_.theta);
 
-  // We use this counter to simulate an action that takes a certain
+  // We use this timer to simulate an action that takes a certain
   // amount of time to be completed (200ms)
-  completion_time_ = std::chrono::system_clock::now() + std::chrono::milliseconds(200);
+  completion_timer_.start(*this, std::chrono::milliseconds(200));
 
   return BT::NodeStatus::RUNNING;
 }
 
 BT::NodeStatus MoveBaseActionNode::onRunning()
 {
-  std::cout << "The message: " << message_ << ++count_ << std::endl;
-  // Pretend that we are checking if the reply has been received
-  // try no to block inside this function for too much time
-  std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
-  // Pretend after a certain amount of time,
-  // we have completed the operation
-  if (std::chrono::system_clock::now() >= completion_time_)
+  bt_ros::logInfo("The message: ", message_, ++count_);
+  // Pretend that we are checking if the reply has been received.
+  // The deadline service wakes the tree up when the timer expires,
+  // so there is no need to block or to read the clock here
+  if (completion_timer_.expired())
   {
-    std::cout << "[MoveBase: FINISHED]\n";
+    bt_ros::logInfo("[MoveBase: FINISHED]");
     return BT::NodeStatus::SUCCESS;
   }
   return BT::NodeStatus::RUNNING;
@@ -88,32 +91,14 @@ BT::NodeStatus MoveBaseActionNode::onRunning()
 
 void MoveBaseActionNode::onHalted()
 {
-  std::cout << "[MoveBase: ABORTED]";
+  completion_timer_.cancel();
+  bt_ros::logInfo("[MoveBase: ABORTED]");
 }
 
-// To allow xml loader to instantiate a `Position2D` from a string, we need to provide
-// a template specialization of `BT::convertFromString<Position2D>(StringView)`
-namespace BT
-{
-  template <> inline Pose2D convertFromString(StringView str)
-  {
-    // We expect real numbers separeted by semicolons
-    auto parts = splitString(str, ';');
-    if (3 != parts.size())
-    {
-      throw RuntimeError("invalid input");
-    }
-    else
-    {
-      return {convertFromString<float>(parts[0]), convertFromString<float>(parts[1]), convertFromString<float>(parts[2])};
-    }
-  }
-} // end namespace BT
-
 // Simple funciton
 BT::NodeStatus CheckBattery()
 {
-  std::cout << "[Lambda Method] Battery: OK" << '\n';
+  bt_ros::logInfo("[Lambda Method] Battery: OK");
   return BT::NodeStatus::SUCCESS;
 }
 
@@ -141,37 +126,40 @@ public:
       throw BT::RuntimeError("missing required input [message]: ", msg.error());
     }
     // Use the msg value
-    std::cout << "Robot says: " << msg.value() << '\n';
+    bt_ros::logInfo("Robot says: ", msg.value());
     return BT::NodeStatus::SUCCESS;
   }
 };
 
 int main (int argc, char *argv[])
 {
+  // Deadlines of the asynchronous nodes, it must outlive the tree
+  bt_ros::DeadlineService deadlines;
+
   BT::BehaviorTreeFactory factory;
   factory.registerSimpleCondition("BatteryOK", [&](BT::TreeNode&){ return CheckBattery(); });
-  factory.registerNodeType<MoveBaseActionNode>("MoveBase",  { BT::InputPort<Pose2D>("goal") }, "Come on " );
+  factory.registerNodeType<MoveBaseActionNode>("MoveBase",  { BT::InputPort<Pose2D>("goal") }, std::ref(deadlines), "Come on " );
   factory.registerNodeType<SaySomethingNode>("SaySomething");
 
   auto tree = factory.createTreeFromFile("./config/behaviortree/tutorial_4.xml");
 
   // Here instead of tree.tickWhileRunning();
   // we prefer our own loop
-  std::cout << "--- ticking\n";
+  bt_ros::logInfo("--- ticking");
   auto status = tree.tickOnce();
-  std::cout << "--- status: " << BT::toStr(status) << "\n\n";
+  bt_ros::logInfo("--- status: ", BT::toStr(status), "\n");
 
   while (BT::NodeStatus::RUNNING == status)
   {
     // Sleep to aviod busy loops.
     // do NOT use other sleep functions!
-    // Small sleep time is alright, for demo purposes we use 
-    // a larger sleep time to have less messages to the console
-    tree.sleep(std::chrono::milliseconds(40));
+    // Instead of polling at a fixed period, sleep until the next
+    // deadline fires or a node wakes the tree up
+    deadlines.sleep(tree, std::chrono::seconds(1));
 
-    std::cout << "--- ticking\n";
+    bt_ros::logInfo("--- ticking");
     status = tree.tickOnce();
-    std::cout << "--- status: " << BT::toStr(status) << "\n\n";
+    bt_ros::logInfo("--- status: ", BT::toStr(status), "\n");
   }
 
   return EXIT_SUCCESS;
@@ -10,15 +10,16 @@
 // STL
 #include <chrono>
 #include <string>
-#include <iostream>
-#include <thread>
 
-// Custom type
-struct Pose2D
-{
-  float x, y, theta;
-};
+#include "ros2-behaviortree/async_log.hpp"
+#include "ros2-behaviortree/custom_types.hpp"
+#include "ros2-behaviortree/deadline_service.hpp"
 
+// Custom type, with its string conversion in custom_types.hpp
+using bt_ros::Pose2D;
+
+// Callbacks chosen at run time, each call goes through a std::function.
+// bt_ros::StatefulAdapter (tutorial 4_2) binds a class at compile time instead
 class BTStatefulWrapper : public BT::StatefulActionNode
 {
 public:
@@ -38,14 +39,13 @@ public:
   // This method is invoked once in the beginning
   BT::NodeStatus onStart() override
   {
-    std::cout << "BTWrapper - " << __func__ << std::endl;
     if (callback_on_start_)
     {
       return callback_on_start_(this);
     }
     else
     {
-      std::cout << "BTStateWrapper: invalid callback on start." << '\n';
+      bt_ros::logInfo("BTStateWrapper: invalid callback on start.");
       return BT::NodeStatus::FAILURE;
     }
   }
@@ -54,14 +54,13 @@ public:
   // this method until it return something different than RUNNING
   BT::NodeStatus onRunning() override
   {
-    std::cout << "BTWrapper - " << __func__ << std::endl;
     if (callback_on_running_)
     {
       return callback_on_running_();
     }
     else
     {
-      std::cout << "BTStateWrapper: invalid callback on running." << '\n';
+      bt_ros::logInfo("BTStateWrapper: invalid callback on running.");
       return BT::NodeStatus::FAILURE;
     }
   }
@@ -69,14 +68,13 @@ public:
   // Callback to execute if the action was aborted by another node
   void onHalted() override
   {
-    std::cout << "BTWrapper - " << __func__ << std::endl;
     if (callback_on_halted_)
     {
       callback_on_halted_();
     }
     else
     {
-      std::cout << "BTStateWrapper: invalid callback on running." << '\n';
+      bt_ros::logInfo("BTStateWrapper: invalid callback on halted.");
     }
   }
 
@@ -90,7 +88,8 @@ class MoveBaseActionNode
 {
 public:
   // Any node with ports must have at least one constructor with this signature
-  MoveBaseActionNode()
+  MoveBaseActionNode(bt_ros::DeadlineService& deadlines)
+    : completion_timer_{deadlines}
   {}
 
   // It is mandatory to define this static method
@@ -105,7 +104,7 @@ public:
   void onHalted();
 
 private:
-  std::chrono::system_clock::time_point completion_time_;
+  bt_ros::DeadlineTimer completion_timer_;
 };
 
 // IMPLEMENTATION
@@ -116,27 +115,23 @@ BT::NodeStatus MoveBaseActionNode::onStart(BTStatefulWrapper::Self self)
   {
     throw BT::RuntimeError("missing required input [goal]");
   }
-  std::cout << "[MoveBase: SEND REQUEST ]. goal: x=" << goal.x
-    << " y=" << goal.y << " theta=" << goal.theta << "\n";
+  bt_ros::logInfo("[MoveBase: SEND REQUEST ]. goal: x=", goal.x, " y=", goal.y, " theta=", goal.theta);
 
-  // We use this counter to simulate an action that takes a certain
+  // We use this timer to simulate an action that takes a certain
   // amount of time to be completed (200ms)
-  completion_time_ = std::chrono::system_clock::now() + std::chrono::milliseconds(200);
+  completion_timer_.start(*self, std::chrono::milliseconds(200));
 
   return BT::NodeStatus::RUNNING;
 }
 
 BT::NodeStatus MoveBaseActionNode::onRunning()
 {
-  // Pretend that we are checking if the reply has been received
-  // try no to block inside this function for too much time
-  std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
-  // Pretend after a certain amount of time,
-  // we have completed the operation
-  if (std::chrono::system_clock::now() >= completion_time_)
+  // Pretend that we are checking if the reply has been received.
+  // The deadline service wakes the tree up when the timer expires,
+  // so there is no need to block or to read the clock here
+  if (completion_timer_.expired())
   {
-    std::cout << "[MoveBase: FINISHED]\n";
+    bt_ros::logInfo("[MoveBase: FINISHED]");
     return BT::NodeStatus::SUCCESS;
   }
   return BT::NodeStatus::RUNNING;
@@ -144,32 +139,14 @@ BT::NodeStatus MoveBaseActionNode::onRunning()
 
 void MoveBaseActionNode::onHalted()
 {
-  std::cout << "[MoveBase: ABORTED]";
+  completion_timer_.cancel();
+  bt_ros::logInfo("[MoveBase: ABORTED]");
 }
 
-// To allow xml loader to instantiate a `Position2D` from a string, we need to provide
-// a template specialization of `BT::convertFromString<Position2D>(StringView)`
-namespace BT
-{
-  template <> inline Pose2D convertFromString(StringView str)
-  {
-    // We expect real numbers separeted by semicolons
-    auto parts = splitString(str, ';');
-    if (3 != parts.size())
-    {
-      throw RuntimeError("invalid input");
-    }
-    else
-    {
-      return {convertFromString<float>(parts[0]), convertFromString<float>(parts[1]), convertFromString<float>(parts[2])};
-    }
-  }
-} // end namespace BT
-
 // Simple funciton
 BT::NodeStatus CheckBattery()
 {
-  std::cout << "[Lambda Method] Battery: OK" << '\n';
+  bt_ros::logInfo("[Lambda Method] Battery: OK");
   return BT::NodeStatus::SUCCESS;
 }
 
@@ -197,16 +174,19 @@ public:
       throw BT::RuntimeError("missing required input [message]: ", msg.error());
     }
     // Use the msg value
-    std::cout << "Robot says: " << msg.value() << '\n';
+    bt_ros::logInfo("Robot says: ", msg.value());
     return BT::NodeStatus::SUCCESS;
   }
 };
 
 int main (int argc, char *argv[])
 {
+  // Deadlines of the asynchronous nodes, it must outlive the tree
+  bt_ros::DeadlineService deadlines;
+
   BT::BehaviorTreeFactory factory;
   factory.registerSimpleCondition("BatteryOK", [&](BT::TreeNode&){ return CheckBattery(); });
-  MoveBaseActionNode mb;
+  MoveBaseActionNode mb{deadlines};
   factory.registerNodeType<BTStatefulWrapper>(
       "MoveBase",
       { mb.providedPorts() },
@@ -220,22 +200,22 @@ int main (int argc, char *argv[])
 
   // Here instead of tree.tickWhileRunning();
   // we prefer our own loop
-  std::cout << "BTWrapper Method\n";
-  std::cout << "--- ticking\n";
+  bt_ros::logInfo("BTWrapper Method");
+  bt_ros::logInfo("--- ticking");
   auto status = tree.tickOnce();
-  std::cout << "--- status: " << BT::toStr(status) << "\n\n";
+  bt_ros::logInfo("--- status: ", BT::toStr(status), "\n");
 
   while (BT::NodeStatus::RUNNING == status)
   {
     // Sleep to aviod busy loops.
     // do NOT use other sleep functions!
-    // Small sleep time is alright, for demo purposes we use 
-    // a larger sleep time to have less messages to the console
-    tree.sleep(std::chrono::milliseconds(40));
+    // Instead of polling at a fixed period, sleep until the next
+    // deadline fires or a node wakes the tree up
+    deadlines.sleep(tree, std::chrono::seconds(1));
 
-    std::cout << "--- ticking\n";
+    bt_ros::logInfo("--- ticking");
     status = tree.tickOnce();
-    std::cout << "--- status: " << BT::toStr(status) << "\n\n";
+    bt_ros::logInfo("--- status: ", BT::toStr(status), "\n");
   }
 
   return EXIT_SUCCESS;
@@ -11,6 +11,8 @@
 // STL
 #include <string>
 
+#include "ros2-behaviortree/async_log.hpp"
+
 class CrossDoor
 {
 public:
@@ -19,14 +21,14 @@ public:
   // SUCCESS if door_open_ != true
   BT::NodeStatus isDoorClose()
   {
-    std::cout << "--- " << __func__ << ": " << (!door_open_) << std::endl;
+    bt_ros::logInfo("--- ", __func__, ": ", (!door_open_));
     return (!door_open_) ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
   }
 
   // SUCCESS if door_open_ == true
   BT::NodeStatus passThroughDoor()
   {
-    std::cout << "--- " << __func__ << ": " << (door_open_) << std::endl;
+    bt_ros::logInfo("--- ", __func__, ": ", (door_open_));
     return (door_open_) ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
   }
 
@@ -36,12 +38,12 @@ public:
     if (pick_attempts < 3)
     {
       pick_attempts++;
-      std::cout << "--- " << __func__ << ": " << pick_attempts << " times!" << std::endl;
+      bt_ros::logInfo("--- ", __func__, ": ", pick_attempts, " times!");
       return BT::NodeStatus::FAILURE;
     }
     else
     {
-      std::cout << "--- " << __func__ << ": successfully unlocked door!" << std::endl;
+      bt_ros::logInfo("--- ", __func__, ": successfully unlocked door!");
       door_locked_ = false;
       return BT::NodeStatus::SUCCESS;
     }
@@ -52,13 +54,13 @@ public:
   {
     if (door_locked_)
     {
-      std::cout << "--- " << __func__ << ": door is locked!" << std::endl;
+      bt_ros::logInfo("--- ", __func__, ": door is locked!");
       return BT::NodeStatus::FAILURE;
     }
     else
     {
       door_open_ = true;
-      std::cout << "--- " << __func__ << ": door is opened!" << std::endl;
+      bt_ros::logInfo("--- ", __func__, ": door is opened!");
       return BT::NodeStatus::SUCCESS;
     }
   }
@@ -68,7 +70,7 @@ public:
   {
     door_locked_ = false;
     door_open_ = true;
-    std::cout << "--- " << __func__ << ": door has been smashed open!" << std::endl;
+    bt_ros::logInfo("--- ", __func__, ": door has been smashed open!");
     return BT::NodeStatus::SUCCESS;
   }
 
@@ -8,9 +8,11 @@
 #include <behaviortree_cpp/bt_factory.h>
 
 // STL
-#include <filesystem>
+#include <chrono>
 #include <string>
-#include <iostream>
+
+#include "ros2-behaviortree/async_log.hpp"
+#include "ros2-behaviortree/tree_directory_loader.hpp"
 
 class SaySomethingNode : public BT::SyncActionNode
 {
@@ -36,7 +38,7 @@ public:
       throw BT::RuntimeError("missing required input [message]: ", msg.error());
     }
     // Use the msg value
-    std::cout << "Robot says: " << msg.value() << '\n';
+    bt_ros::logInfo("Robot says: ", msg.value());
     return BT::NodeStatus::SUCCESS;
   }
 };
@@ -46,32 +48,35 @@ int main (int argc, char *argv[])
   BT::BehaviorTreeFactory factory;
   factory.registerNodeType<SaySomethingNode>("SaySomething");
 
-  // Find all xml files in a folder and register all of them
-  // we will use std::filesystem::directory_iterator
+  // Find all xml files in a folder and register all of them.
+  // Registering every file, in our specific case, would be equivalent to
+  // factory.registerBehaviorTreeFromFile("./config/behaviortree/tutorial_7/main_tree.xml");
+  // factory.registerBehaviorTreeFromFile("./config/behaviortree/tutorial_7/subtree_A.xml");
+  // factory.registerBehaviorTreeFromFile("./config/behaviortree/tutorial_7/subtree_B.xml");
+  // which parses all of them, one after the other, on every start. Instead, the loader
+  // parses the files in parallel into binary caches, memory-mapped on the next starts and
+  // rebuilt only for the files that changed. SubTree references are resolved across files.
   std::string search_directory {"./config/behaviortree/tutorial_7"};
+  bt_ros::TreeDirectoryLoader loader{search_directory, "/tmp/ros2-behaviortree/tutorial_7"};
+  const auto library = loader.load();
 
-  for (auto const& entry : std::filesystem::directory_iterator(search_directory))
+  for (const auto& file : loader.report())
   {
-    if (entry.path().extension() == ".xml")
-    {
-      std::cout << "Loading: " << entry.path().string() << std::endl;
-      factory.registerBehaviorTreeFromFile(entry.path().string());
-    }
+    bt_ros::logInfo("Loading: ", file.path, " [", bt_ros::toStr(file.origin), ", ",
+      file.tree_count, " tree(s), ",
+      std::chrono::duration_cast<std::chrono::microseconds>(file.load_time).count(), " us]");
   }
-
-  // This, in our specific case, would be equivalent to
-  // factory.registerBehaviorTreeFromFile("./config/behaviortree/tutorial_7/main_tree.xml");
-  // factory.registerBehaviorTreeFromFile("./config/behaviortree/tutorial_7/subtree_A.xml");
-  // factory.registerBehaviorTreeFromFile("./config/behaviortree/tutorial_7/subtree_B.xml");
+  bt_ros::logInfo("Loaded in ",
+    std::chrono::duration_cast<std::chrono::microseconds>(loader.loadTime()).count(), " us");
 
   // You can create the main tree and the subtree will be added automatically
-  std::cout << "\n--- MainTree ---" << std::endl;
-  auto main_tree = factory.createTree("MainTree");
+  bt_ros::logInfo("\n--- MainTree ---");
+  auto main_tree = library.createTree(factory, "MainTree");
   main_tree.tickWhileRunning();
 
   // alternatively, you can create only one of the subtrees
-  std::cout << "\n--- SubTreeA ---" << std::endl;
-  auto subtree_a = factory.createTree("SubTreeA");
+  bt_ros::logInfo("\n--- SubTreeA ---");
+  auto subtree_a = library.createTree(factory, "SubTreeA");
   subtree_a.tickWhileRunning();
 
   return EXIT_SUCCESS;
@@ -10,7 +10,8 @@
 // STL
 #include <memory>
 #include <string>
-#include <iostream>
+
+#include "ros2-behaviortree/async_log.hpp"
 
 class SaySomethingElseNode : public BT::SyncActionNode
 {
@@ -42,9 +43,9 @@ public:
       throw BT::RuntimeError("missing required input [message]: ", msg.error());
     }
     // Use the msg value
-    std::cout << "Robot says: " << msg.value() << '\n';
-    std::cout << "And it also says: " << message1_ << '\n';
-    std::cout << "Along with: " << message2_ << '\n';
+    bt_ros::logInfo("Robot says: ", msg.value());
+    bt_ros::logInfo("And it also says: ", message1_);
+    bt_ros::logInfo("Along with: ", message2_);
     return BT::NodeStatus::SUCCESS;
   }
 
@@ -69,7 +70,7 @@ int main (int argc, char *argv[])
   auto tree = factory.createTreeFromFile("./config/behaviortree/tutorial_8.xml");
 
   // Call the original tree once
-  std::cout << "--- Original Tree ---\n";
+  bt_ros::logInfo("--- Original Tree ---");
   tree.tickWhileRunning();
 
   // Create visitor lambda (method 1)
@@ -84,7 +85,7 @@ int main (int argc, char *argv[])
   // Apply the visitor to ALL the nodes in tree
   tree.applyVisitor(visitor);
 
-  std::cout << "\n--- First Visitor ---\n";
+  bt_ros::logInfo("\n--- First Visitor ---");
   tree.tickWhileRunning();
 
   // Create visitor lambda (method 2)
@@ -96,7 +97,7 @@ int main (int argc, char *argv[])
       }
     }
   );
-  std::cout << "\n--- Second Visitor ---\n";
+  bt_ros::logInfo("\n--- Second Visitor ---");
   tree.tickWhileRunning();
 
   return EXIT_SUCCESS;
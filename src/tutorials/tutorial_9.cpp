@@ -9,7 +9,8 @@
 
 // STL
 #include <string>
-#include <iostream>
+
+#include "ros2-behaviortree/async_log.hpp"
 
 enum Color
 {
@@ -42,7 +43,7 @@ public:
       throw BT::RuntimeError("missing required input [message]: ", msg.error());
     }
     // Use the msg value
-    std::cout << "Robot says: " << msg.value() << '\n';
+    bt_ros::logInfo("Robot says: ", msg.value());
     return BT::NodeStatus::SUCCESS;
   }
 };
@@ -0,0 +1,202 @@
+#include "ros2-behaviortree/work_stealing_pool.hpp"
+
+// STL
+#include <condition_variable>
+#include <exception>
+#include <optional>
+
+namespace bt_ros
+{
+  namespace
+  {
+    // Queue of the worker running on this thread, none on other threads
+    thread_local const void* current_pool = nullptr;
+    thread_local std::size_t current_worker = 0;
+  } // anonymous namespace
+
+  struct WorkStealingPool::Batch
+  {
+    const std::function<void(std::size_t)>* job;
+    std::atomic<std::size_t> remaining;
+    // The caller leaves through the mutex, the batch lives on its stack
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done = false;
+    std::exception_ptr error;
+
+    void execute(std::size_t index) noexcept
+    {
+      try
+      {
+        (*job)(index);
+      }
+      catch (...)
+      {
+        std::lock_guard lock{mutex};
+        if (!error)
+        {
+          error = std::current_exception();
+        }
+      }
+      if (1 == remaining.fetch_sub(1, std::memory_order_acq_rel))
+      {
+        std::lock_guard lock{mutex};
+        done = true;
+        finished.notify_all();
+      }
+    }
+
+    void wait()
+    {
+      std::unique_lock lock{mutex};
+      finished.wait(lock, [this](){ return done; });
+    }
+  };
+
+  std::size_t WorkStealingPool::defaultThreadCount()
+  {
+    const auto hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 1;
+  }
+
+  WorkStealingPool::WorkStealingPool(std::size_t thread_count)
+    : queued_{0}
+    , next_queue_{0}
+  {
+    for (std::size_t i = 0; i < thread_count; ++i)
+    {
+      queues_.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < thread_count; ++i)
+    {
+      workers_.emplace_back([this, i](std::stop_token stop){ run(i, stop); });
+    }
+  }
+
+  WorkStealingPool::~WorkStealingPool()
+  {
+    for (auto& worker : workers_)
+    {
+      worker.request_stop();
+    }
+    // Wake the sleeping workers up so that they see the stop request
+    queued_.fetch_add(1, std::memory_order_release);
+    queued_.notify_all();
+    workers_.clear();
+  }
+
+  WorkStealingPool& WorkStealingPool::shared()
+  {
+    static WorkStealingPool pool;
+    return pool;
+  }
+
+  void WorkStealingPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& job)
+  {
+    if (0 == count)
+    {
+      return;
+    }
+    if (1 == count || queues_.empty())
+    {
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        job(i);
+      }
+      return;
+    }
+
+    Batch batch;
+    batch.job = &job;
+    batch.remaining.store(count, std::memory_order_relaxed);
+
+    // A worker keeps its batch in its own queue for the others to steal, other threads deal it out
+    const bool on_worker = this == current_pool;
+    const auto home = on_worker ? current_worker : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    // Counted first: a worker finding no job while the count is positive only yields
+    queued_.fetch_add(count, std::memory_order_release);
+    if (on_worker)
+    {
+      auto& queue = *queues_[home];
+      std::lock_guard lock{queue.mutex};
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        queue.jobs.push_back(Job{&batch, i});
+      }
+    }
+    else
+    {
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        auto& queue = *queues_[(home + i) % queues_.size()];
+        std::lock_guard lock{queue.mutex};
+        queue.jobs.push_back(Job{&batch, i});
+      }
+    }
+    queued_.notify_all();
+
+    // Help until no job is left in the queues, then sleep until the last ones finish
+    while (batch.remaining.load(std::memory_order_acquire) && runOne(home))
+    {
+    }
+    batch.wait();
+
+    if (batch.error)
+    {
+      std::rethrow_exception(batch.error);
+    }
+  }
+
+  bool WorkStealingPool::runOne(std::size_t home)
+  {
+    std::optional<Job> job;
+    {
+      auto& queue = *queues_[home];
+      std::lock_guard lock{queue.mutex};
+      if (!queue.jobs.empty())
+      {
+        job = queue.jobs.back();
+        queue.jobs.pop_back();
+      }
+    }
+    for (std::size_t i = 1; !job && i < queues_.size(); ++i)
+    {
+      auto& queue = *queues_[(home + i) % queues_.size()];
+      std::lock_guard lock{queue.mutex};
+      if (!queue.jobs.empty())
+      {
+        job = queue.jobs.front();
+        queue.jobs.pop_front();
+      }
+    }
+    if (!job)
+    {
+      return false;
+    }
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    job->batch->execute(job->index);
+    return true;
+  }
+
+  void WorkStealingPool::run(std::size_t worker, std::stop_token stop)
+  {
+    current_pool = this;
+    current_worker = worker;
+    while (!stop.stop_requested())
+    {
+      if (!runOne(worker))
+      {
+        const auto queued = queued_.load(std::memory_order_acquire);
+        if (0 == queued)
+        {
+          queued_.wait(0, std::memory_order_acquire);
+        }
+        else
+        {
+          // Counted but not pushed yet
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+} // bt_ros
@@ -0,0 +1,106 @@
+// GTest
+#include <gtest/gtest.h>
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "ros2-behaviortree/multi_tree_executor.hpp"
+
+using bt_ros::MultiTreeExecutor;
+using namespace std::chrono_literals;
+
+namespace
+{
+  const char* xml_text = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <AsyncResult/>
+  </BehaviorTree>
+</root>
+)";
+
+  // Completes on another thread and only emits the wake up signal, like RosActionClientNode
+  class AsyncResult : public BT::StatefulActionNode
+  {
+  public:
+    AsyncResult(const std::string& name, const BT::NodeConfig& config, std::chrono::milliseconds delay)
+      : BT::StatefulActionNode(name, config)
+      , delay_{delay}
+      , done_{false}
+    {}
+
+    ~AsyncResult() override
+    {
+      if (worker_.joinable())
+      {
+        worker_.join();
+      }
+    }
+
+    static BT::PortsList providedPorts()
+    {
+      return {};
+    }
+
+    BT::NodeStatus onStart() override
+    {
+      worker_ = std::thread([this]()
+        {
+          std::this_thread::sleep_for(delay_);
+          done_ = true;
+          emitWakeUpSignal();
+        });
+      return BT::NodeStatus::RUNNING;
+    }
+
+    BT::NodeStatus onRunning() override
+    {
+      return done_ ? BT::NodeStatus::SUCCESS : BT::NodeStatus::RUNNING;
+    }
+
+    void onHalted() override
+    {
+    }
+
+  private:
+    std::chrono::milliseconds delay_;
+    std::atomic<bool> done_;
+    std::thread worker_;
+  };
+} // anonymous namespace
+
+TEST(MultiTreeExecutorTest, WakeUpSignalTicksParkedTree)
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<AsyncResult>("AsyncResult", 100ms);
+
+  MultiTreeExecutor executor{1};
+  MultiTreeExecutor::TreeOptions options;
+  options.period = 10ms;
+  // Far longer than the test may take: only the wake up signal completes the tree in time
+  options.idle_period = 60s;
+  std::atomic<bool> succeeded{false};
+  options.on_done = [&succeeded](MultiTreeExecutor::TreeId, BT::NodeStatus status)
+    {
+      succeeded = BT::NodeStatus::SUCCESS == status;
+    };
+
+  const auto start = std::chrono::steady_clock::now();
+  executor.add(factory.createTreeFromText(xml_text), options);
+  executor.waitAll();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_TRUE(succeeded);
+  EXPECT_LT(elapsed, 2s);
+  const auto stats = executor.stats();
+  EXPECT_EQ(1u, stats.parked);
+  EXPECT_EQ(1u, stats.wake_ups);
+  EXPECT_EQ(1u, stats.completed);
+}
@@ -0,0 +1,239 @@
+// GTest
+#include <gtest/gtest.h>
+
+// ROS2
+#include <rclcpp/rclcpp.hpp>
+#include <example_interfaces/action/fibonacci.hpp>
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "ros2-behaviortree/behaviortree_action_template.hpp"
+#include "ros2-behaviortree/fake_action_server.hpp"
+
+using Fibonacci = example_interfaces::action::Fibonacci;
+using namespace std::chrono_literals;
+
+namespace
+{
+  // What the node saw of its last goal
+  struct Outcome
+  {
+    std::optional<bt_ros::ActionNodeError> error;
+    std::optional<rclcpp_action::ResultCode> code;
+    std::size_t sequence_size = 0;
+  };
+
+  class FibonacciActionNode : public bt_ros::RosActionClientNode<Fibonacci>
+  {
+  public:
+    FibonacciActionNode(const std::string& name,
+        const BT::NodeConfig& config,
+        rclcpp::Node::SharedPtr node,
+        const std::string& action_name,
+        Outcome& outcome)
+      : bt_ros::RosActionClientNode<Fibonacci>(name, config, node, action_name)
+      , outcome_{outcome}
+    {}
+
+    static BT::PortsList providedPorts()
+    {
+      return { BT::InputPort<int>("order") };
+    }
+
+    bool setGoal(Goal& goal) override
+    {
+      auto order = getInput<int>("order");
+      if (!order)
+      {
+        return false;
+      }
+      goal.order = order.value();
+      return true;
+    }
+
+    BT::NodeStatus onResult(const WrappedResult& result) override
+    {
+      outcome_.code = result.code;
+      outcome_.sequence_size = result.result ? result.result->sequence.size() : 0;
+      return rclcpp_action::ResultCode::SUCCEEDED == result.code ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
+    }
+
+    BT::NodeStatus onFailure(bt_ros::ActionNodeError error) override
+    {
+      outcome_.error = error;
+      return BT::NodeStatus::FAILURE;
+    }
+
+  private:
+    Outcome& outcome_;
+  };
+
+  const char* xml_text = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <Fibonacci order="5"/>
+  </BehaviorTree>
+</root>
+)";
+
+  template <typename Predicate>
+  bool waitFor(Predicate predicate, std::chrono::milliseconds timeout)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate())
+    {
+      if (std::chrono::steady_clock::now() > deadline)
+      {
+        return false;
+      }
+      std::this_thread::sleep_for(5ms);
+    }
+    return true;
+  }
+} // anonymous namespace
+
+class RosActionClientNodeTest : public ::testing::Test
+{
+protected:
+  static void SetUpTestSuite()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestSuite()
+  {
+    rclcpp::shutdown();
+  }
+
+  // Server finishing its goals after `duration`, and a tree with one action node
+  void start(std::chrono::milliseconds duration)
+  {
+    const auto test = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    const auto action_name = std::string{"fibonacci_"} + test;
+    node_ = std::make_shared<rclcpp::Node>(std::string{"test_action_client_"} + test);
+    server_ = std::make_unique<bt_ros::FakeActionServer<Fibonacci>>(node_, action_name, duration,
+      [](const Fibonacci::Goal& goal, Fibonacci::Result& result)
+      {
+        result.sequence.assign(static_cast<std::size_t>(goal.order), 0);
+      });
+
+    executor_.add_node(node_);
+    spinner_ = std::thread([this](){ executor_.spin(); });
+
+    factory_.registerNodeType<FibonacciActionNode>("Fibonacci", node_, action_name, std::ref(outcome_));
+    tree_ = factory_.createTreeFromText(xml_text);
+
+    auto client = rclcpp_action::create_client<Fibonacci>(node_, action_name);
+    ASSERT_TRUE(client->wait_for_action_server(5s));
+  }
+
+  void TearDown() override
+  {
+    // The tree goes first, callbacks still in flight must not reach its nodes
+    tree_ = BT::Tree{};
+    executor_.cancel();
+    if (spinner_.joinable())
+    {
+      spinner_.join();
+    }
+    server_.reset();
+    node_.reset();
+  }
+
+  BT::NodeStatus tickUntilDone(std::chrono::milliseconds timeout)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto status = tree_.tickOnce();
+    while (BT::NodeStatus::RUNNING == status && std::chrono::steady_clock::now() < deadline)
+    {
+      tree_.sleep(10ms);
+      status = tree_.tickOnce();
+    }
+    return status;
+  }
+
+  rclcpp::Node::SharedPtr node_;
+  std::unique_ptr<bt_ros::FakeActionServer<Fibonacci>> server_;
+  rclcpp::executors::MultiThreadedExecutor executor_;
+  std::thread spinner_;
+  BT::BehaviorTreeFactory factory_;
+  BT::Tree tree_;
+  Outcome outcome_;
+};
+
+TEST_F(RosActionClientNodeTest, Succeeds)
+{
+  start(50ms);
+  EXPECT_EQ(BT::NodeStatus::SUCCESS, tickUntilDone(2s));
+  ASSERT_TRUE(outcome_.code);
+  EXPECT_EQ(rclcpp_action::ResultCode::SUCCEEDED, *outcome_.code);
+  EXPECT_EQ(5u, outcome_.sequence_size);
+}
+
+TEST_F(RosActionClientNodeTest, Aborts)
+{
+  start(50ms);
+  server_->succeedGoals(false);
+  EXPECT_EQ(BT::NodeStatus::FAILURE, tickUntilDone(2s));
+  ASSERT_TRUE(outcome_.code);
+  EXPECT_EQ(rclcpp_action::ResultCode::ABORTED, *outcome_.code);
+}
+
+TEST_F(RosActionClientNodeTest, Rejected)
+{
+  start(50ms);
+  server_->rejectGoals(true);
+  EXPECT_EQ(BT::NodeStatus::FAILURE, tickUntilDone(2s));
+  ASSERT_TRUE(outcome_.error);
+  EXPECT_EQ(bt_ros::ActionNodeError::GOAL_REJECTED, *outcome_.error);
+  EXPECT_FALSE(outcome_.code);
+}
+
+TEST_F(RosActionClientNodeTest, HaltBeforeAccept)
+{
+  start(10s);
+  ASSERT_EQ(BT::NodeStatus::RUNNING, tree_.tickOnce());
+  // Right after sending the goal, most likely before the server answered
+  EXPECT_NO_THROW(tree_.haltTree());
+
+  // The goal is canceled once its acceptance arrives
+  EXPECT_TRUE(waitFor([this](){ return 1u == server_->canceledGoals(); }, 2s));
+  EXPECT_EQ(0u, server_->activeGoals());
+  EXPECT_FALSE(outcome_.code);
+}
+
+TEST_F(RosActionClientNodeTest, HaltAfterResult)
+{
+  start(0ms);
+  ASSERT_EQ(BT::NodeStatus::RUNNING, tree_.tickOnce());
+  // The result arrives and the client forgets the goal, without a tick
+  ASSERT_TRUE(waitFor([this](){ return 1u == server_->finishedGoals(); }, 2s));
+  std::this_thread::sleep_for(100ms);
+
+  EXPECT_NO_THROW(tree_.haltTree());
+  EXPECT_EQ(0u, server_->canceledGoals());
+}
+
+TEST_F(RosActionClientNodeTest, ImmediateResult)
+{
+  start(0ms);
+  ASSERT_EQ(BT::NodeStatus::RUNNING, tree_.tickOnce());
+  // Accepted and done before the next tick
+  ASSERT_TRUE(waitFor([this](){ return 1u == server_->finishedGoals(); }, 2s));
+  std::this_thread::sleep_for(100ms);
+
+  BT::NodeStatus status = BT::NodeStatus::IDLE;
+  EXPECT_NO_THROW(status = tree_.tickOnce());
+  EXPECT_EQ(BT::NodeStatus::SUCCESS, status);
+  ASSERT_TRUE(outcome_.code);
+  EXPECT_EQ(rclcpp_action::ResultCode::SUCCEEDED, *outcome_.code);
+}
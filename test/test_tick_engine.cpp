@@ -0,0 +1,100 @@
+// GTest
+#include <gtest/gtest.h>
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// STL
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "ros2-behaviortree/deadline_service.hpp"
+#include "ros2-behaviortree/tick_engine.hpp"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+  const char* xml_text = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <WaitDeadlines/>
+  </BehaviorTree>
+</root>
+)";
+
+  constexpr int EXPIRIES = 3;
+
+  // Waits for EXPIRIES deadlines in a row, counts its ticks
+  class WaitDeadlines : public BT::StatefulActionNode
+  {
+  public:
+    WaitDeadlines(const std::string& name, const BT::NodeConfig& config,
+        bt_ros::DeadlineService& deadlines, int& ticks)
+      : BT::StatefulActionNode(name, config)
+      , timer_{deadlines}
+      , ticks_{ticks}
+      , expired_{0}
+    {}
+
+    static BT::PortsList providedPorts()
+    {
+      return {};
+    }
+
+    BT::NodeStatus onStart() override
+    {
+      ++ticks_;
+      timer_.start(*this, 20ms);
+      return BT::NodeStatus::RUNNING;
+    }
+
+    BT::NodeStatus onRunning() override
+    {
+      ++ticks_;
+      if (!timer_.expired())
+      {
+        return BT::NodeStatus::RUNNING;
+      }
+      if (++expired_ == EXPIRIES)
+      {
+        return BT::NodeStatus::SUCCESS;
+      }
+      timer_.start(*this, 20ms);
+      return BT::NodeStatus::RUNNING;
+    }
+
+    void onHalted() override
+    {
+      timer_.cancel();
+    }
+
+  private:
+    bt_ros::DeadlineTimer timer_;
+    int& ticks_;
+    int expired_;
+  };
+} // anonymous namespace
+
+TEST(TickEngineTest, OneTickPerExpiredDeadline)
+{
+  bt_ros::DeadlineService deadlines;
+  int ticks = 0;
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<WaitDeadlines>("WaitDeadlines", std::ref(deadlines), std::ref(ticks));
+  auto tree = factory.createTreeFromText(xml_text);
+
+  // Slots far apart: only the deadlines tick the tree
+  bt_ros::TickEngine engine{tree, 10s};
+  engine.setDeadlineService(&deadlines);
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(BT::NodeStatus::SUCCESS, engine.run());
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+  // The first tick, then exactly one per expiry
+  EXPECT_EQ(1 + EXPIRIES, ticks);
+  EXPECT_EQ(static_cast<std::uint64_t>(1 + EXPIRIES), engine.stats().ticks);
+}
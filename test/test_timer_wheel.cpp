@@ -0,0 +1,140 @@
+// GTest
+#include <gtest/gtest.h>
+
+// STL
+#include <chrono>
+#include <vector>
+
+#include "ros2-behaviortree/timer_wheel.hpp"
+
+using bt_ros::TimerWheel;
+using namespace std::chrono_literals;
+
+namespace
+{
+  const auto start = TimerWheel::Clock::time_point{} + 1h;
+} // anonymous namespace
+
+TEST(TimerWheelTest, FiresOnceAtDeadline)
+{
+  TimerWheel wheel{1ms, start};
+  int fired = 0;
+  wheel.schedule(start + 10ms, [&fired](){ ++fired; });
+
+  EXPECT_EQ(0u, wheel.advance(start + 9ms));
+  EXPECT_EQ(0, fired);
+  EXPECT_EQ(1u, wheel.advance(start + 10ms));
+  EXPECT_EQ(1, fired);
+  EXPECT_EQ(0u, wheel.advance(start + 1s));
+  EXPECT_EQ(1, fired);
+  EXPECT_EQ(0u, wheel.size());
+}
+
+TEST(TimerWheelTest, FiresAcrossLevels)
+{
+  TimerWheel wheel{1ms, start};
+  std::vector<int> order;
+  wheel.schedule(start + 5000ms, [&order](){ order.push_back(3); });
+  wheel.schedule(start + 70ms, [&order](){ order.push_back(2); });
+  wheel.schedule(start + 3ms, [&order](){ order.push_back(1); });
+
+  EXPECT_EQ(1u, wheel.advance(start + 69ms));
+  EXPECT_EQ(1u, wheel.advance(start + 4999ms));
+  EXPECT_EQ(1u, wheel.advance(start + 5000ms));
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), order);
+}
+
+TEST(TimerWheelTest, CancelPreventsFiring)
+{
+  TimerWheel wheel{1ms, start};
+  int fired = 0;
+  const auto handle = wheel.schedule(start + 10ms, [&fired](){ ++fired; });
+
+  EXPECT_TRUE(wheel.cancel(handle));
+  EXPECT_FALSE(wheel.cancel(handle));
+  EXPECT_EQ(0u, wheel.advance(start + 20ms));
+  EXPECT_EQ(0, fired);
+  EXPECT_EQ(0u, wheel.size());
+}
+
+TEST(TimerWheelTest, CancelSiblingFromCallback)
+{
+  TimerWheel wheel{1ms, start};
+  int first = 0;
+  int second = 0;
+  TimerWheel::Handle other;
+
+  // Both timers share a slot, whichever fires first cancels the other
+  const auto handle = wheel.schedule(start + 10ms, [&](){ ++first; wheel.cancel(other); });
+  other = wheel.schedule(start + 10ms, [&](){ ++second; wheel.cancel(handle); });
+
+  EXPECT_EQ(1u, wheel.advance(start + 10ms));
+  EXPECT_EQ(1, first + second);
+  EXPECT_EQ(0u, wheel.size());
+
+  // The freed entries are reused once each, and fire at their own deadline
+  int later = 0;
+  wheel.schedule(start + 20ms, [&later](){ ++later; });
+  wheel.schedule(start + 30ms, [&later](){ ++later; });
+  EXPECT_EQ(2u, wheel.size());
+  EXPECT_EQ(1u, wheel.advance(start + 20ms));
+  EXPECT_EQ(1, later);
+  EXPECT_EQ(1u, wheel.advance(start + 30ms));
+  EXPECT_EQ(2, later);
+  EXPECT_EQ(0u, wheel.size());
+}
+
+TEST(TimerWheelTest, CancelAndScheduleFromCallback)
+{
+  TimerWheel wheel{1ms, start};
+  std::vector<int> fired;
+  std::vector<TimerWheel::Handle> handles(3);
+
+  // The first timer to fire cancels the other ones and schedules a new timer,
+  // which must not take the place of a cancelled one in the tick being fired
+  for (int i = 0; i < 3; ++i)
+  {
+    handles[i] = wheel.schedule(start + 10ms, [&, i]()
+      {
+        fired.push_back(i);
+        for (int j = 0; j < 3; ++j)
+        {
+          if (j != i)
+          {
+            wheel.cancel(handles[j]);
+          }
+        }
+        wheel.schedule(start + 15ms, [&fired](){ fired.push_back(10); });
+      });
+  }
+
+  EXPECT_EQ(1u, wheel.advance(start + 10ms));
+  ASSERT_EQ(1u, fired.size());
+  EXPECT_EQ(1u, wheel.size());
+
+  EXPECT_EQ(0u, wheel.advance(start + 14ms));
+  EXPECT_EQ(1u, wheel.advance(start + 15ms));
+  ASSERT_EQ(2u, fired.size());
+  EXPECT_EQ(10, fired.back());
+  EXPECT_EQ(0u, wheel.size());
+}
+
+TEST(TimerWheelTest, ScheduleInFiringSlotFromCallback)
+{
+  TimerWheel wheel{1ms, start};
+  int fired = 0;
+  int rescheduled = 0;
+
+  // 64 ticks later lands in the level 0 slot being fired, it must wait a turn
+  wheel.schedule(start + 10ms, [&]()
+    {
+      ++fired;
+      wheel.schedule(start + 74ms, [&rescheduled](){ ++rescheduled; });
+    });
+
+  EXPECT_EQ(1u, wheel.advance(start + 10ms));
+  EXPECT_EQ(0, rescheduled);
+  EXPECT_EQ(0u, wheel.advance(start + 73ms));
+  EXPECT_EQ(1u, wheel.advance(start + 74ms));
+  EXPECT_EQ(1, rescheduled);
+}
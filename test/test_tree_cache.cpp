@@ -0,0 +1,362 @@
+// GTest
+#include <gtest/gtest.h>
+
+// BT
+#include <behaviortree_cpp/bt_factory.h>
+
+// XML
+#include <tinyxml2.h>
+
+// STL
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ros2-behaviortree/tree_cache.hpp"
+
+using bt_ros::TreeLibrary;
+
+namespace
+{
+  namespace fs = std::filesystem;
+
+  // Every node and SubTree feature the cache models, on top of the config files
+  const char* features_xml = R"(
+<root BTCPP_format="4" main_tree_to_execute="MainTree">
+  <BehaviorTree ID="MainTree">
+    <Sequence name="main_sequence">
+      <Script code="target:='1;2;3'; count:=2"/>
+      <Dummy goal="{target}" _skipIf="count == 0" _onSuccess="done:=true" _post="ticks:=1"/>
+      <SubTree ID="Remapped" goal="{target}" name="remapped"/>
+      <SubTree ID="AutoRemapped" _autoremap="true"/>
+      <SubTree ID="AutoRemapped" name="second_instance"/>
+      <RetryUntilSuccessful num_attempts="{count}">
+        <Dummy _while="count > 0" _failureIf="count > 5"/>
+      </RetryUntilSuccessful>
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Remapped">
+    <Fallback>
+      <Dummy goal="{goal}" result="{result}"/>
+      <AlwaysFailure _onHalted="halted:=true" _onFailure="failed:=true"/>
+    </Fallback>
+  </BehaviorTree>
+
+  <BehaviorTree ID="AutoRemapped">
+    <Dummy goal="{target}"/>
+  </BehaviorTree>
+</root>
+)";
+
+  // Trees the cache does not model, built by BT::XMLParser instead
+  const char* model_xml = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Dummy goal="hello"/>
+    </Sequence>
+  </BehaviorTree>
+
+  <TreeNodesModel>
+    <Action ID="Dummy">
+      <input_port name="goal"/>
+    </Action>
+  </TreeNodesModel>
+</root>
+)";
+
+  // A running action in a SubTree the main tree reaches through a changed tree
+  const char* reload_xml = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <AlwaysSuccess/>
+      <SubTree ID="Unchanged" name="unchanged"/>
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Unchanged">
+    <LongAction/>
+  </BehaviorTree>
+</root>
+)";
+
+  // Runs until told to finish, counts its calls
+  struct LongActionCounters
+  {
+    int started = 0;
+    int halted = 0;
+    bool finish = false;
+  };
+
+  class LongAction : public BT::StatefulActionNode
+  {
+  public:
+    LongAction(const std::string& name, const BT::NodeConfig& config, LongActionCounters& counters)
+      : BT::StatefulActionNode(name, config)
+      , counters_{counters}
+    {}
+
+    static BT::PortsList providedPorts()
+    {
+      return {};
+    }
+
+    BT::NodeStatus onStart() override
+    {
+      ++counters_.started;
+      return BT::NodeStatus::RUNNING;
+    }
+
+    BT::NodeStatus onRunning() override
+    {
+      return counters_.finish ? BT::NodeStatus::SUCCESS : BT::NodeStatus::RUNNING;
+    }
+
+    void onHalted() override
+    {
+      ++counters_.halted;
+    }
+
+  private:
+    LongActionCounters& counters_;
+  };
+
+  // The attributes given to a node ID, they become its ports
+  void collectAttributes(const tinyxml2::XMLElement* element, std::map<std::string, std::set<std::string>>& ports)
+  {
+    for (auto* child = element->FirstChildElement(); child; child = child->NextSiblingElement())
+    {
+      auto& names = ports[child->Name()];
+      for (auto* attribute = child->FirstAttribute(); attribute; attribute = attribute->Next())
+      {
+        const std::string name = attribute->Name();
+        if ("name" != name && '_' != name.front())
+        {
+          names.insert(name);
+        }
+      }
+      collectAttributes(child, ports);
+    }
+  }
+
+  // A factory knowing the trees of the files, with a dummy action for each node ID it does not know
+  void registerFiles(BT::BehaviorTreeFactory& factory, const std::vector<std::string>& files)
+  {
+    std::map<std::string, std::set<std::string>> ports;
+    for (const auto& file : files)
+    {
+      tinyxml2::XMLDocument doc;
+      ASSERT_EQ(tinyxml2::XML_SUCCESS, doc.LoadFile(file.c_str())) << file;
+      for (auto* tree = doc.RootElement()->FirstChildElement("BehaviorTree"); tree;
+          tree = tree->NextSiblingElement("BehaviorTree"))
+      {
+        collectAttributes(tree, ports);
+      }
+    }
+
+    for (const auto& [ID, names] : ports)
+    {
+      if (factory.manifests().count(ID))
+      {
+        continue;
+      }
+      // Unused ports with a default value are set by the parser too
+      BT::PortsList list{ BT::InputPort<std::string>("with_default", std::string{"default"}, "") };
+      for (const auto& name : names)
+      {
+        list.insert(BT::InputPort<std::string>(name));
+      }
+      factory.registerSimpleAction(ID, [](BT::TreeNode&){ return BT::NodeStatus::SUCCESS; }, list);
+    }
+
+    for (const auto& file : files)
+    {
+      factory.registerBehaviorTreeFromFile(file);
+    }
+  }
+
+  std::vector<std::uint16_t> childrenUIDs(const BT::TreeNode& node)
+  {
+    std::vector<std::uint16_t> UIDs;
+    if (const auto* control = dynamic_cast<const BT::ControlNode*>(&node))
+    {
+      for (const auto* child : control->children())
+      {
+        UIDs.push_back(child->UID());
+      }
+    }
+    else if (const auto* decorator = dynamic_cast<const BT::DecoratorNode*>(&node))
+    {
+      if (decorator->child())
+      {
+        UIDs.push_back(decorator->child()->UID());
+      }
+    }
+    return UIDs;
+  }
+
+  std::vector<std::string> blackboardKeys(const BT::Blackboard& blackboard)
+  {
+    std::vector<std::string> keys;
+    for (const auto& key : blackboard.getKeys())
+    {
+      keys.emplace_back(key);
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+  }
+
+  void expectSameTree(const BT::Tree& expected, const BT::Tree& actual)
+  {
+    ASSERT_EQ(expected.subtrees.size(), actual.subtrees.size());
+    for (std::size_t i = 0; i < expected.subtrees.size(); ++i)
+    {
+      const auto& lhs = *expected.subtrees[i];
+      const auto& rhs = *actual.subtrees[i];
+      SCOPED_TRACE(lhs.instance_name);
+      EXPECT_EQ(lhs.instance_name, rhs.instance_name);
+      EXPECT_EQ(lhs.tree_ID, rhs.tree_ID);
+      EXPECT_EQ(blackboardKeys(*lhs.blackboard), blackboardKeys(*rhs.blackboard));
+
+      ASSERT_EQ(lhs.nodes.size(), rhs.nodes.size());
+      for (std::size_t n = 0; n < lhs.nodes.size(); ++n)
+      {
+        const auto& a = *lhs.nodes[n];
+        const auto& b = *rhs.nodes[n];
+        SCOPED_TRACE(a.fullPath());
+        EXPECT_EQ(a.registrationName(), b.registrationName());
+        EXPECT_EQ(a.name(), b.name());
+        EXPECT_EQ(a.fullPath(), b.fullPath());
+        EXPECT_EQ(a.UID(), b.UID());
+        EXPECT_EQ(a.type(), b.type());
+        EXPECT_EQ(a.config().input_ports, b.config().input_ports);
+        EXPECT_EQ(a.config().output_ports, b.config().output_ports);
+        EXPECT_EQ(a.config().pre_conditions, b.config().pre_conditions);
+        EXPECT_EQ(a.config().post_conditions, b.config().post_conditions);
+        EXPECT_EQ(childrenUIDs(a), childrenUIDs(b));
+        ASSERT_TRUE(b.config().manifest);
+        EXPECT_EQ(a.config().manifest->registration_ID, b.config().manifest->registration_ID);
+      }
+    }
+  }
+
+  // Compare every tree of the files built by the factory, by the library parsed and by its cache
+  void expectSameTrees(const std::vector<std::string>& files, const std::string& cache_path)
+  {
+    BT::BehaviorTreeFactory factory;
+    registerFiles(factory, files);
+
+    const auto parsed = TreeLibrary::fromXmlFiles(files);
+    ASSERT_TRUE(parsed.save(cache_path));
+    const auto cached = TreeLibrary::mapCache(cache_path, files);
+    ASSERT_TRUE(cached);
+    EXPECT_TRUE(cached->fromCache());
+
+    auto IDs = factory.registeredBehaviorTrees();
+    auto library_IDs = parsed.treeIDs();
+    std::sort(IDs.begin(), IDs.end());
+    std::sort(library_IDs.begin(), library_IDs.end());
+    EXPECT_EQ(IDs, library_IDs);
+
+    for (const auto& ID : IDs)
+    {
+      SCOPED_TRACE(ID);
+      const auto expected = factory.createTree(ID);
+      expectSameTree(expected, parsed.createTree(factory, ID));
+      expectSameTree(expected, cached->createTree(factory, ID));
+    }
+  }
+
+  std::string tempPath(const std::string& name)
+  {
+    return (fs::path(::testing::TempDir()) / name).string();
+  }
+
+  std::string writeFile(const std::string& name, const char* content)
+  {
+    const auto path = tempPath(name);
+    std::ofstream(path) << content;
+    return path;
+  }
+} // anonymous namespace
+
+TEST(TreeCacheTest, ConfigTreesMatchFactory)
+{
+  // Files of a subdirectory belong together (SubTrees across files), the others stand alone
+  std::map<std::string, std::vector<std::string>> groups;
+  const fs::path config_dir{BT_CONFIG_DIR};
+  for (const auto& entry : fs::recursive_directory_iterator(config_dir))
+  {
+    if (entry.is_regular_file() && ".xml" == entry.path().extension())
+    {
+      const auto key = config_dir == entry.path().parent_path()
+        ? entry.path().string() : entry.path().parent_path().string();
+      groups[key].push_back(entry.path().string());
+    }
+  }
+  ASSERT_FALSE(groups.empty());
+
+  for (auto& [key, files] : groups)
+  {
+    SCOPED_TRACE(key);
+    std::sort(files.begin(), files.end());
+    expectSameTrees(files, tempPath("config.btcache"));
+  }
+}
+
+TEST(TreeCacheTest, ModeledFeaturesMatchFactory)
+{
+  const auto file = writeFile("features.xml", features_xml);
+  const auto library = TreeLibrary::fromXmlFiles({file});
+  EXPECT_FALSE(library.needsParser());
+  EXPECT_EQ("MainTree", library.mainTreeID());
+  expectSameTrees({file}, tempPath("features.btcache"));
+}
+
+TEST(TreeCacheTest, UnmodeledXmlFallsBackOnParser)
+{
+  const auto file = writeFile("model.xml", model_xml);
+  const auto cache_path = tempPath("model.btcache");
+
+  const auto library = TreeLibrary::fromXmlFiles({file});
+  EXPECT_TRUE(library.needsParser());
+  ASSERT_TRUE(library.save(cache_path));
+  const auto cached = TreeLibrary::mapCache(cache_path, {file});
+  ASSERT_TRUE(cached);
+  EXPECT_TRUE(cached->needsParser());
+
+  expectSameTrees({file}, cache_path);
+}
+
+TEST(TreeCacheTest, RebuildKeepsReusedNodesRunning)
+{
+  LongActionCounters counters;
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<LongAction>("LongAction", std::ref(counters));
+
+  const auto library = TreeLibrary::fromXmlFiles({writeFile("reload.xml", reload_xml)});
+  auto tree = library.createTree(factory, "MainTree");
+  ASSERT_EQ(BT::NodeStatus::RUNNING, tree.tickOnce());
+  ASSERT_EQ(1, counters.started);
+
+  std::size_t reused = 0;
+  auto rebuilt = library.rebuildTree(factory, tree, {"MainTree"}, "MainTree", &reused);
+  EXPECT_EQ(1u, reused);
+
+  // Halting the previous tree only reaches the nodes that were replaced
+  tree.haltTree();
+  tree = std::move(rebuilt);
+  EXPECT_EQ(0, counters.halted);
+
+  counters.finish = true;
+  EXPECT_EQ(BT::NodeStatus::SUCCESS, tree.tickOnce());
+  EXPECT_EQ(1, counters.started);
+  EXPECT_EQ(0, counters.halted);
+}